@@ -34,6 +34,39 @@ struct _AtspiAccessiblePrivate
 {
   GHashTable *cache;
   guint cache_ref_count;
+  AtspiRect screen_extents;
+  gint64 screen_extents_time;
+  AtspiAccessible *extents_index_key;
+  gint caret_offset;
+  gdouble current_value;
+  gint n_selected_children;
+  gint child_count;
+
+  /* Value of the cache generation when cached_properties was last valid;
+   * see _atspi_accessible_get_cached_properties () */
+  guint cache_generation;
+
+  /* Position in children_owner->children as of shift child_shift_seq of
+   * the owner; see _atspi_accessible_find_child () */
+  AtspiAccessible *children_owner;
+  gint index_in_parent;
+  guint child_shift_seq;
+
+  /* Inserts and removals in our own children array not yet folded into
+   * the children's index_in_parent, numbered from child_shift_base */
+  GArray *child_shifts;
+  guint child_shift_base;
+
+  /* Last published view of the cache, and whether anyone has asked for
+   * one; see atspi-cache-view.c */
+  AtspiCacheView *cache_view;
+  gint cache_view_wanted;
+
+  /* Stamped on every change to the cache of this object or of anything
+   * below it, and the last snapshot taken of it (not referenced); see
+   * atspi-snapshot.c */
+  guint subtree_serial;
+  AtspiSnapshot *snapshot;
 };
 
 GHashTable *
@@ -41,6 +74,55 @@ _atspi_accessible_ref_cache (AtspiAccessible *accessible);
 
 void
 _atspi_accessible_unref_cache (AtspiAccessible *accessible);
+
+AtspiCache
+_atspi_accessible_get_cached_properties (AtspiAccessible *accessible);
+
+void
+_atspi_accessible_remove_cache (AtspiAccessible *accessible, AtspiCache flag);
+
+gint
+_atspi_accessible_find_child (AtspiAccessible *parent, AtspiAccessible *child);
+
+void
+_atspi_accessible_set_child (AtspiAccessible *parent, gint index,
+                             AtspiAccessible *child);
+
+void
+_atspi_accessible_insert_child (AtspiAccessible *parent, gint index,
+                                AtspiAccessible *child);
+
+gboolean
+_atspi_accessible_remove_child (AtspiAccessible *parent,
+                                AtspiAccessible *child);
+
+guint
+_atspi_accessible_stale_generation (AtspiApplication *app);
+
+void
+_atspi_accessible_cache_changed (AtspiAccessible *accessible);
+
+void
+_atspi_accessible_drop_cache_view (AtspiAccessible *accessible);
+
+gboolean
+_atspi_accessible_is_cached (AtspiAccessible *accessible, AtspiCache flags);
+
+guint
+_atspi_accessible_get_cache_generation (void);
+
+void
+_atspi_snapshot_note_change (AtspiAccessible *accessible);
+
+void
+_atspi_component_set_screen_extents (AtspiAccessible *accessible,
+                                     const AtspiRect *extents);
+
+void
+_atspi_component_clear_screen_extents (AtspiAccessible *accessible);
+
+void
+_atspi_component_invalidate_screen_extents (AtspiAccessible *accessible);
 G_END_DECLS
 
 #endif	/* _ATSPI_ACCESSIBLE_H_ */
@@ -27,6 +27,13 @@
 #include <string.h>
 
 static gboolean enable_caching = FALSE;
+
+/* Cache invalidation is lazy: clearing a cache records a new generation,
+ * for the application or for everything, and objects stamped with an
+ * older one drop their cached properties the next time they are looked at.
+ */
+static guint cache_generation = 0;
+static guint cache_cleared_generation = 0;
 static guint quark_locale;
 
 static void
@@ -120,6 +127,7 @@ atspi_accessible_init (AtspiAccessible *accessible)
   accessible->priv = atspi_accessible_get_instance_private (accessible);
 
   accessible->children = g_ptr_array_new_with_free_func (g_object_unref);
+  accessible->priv->index_in_parent = -1;
 }
 
 static void
@@ -140,18 +148,21 @@ atspi_accessible_dispose (GObject *object)
 
   g_clear_object (&accessible->states);
 
+  _atspi_component_clear_screen_extents (accessible);
+
   parent = accessible->accessible_parent;
   if (parent)
   {
     accessible->accessible_parent = NULL;
-    if (parent->children)
-      g_ptr_array_remove (parent->children, accessible);
+    _atspi_accessible_remove_child (parent, accessible);
     g_object_unref (parent);
   }
 
   if (accessible->children) for (i = accessible->children->len - 1; i >= 0; i--)
   {
     AtspiAccessible *child = g_ptr_array_index (accessible->children, i);
+    if (child && child->priv->children_owner == accessible)
+      child->priv->children_owner = NULL;
     if (child && child->accessible_parent == accessible)
     {
       child->accessible_parent = NULL;
@@ -164,6 +175,13 @@ atspi_accessible_dispose (GObject *object)
     g_ptr_array_free (accessible->children, TRUE);
     accessible->children = NULL;
   }
+  if (accessible->priv->child_shifts)
+  {
+    g_array_free (accessible->priv->child_shifts, TRUE);
+    accessible->priv->child_shifts = NULL;
+  }
+
+  _atspi_accessible_drop_cache_view (accessible);
 
   G_OBJECT_CLASS (atspi_accessible_parent_class) ->dispose (object);
 }
@@ -181,6 +199,8 @@ atspi_accessible_finalize (GObject *object)
     if (accessible->priv->cache)
       g_hash_table_destroy (accessible->priv->cache);
 
+  _atspi_accessible_drop_cache_view (accessible);
+
 #ifdef DEBUG_REF_COUNTS
   accessible_count--;
   g_hash_table_remove (_atspi_get_live_refs (), accessible);
@@ -318,6 +338,8 @@ atspi_accessible_get_child_count (AtspiAccessible *obj, GError **error)
   if (!_atspi_accessible_test_cache (obj, ATSPI_CACHE_CHILDREN))
   {
     dbus_int32_t ret;
+    if (_atspi_accessible_test_cache (obj, ATSPI_CACHE_CHILD_COUNT))
+      return obj->priv->child_count;
     if (!_atspi_dbus_get_property (obj, atspi_interface_accessible,
                                    "ChildCount", error, "i", &ret))
       return -1;
@@ -345,8 +367,7 @@ atspi_accessible_get_child_at_index (AtspiAccessible *obj,
                             gint    child_index,
                             GError **error)
 {
-  AtspiAccessible *child;
-  DBusMessage *reply;
+  AtspiAccessible *child = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
@@ -360,19 +381,13 @@ atspi_accessible_get_child_at_index (AtspiAccessible *obj,
       return g_object_ref (child);
   }
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_accessible,
-                                   "GetChildAtIndex", error, "i", child_index);
-  child = _atspi_dbus_return_accessible_from_message (reply);
+  _atspi_call_accessible_get_child_at_index (obj, child_index, &child, error);
 
   if (!child)
     return NULL;
 
   if (_atspi_accessible_test_cache (obj, ATSPI_CACHE_CHILDREN))
-  {
-      if (child_index >= obj->children->len)
-        g_ptr_array_set_size (obj->children, child_index + 1);
-    g_ptr_array_index (obj->children, child_index) = g_object_ref (child);
-  }
+    _atspi_accessible_set_child (obj, child_index, child);
   return child;
 }
 
@@ -390,8 +405,7 @@ atspi_accessible_get_child_at_index (AtspiAccessible *obj,
 gint
 atspi_accessible_get_index_in_parent (AtspiAccessible *obj, GError **error)
 {
-  gint i = 0;
-  dbus_int32_t ret = -1;
+  gint ret = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
   if (_atspi_accessible_test_cache (obj, ATSPI_CACHE_PARENT))
@@ -402,14 +416,13 @@ atspi_accessible_get_index_in_parent (AtspiAccessible *obj, GError **error)
     if (!_atspi_accessible_test_cache (obj->accessible_parent, ATSPI_CACHE_CHILDREN) || !obj->accessible_parent->children)
         goto dbus;
 
-    for (i = 0; i < obj->accessible_parent->children->len; i++)
-      if (g_ptr_array_index (obj->accessible_parent->children, i) == obj)
-        return i;
+    ret = _atspi_accessible_find_child (obj->accessible_parent, obj);
+    if (ret >= 0)
+      return ret;
   }
 
 dbus:
-  _atspi_dbus_call (obj, atspi_interface_accessible,
-                    "GetIndexInParent", NULL, "=>i", &ret);
+  _atspi_call_accessible_get_index_in_parent (obj, &ret, NULL);
   return ret;
 }
 
@@ -474,9 +487,9 @@ atspi_accessible_get_role (AtspiAccessible *obj, GError **error)
 
   if (!_atspi_accessible_test_cache (obj, ATSPI_CACHE_ROLE))
   {
-    dbus_uint32_t role;
+    guint role;
     /* TODO: Make this a property */
-    if (_atspi_dbus_call (obj, atspi_interface_accessible, "GetRole", error, "=>u", &role))
+    if (_atspi_call_accessible_get_role (obj, &role, error))
     {
       obj->role = role;
     _atspi_accessible_add_cache (obj, ATSPI_CACHE_ROLE);
@@ -509,7 +522,7 @@ atspi_accessible_get_role_name (AtspiAccessible *obj, GError **error)
   if (role >= 0 && role < ATSPI_ROLE_COUNT && role != ATSPI_ROLE_EXTENDED)
     return atspi_role_get_name (role);
 
-  _atspi_dbus_call (obj, atspi_interface_accessible, "GetRoleName", error, "=>s", &retval);
+  _atspi_call_accessible_get_role_name (obj, &retval, error);
 
   if (!retval)
     retval = g_strdup ("");
@@ -534,14 +547,40 @@ gchar *
 atspi_accessible_get_localized_role_name (AtspiAccessible *obj, GError **error)
 {
   char *retval = NULL;
+  AtspiRole role;
+  GHashTable *names = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  _atspi_dbus_call (obj, atspi_interface_accessible, "GetLocalizedRoleName", error, "=>s", &retval);
+  /* Translations live in the application, but do not change while it
+   * runs, so ask it once per role */
+  role = atspi_accessible_get_role (obj, NULL);
+  if (obj->parent.app && role >= 0 && role < ATSPI_ROLE_COUNT &&
+      role != ATSPI_ROLE_EXTENDED)
+  {
+    names = g_object_get_data (G_OBJECT (obj->parent.app),
+                               "localized-role-names");
+    if (!names)
+    {
+      names = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                     NULL, g_free);
+      g_object_set_data_full (G_OBJECT (obj->parent.app),
+                              "localized-role-names", names,
+                              (GDestroyNotify) g_hash_table_unref);
+    }
+    retval = g_hash_table_lookup (names, GINT_TO_POINTER (role));
+    if (retval)
+      return g_strdup (retval);
+  }
+
+  _atspi_call_accessible_get_localized_role_name (obj, &retval, error);
 
   if (!retval)
     return g_strdup ("");
 
+  if (names)
+    g_hash_table_insert (names, GINT_TO_POINTER (role), g_strdup (retval));
+
   return retval;
 }
 
@@ -585,6 +624,126 @@ atspi_accessible_get_state_set (AtspiAccessible *obj)
   return g_object_ref (obj->states);
 }
 
+/**
+ * atspi_accessible_peek_name:
+ * @obj: a pointer to the #AtspiAccessible object on which to operate.
+ *
+ * Like atspi_accessible_get_name (), but returns the string held by @obj
+ * rather than a copy.  This avoids an allocation per call when walking
+ * large trees.
+ *
+ * Returns: (transfer none): the name of @obj, or an empty string on
+ * exception.  The string is only valid until the main loop next runs or
+ * the name is fetched or changed again; copy it to keep it longer.
+ **/
+const gchar *
+atspi_accessible_peek_name (AtspiAccessible *obj, GError **error)
+{
+  g_return_val_if_fail (obj != NULL, "");
+  if (!_atspi_accessible_test_cache (obj, ATSPI_CACHE_NAME))
+  {
+    if (!_atspi_dbus_get_property (obj, atspi_interface_accessible, "Name", error,
+                                   "s", &obj->name))
+      return "";
+    _atspi_accessible_add_cache (obj, ATSPI_CACHE_NAME);
+  }
+  return (obj->name ? obj->name : "");
+}
+
+/**
+ * atspi_accessible_peek_parent:
+ * @obj: a pointer to the #AtspiAccessible object to query.
+ *
+ * Like atspi_accessible_get_parent (), but does not add a reference to
+ * the returned object.
+ *
+ * Returns: (nullable) (transfer none): the parent of @obj, or NULL if it
+ * has none.  The pointer is only valid until the main loop next runs or
+ * the parent is fetched or changed again; take a reference to keep it
+ * longer.
+ **/
+AtspiAccessible *
+atspi_accessible_peek_parent (AtspiAccessible *obj, GError **error)
+{
+  AtspiAccessible *parent;
+
+  g_return_val_if_fail (obj != NULL, NULL);
+
+  if (obj->parent.app &&
+      !_atspi_accessible_test_cache (obj, ATSPI_CACHE_PARENT))
+  {
+    /* This stores the parent in obj->accessible_parent */
+    parent = atspi_accessible_get_parent (obj, error);
+    if (parent)
+      g_object_unref (parent);
+  }
+  return obj->accessible_parent;
+}
+
+/**
+ * atspi_accessible_peek_child_at_index:
+ * @obj: a pointer to the #AtspiAccessible object on which to operate.
+ * @child_index: a #long indicating which child is specified.
+ *
+ * Like atspi_accessible_get_child_at_index (), but does not add a
+ * reference to the returned object.
+ *
+ * Returns: (nullable) (transfer none): the child of @obj at index
+ * @child_index, or NULL on exception.  The pointer is only valid until
+ * the main loop next runs or the children of @obj change; take a
+ * reference to keep it longer.
+ **/
+AtspiAccessible *
+atspi_accessible_peek_child_at_index (AtspiAccessible *obj,
+                                      gint child_index,
+                                      GError **error)
+{
+  AtspiAccessible *child;
+
+  g_return_val_if_fail (obj != NULL, NULL);
+
+  if (_atspi_accessible_test_cache (obj, ATSPI_CACHE_CHILDREN))
+  {
+    if (!obj->children || child_index < 0 ||
+        child_index >= obj->children->len)
+      return NULL;
+    child = g_ptr_array_index (obj->children, child_index);
+    if (child)
+      return child;
+  }
+
+  /* The application's object table keeps the child alive after we drop
+   * our reference, until it is removed by the application */
+  child = atspi_accessible_get_child_at_index (obj, child_index, error);
+  if (child)
+    g_object_unref (child);
+  return child;
+}
+
+/**
+ * atspi_accessible_peek_states_mask:
+ * @obj: a pointer to the #AtspiAccessible object on which to operate.
+ *
+ * Gets the states of @obj as a bit mask, without creating an
+ * #AtspiStateSet for the caller.  Bit N is set if @obj has the #AtspiStateType
+ * with value N.
+ *
+ * Returns: the states of @obj, or 0 if the object is defunct.
+ **/
+guint64
+atspi_accessible_peek_states_mask (AtspiAccessible *obj)
+{
+  g_return_val_if_fail (obj != NULL, 0);
+
+  if (!obj->parent.app || !obj->parent.app->bus)
+    return 0;
+
+  if (!_atspi_accessible_test_cache (obj, ATSPI_CACHE_STATES))
+    g_object_unref (atspi_accessible_get_state_set (obj));
+
+  return (obj->states ? obj->states->states : 0);
+}
+
 /**
  * atspi_accessible_get_attributes:
  * @obj: The #AtspiAccessible being queried.
@@ -600,8 +759,6 @@ atspi_accessible_get_state_set (AtspiAccessible *obj)
 GHashTable *
 atspi_accessible_get_attributes (AtspiAccessible *obj, GError **error)
 {
-  DBusMessage *message;
-
     g_return_val_if_fail (obj != NULL, NULL);
 
   if (obj->priv->cache)
@@ -613,9 +770,8 @@ atspi_accessible_get_attributes (AtspiAccessible *obj, GError **error)
 
   if (!_atspi_accessible_test_cache (obj, ATSPI_CACHE_ATTRIBUTES))
   {
-    message = _atspi_dbus_call_partial (obj, atspi_interface_accessible,
-                                        "GetAttributes", error, "");
-    obj->attributes = _atspi_dbus_return_hash_from_message (message);
+    obj->attributes = NULL;
+    _atspi_call_accessible_get_attributes (obj, &obj->attributes, error);
     _atspi_accessible_add_cache (obj, ATSPI_CACHE_ATTRIBUTES);
   }
 
@@ -1625,18 +1781,29 @@ atspi_accessible_set_cache_mask (AtspiAccessible *accessible, AtspiCache mask)
  *
  * Clears the cached information for the given accessible and all of its
  * descendants.
+ *
+ * This takes constant time: the cache of every object belonging to the
+ * same application as @obj (or of every object, if @obj is the desktop)
+ * is marked stale and is dropped when next used.
  */
 void
 atspi_accessible_clear_cache (AtspiAccessible *obj)
 {
-  gint i;
+  AtspiApplication *app;
 
-  if (obj)
-  {
-    obj->cached_properties = ATSPI_CACHE_NONE;
-    for (i = 0; i < obj->children->len; i++)
-      atspi_accessible_clear_cache (g_ptr_array_index (obj->children, i));
-  }
+  if (!obj)
+    return;
+
+  _atspi_accessible_remove_cache (obj, ATSPI_CACHE_ALL);
+  obj->priv->screen_extents_time = 0;
+
+  /* Set atomically, as cache views read these from other threads */
+  app = obj->parent.app;
+  if (!app || !strcmp (app->bus_name, atspi_bus_registry))
+    g_atomic_int_set (&cache_cleared_generation, ++cache_generation);
+  else
+    g_atomic_int_set (&app->cache_generation, ++cache_generation);
+  obj->priv->cache_generation = cache_generation;
 }
 
 /**
@@ -1709,19 +1876,96 @@ _atspi_accessible_get_cache_mask (AtspiAccessible *accessible)
   if (mask == ATSPI_CACHE_UNDEFINED)
     mask = ATSPI_CACHE_DEFAULT;
 
+  mask &= ~_ATSPI_CACHE_EVENT_DRIVEN | _atspi_event_listener_get_cache_mask ();
+
   return mask;
 }
 
+/*
+ * Returns accessible->cached_properties, first dropping them if the cache
+ * has been cleared since they were set.  Use this rather than reading the
+ * field directly.
+ */
+AtspiCache
+_atspi_accessible_get_cached_properties (AtspiAccessible *accessible)
+{
+  AtspiAccessiblePrivate *priv = accessible->priv;
+  guint current = cache_cleared_generation;
+
+  if (accessible->parent.app &&
+      accessible->parent.app->cache_generation > current)
+    current = accessible->parent.app->cache_generation;
+
+  if (priv->cache_generation < current)
+  {
+    if (accessible->cached_properties)
+      _atspi_statistics_cache_invalidated (accessible,
+                                           accessible->cached_properties);
+    accessible->cached_properties = ATSPI_CACHE_NONE;
+    priv->screen_extents_time = 0;
+    priv->cache_generation = current;
+  }
+  return accessible->cached_properties;
+}
+
+/*
+ * Returns the generation below which the cache of objects belonging to
+ * @app is stale.  Unlike the rest of the cache, this may be read from
+ * any thread.
+ */
+guint
+_atspi_accessible_stale_generation (AtspiApplication *app)
+{
+  guint current = g_atomic_int_get (&cache_cleared_generation);
+  guint app_generation;
+
+  if (!app)
+    return current;
+  app_generation = g_atomic_int_get (&app->cache_generation);
+  return MAX (current, app_generation);
+}
+
+/*
+ * Like _atspi_accessible_test_cache (), but checks that all of @flags are
+ * cached, and does not count as a lookup.
+ */
+gboolean
+_atspi_accessible_is_cached (AtspiAccessible *accessible, AtspiCache flags)
+{
+  AtspiCache cached = _atspi_accessible_get_cached_properties (accessible) &
+                      _atspi_accessible_get_cache_mask (accessible);
+
+  if (atspi_no_cache || !(atspi_main_loop || enable_caching))
+    return FALSE;
+  if (accessible->states &&
+      atspi_state_set_contains (accessible->states, ATSPI_STATE_TRANSIENT))
+    return FALSE;
+  return ((cached & flags) == flags);
+}
+
+/* Returns a value that changes whenever any cache is cleared */
+guint
+_atspi_accessible_get_cache_generation (void)
+{
+  return cache_generation;
+}
+
 gboolean
 _atspi_accessible_test_cache (AtspiAccessible *accessible, AtspiCache flag)
 {
   AtspiCache mask = _atspi_accessible_get_cache_mask (accessible);
-  AtspiCache result = accessible->cached_properties & mask & flag;
+  AtspiCache result = _atspi_accessible_get_cached_properties (accessible) &
+                      mask & flag;
+  gboolean hit;
+
   if (accessible->states && atspi_state_set_contains (accessible->states, ATSPI_STATE_TRANSIENT))
-    return FALSE;
-  return (result != 0 && (atspi_main_loop || enable_caching ||
-                          flag == ATSPI_CACHE_INTERFACES) &&
-          !atspi_no_cache);
+    hit = FALSE;
+  else
+    hit = (result != 0 && (atspi_main_loop || enable_caching ||
+                           flag == ATSPI_CACHE_INTERFACES) &&
+           !atspi_no_cache);
+  _atspi_statistics_cache_lookup (accessible, flag, hit);
+  return hit;
 }
 
 void
@@ -1729,7 +1973,23 @@ _atspi_accessible_add_cache (AtspiAccessible *accessible, AtspiCache flag)
 {
   AtspiCache mask = _atspi_accessible_get_cache_mask (accessible);
 
+  /* Don't let a new flag revive stale ones */
+  _atspi_accessible_get_cached_properties (accessible);
   accessible->cached_properties |= flag & mask;
+  _atspi_accessible_cache_changed (accessible);
+}
+
+void
+_atspi_accessible_remove_cache (AtspiAccessible *accessible, AtspiCache flag)
+{
+  AtspiCache removed = accessible->cached_properties & flag;
+
+  if (removed)
+  {
+    _atspi_statistics_cache_invalidated (accessible, removed);
+    accessible->cached_properties &= ~flag;
+    _atspi_accessible_cache_changed (accessible);
+  }
 }
 
 /**
@@ -1773,6 +2033,183 @@ free_value (gpointer data)
   g_free (value);
 }
 
+/*
+ * Children arrays are public and contiguous, so inserting or removing a
+ * child still moves the pointers after it.  What we avoid is searching:
+ * each child remembers its index, and each parent logs the inserts and
+ * removals made since.  A child's current index is its remembered one
+ * adjusted by the log entries it has not seen, and the log is folded back
+ * into the children once it grows to about the square root of their
+ * number, which keeps both steps sublinear.
+ */
+
+typedef struct
+{
+  gint index;
+  gint delta;
+} ChildShift;
+
+#define MIN_CHILD_SHIFTS 16
+
+static guint
+child_shift_seq (AtspiAccessible *parent)
+{
+  AtspiAccessiblePrivate *priv = parent->priv;
+
+  return priv->child_shift_base +
+         (priv->child_shifts ? priv->child_shifts->len : 0);
+}
+
+static void
+note_child_index (AtspiAccessible *parent, AtspiAccessible *child, gint index)
+{
+  child->priv->children_owner = parent;
+  child->priv->index_in_parent = index;
+  child->priv->child_shift_seq = child_shift_seq (parent);
+}
+
+static void
+fold_child_shifts (AtspiAccessible *parent)
+{
+  AtspiAccessiblePrivate *priv = parent->priv;
+  gint i;
+
+  priv->child_shift_base += priv->child_shifts->len;
+  g_array_set_size (priv->child_shifts, 0);
+  for (i = 0; i < parent->children->len; i++)
+  {
+    AtspiAccessible *child = g_ptr_array_index (parent->children, i);
+    if (child)
+      note_child_index (parent, child, i);
+  }
+}
+
+static void
+log_child_shift (AtspiAccessible *parent, gint index, gint delta)
+{
+  AtspiAccessiblePrivate *priv = parent->priv;
+  ChildShift shift = { index, delta };
+  guint n;
+
+  if (!priv->child_shifts)
+    priv->child_shifts = g_array_new (FALSE, FALSE, sizeof (ChildShift));
+  g_array_append_val (priv->child_shifts, shift);
+
+  n = priv->child_shifts->len;
+  if (n > MIN_CHILD_SHIFTS && n * n > parent->children->len)
+    fold_child_shifts (parent);
+}
+
+/*
+ * Returns the index of @child in @parent's children array, or -1 if it
+ * is not there.  The recorded position is only for the array @child was
+ * last put in; it can still be in another one for a while, eg, when a
+ * reparent's add reaches the new parent before the remove reaches the
+ * old one, so other arrays are scanned.
+ */
+gint
+_atspi_accessible_find_child (AtspiAccessible *parent, AtspiAccessible *child)
+{
+  AtspiAccessiblePrivate *priv = parent->priv;
+  GPtrArray *children = parent->children;
+  AtspiAccessible *owner = child->priv->children_owner;
+  gint index, i;
+
+  if (!children)
+    return -1;
+
+  index = child->priv->index_in_parent;
+  if (owner == parent && child->priv->child_shift_seq >= priv->child_shift_base)
+  {
+    for (i = child->priv->child_shift_seq - priv->child_shift_base;
+         priv->child_shifts && i < priv->child_shifts->len; i++)
+    {
+      ChildShift *shift = &g_array_index (priv->child_shifts, ChildShift, i);
+      if (shift->delta > 0 ? index >= shift->index : index > shift->index)
+        index += shift->delta;
+    }
+    if (index >= 0 && index < children->len &&
+        g_ptr_array_index (children, index) == child)
+    {
+      note_child_index (parent, child, index);
+      return index;
+    }
+  }
+
+  /* The array was changed behind our back (eg, truncated), or @child
+   * has been put in another one since */
+  for (i = 0; i < children->len; i++)
+    if (g_ptr_array_index (children, i) == child)
+    {
+      if (!owner || owner == parent)
+        note_child_index (parent, child, i);
+      return i;
+    }
+  if (owner == parent)
+    child->priv->children_owner = NULL;
+  return -1;
+}
+
+/* Stores @child at @index, growing the array if needed, without moving
+ * any other child */
+void
+_atspi_accessible_set_child (AtspiAccessible *parent, gint index,
+                             AtspiAccessible *child)
+{
+  AtspiAccessible *old;
+
+  if (index >= parent->children->len)
+    g_ptr_array_set_size (parent->children, index + 1);
+  old = g_ptr_array_index (parent->children, index);
+  if (old == child)
+    return;
+  if (old)
+  {
+    if (old->priv->children_owner == parent)
+      old->priv->children_owner = NULL;
+    g_object_unref (old);
+  }
+  g_ptr_array_index (parent->children, index) = g_object_ref (child);
+  note_child_index (parent, child, index);
+  _atspi_accessible_cache_changed (parent);
+}
+
+/* Inserts @child at @index, moving later children up by one */
+void
+_atspi_accessible_insert_child (AtspiAccessible *parent, gint index,
+                                AtspiAccessible *child)
+{
+  GPtrArray *children = parent->children;
+
+  /* Unfortunately, there's no g_ptr_array_insert or similar */
+  g_ptr_array_add (children, NULL);
+  memmove (children->pdata + index + 1, children->pdata + index,
+           (children->len - index - 1) * sizeof (gpointer));
+  g_ptr_array_index (children, index) = g_object_ref (child);
+  if (index < children->len - 1)
+    log_child_shift (parent, index, 1);
+  note_child_index (parent, child, index);
+  _atspi_accessible_cache_changed (parent);
+}
+
+/* Removes @child, moving later children down by one */
+gboolean
+_atspi_accessible_remove_child (AtspiAccessible *parent,
+                                AtspiAccessible *child)
+{
+  gint index = _atspi_accessible_find_child (parent, child);
+
+  if (index < 0)
+    return FALSE;
+  if (child->priv->children_owner == parent)
+    child->priv->children_owner = NULL;
+  g_ptr_array_remove_index (parent->children, index);
+  if (index < parent->children->len)
+    log_child_shift (parent, index, -1);
+  _atspi_accessible_cache_changed (parent);
+  return TRUE;
+}
+
 GHashTable *
 _atspi_accessible_ref_cache (AtspiAccessible *accessible)
 {
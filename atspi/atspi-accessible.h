@@ -93,6 +93,14 @@ gchar * atspi_accessible_get_localized_role_name (AtspiAccessible *obj, GError *
 
 AtspiStateSet * atspi_accessible_get_state_set (AtspiAccessible *obj);
 
+const gchar * atspi_accessible_peek_name (AtspiAccessible *obj, GError **error);
+
+AtspiAccessible * atspi_accessible_peek_parent (AtspiAccessible *obj, GError **error);
+
+AtspiAccessible * atspi_accessible_peek_child_at_index (AtspiAccessible *obj, gint child_index, GError **error);
+
+guint64 atspi_accessible_peek_states_mask (AtspiAccessible *obj);
+
 GHashTable * atspi_accessible_get_attributes (AtspiAccessible *obj, GError **error);
 
 GArray * atspi_accessible_get_attributes_as_array (AtspiAccessible *obj, GError **error);
@@ -41,6 +41,8 @@ atspi_application_dispose (GObject *object)
 {
   AtspiApplication *application = ATSPI_APPLICATION (object);
 
+  _atspi_statistics_forget_application (application);
+
   if (application->bus)
   {
     if (application->bus != _atspi_bus ())
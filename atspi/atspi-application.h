@@ -52,6 +52,7 @@ struct _AtspiApplication
   gchar *toolkit_version;
   gchar *atspi_version;
   struct timeval time_added;
+  guint cache_generation;
 };
 
 typedef struct _AtspiApplicationClass AtspiApplicationClass;
@@ -0,0 +1,551 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "atspi-private.h"
+
+/*
+ * Read-only views of the accessible cache for other threads.
+ *
+ * The cache fields of an AtspiAccessible are only ever changed on the
+ * main context, without locking.  Instead of locking every change, each
+ * accessible publishes an immutable AtspiCacheView of them: whatever
+ * changes an accessible's cache marks it, and the marked accessibles get
+ * a fresh view the next time the main context is idle.  Swapping the
+ * view is the only thing another thread can race with, so a single short
+ * lock around taking a reference is all the synchronization needed.
+ * Readers see the state as of the last publication, never a half-made
+ * change.
+ *
+ * Only accessibles that someone has asked for a view of publish one, so
+ * that clients which never read from other threads pay nothing for it.
+ * Asking from the thread that changes the cache publishes a view right
+ * away; asking from another thread has it published once that thread is
+ * idle.
+ */
+
+struct _AtspiCacheView
+{
+  gint ref_count;
+  GThread *owner;            /* the main context's thread, which frees it */
+  AtspiApplication *app;     /* for checking that the cache is current */
+  guint generation;
+  AtspiCache cached;
+  gchar *name;
+  gchar *description;
+  AtspiRole role;
+  guint64 states;
+  AtspiAccessible *parent;
+  GPtrArray *children;
+};
+
+/* Guards AtspiAccessiblePrivate.cache_view against being swapped while
+ * another thread takes a reference to it */
+static GMutex view_lock;
+
+/* Accessibles whose view is out of date */
+static GHashTable *changed;
+static GSource *publish_source;
+
+/* Accessibles (referenced) asked for by atspi_accessible_ref_cache_view ()
+ * and not yet marked as changed, and the source that will mark them;
+ * guarded by view_lock, since any thread may ask */
+static GPtrArray *requested;
+static GSource *request_source;
+
+/* The thread the cache is changed in, once it has been */
+static GThread *cache_thread;
+
+G_DEFINE_BOXED_TYPE (AtspiCacheView, atspi_cache_view, atspi_cache_view_ref,
+                     atspi_cache_view_unref)
+
+static gboolean
+cache_view_free (gpointer data)
+{
+  AtspiCacheView *view = data;
+
+  g_free (view->name);
+  g_free (view->description);
+  if (view->parent)
+    g_object_unref (view->parent);
+  if (view->children)
+    g_ptr_array_unref (view->children);
+  if (view->app)
+    g_object_unref (view->app);
+  g_free (view);
+  return G_SOURCE_REMOVE;
+}
+
+static AtspiCacheView *
+cache_view_new (AtspiAccessible *accessible)
+{
+  AtspiCacheView *view = g_new0 (AtspiCacheView, 1);
+  AtspiCache cached;
+
+  cached = _atspi_accessible_get_cached_properties (accessible) &
+           _atspi_accessible_get_cache_mask (accessible);
+  if (atspi_no_cache ||
+      (accessible->states &&
+       atspi_state_set_contains (accessible->states, ATSPI_STATE_TRANSIENT)))
+    cached = ATSPI_CACHE_NONE;
+
+  view->ref_count = 1;
+  view->owner = g_thread_self ();
+  if (accessible->parent.app)
+    view->app = g_object_ref (accessible->parent.app);
+  view->generation = accessible->priv->cache_generation;
+  view->cached = cached;
+  if (cached & ATSPI_CACHE_NAME)
+    view->name = g_strdup (accessible->name);
+  if (cached & ATSPI_CACHE_DESCRIPTION)
+    view->description = g_strdup (accessible->description);
+  view->role = accessible->role;
+  if ((cached & ATSPI_CACHE_STATES) && accessible->states)
+    view->states = accessible->states->states;
+  if ((cached & ATSPI_CACHE_PARENT) && accessible->accessible_parent)
+    view->parent = g_object_ref (accessible->accessible_parent);
+  if ((cached & ATSPI_CACHE_CHILDREN) && accessible->children)
+  {
+    guint i;
+
+    view->children = g_ptr_array_new_full (accessible->children->len,
+                                           g_object_unref);
+    for (i = 0; i < accessible->children->len; i++)
+    {
+      AtspiAccessible *child = g_ptr_array_index (accessible->children, i);
+      g_ptr_array_add (view->children, child ? g_object_ref (child) : NULL);
+    }
+  }
+  return view;
+}
+
+static void
+set_view (AtspiAccessible *accessible, AtspiCacheView *view)
+{
+  AtspiCacheView *old;
+
+  g_mutex_lock (&view_lock);
+  old = accessible->priv->cache_view;
+  accessible->priv->cache_view = view;
+  g_mutex_unlock (&view_lock);
+
+  if (old)
+    atspi_cache_view_unref (old);
+}
+
+/**
+ * atspi_accessible_publish_cache_views:
+ *
+ * Brings the views returned by atspi_accessible_ref_cache_view () up to
+ * date with the cache right away.  This otherwise happens whenever the
+ * main context is idle; call it from the main context when worker
+ * threads need the current state while no main loop is running.
+ **/
+void
+atspi_accessible_publish_cache_views (void)
+{
+  GHashTableIter iter;
+  gpointer key;
+  GPtrArray *new_requests;
+  guint i;
+
+  if (publish_source)
+  {
+    g_source_destroy (publish_source);
+    publish_source = NULL;
+  }
+
+  g_mutex_lock (&view_lock);
+  new_requests = requested;
+  requested = NULL;
+  if (request_source)
+  {
+    g_source_destroy (request_source);
+    request_source = NULL;
+  }
+  g_mutex_unlock (&view_lock);
+
+  if (new_requests)
+  {
+    for (i = 0; i < new_requests->len; i++)
+    {
+      AtspiAccessible *accessible = g_ptr_array_index (new_requests, i);
+
+      /* Not if it has gone away since */
+      if (g_atomic_int_get (&accessible->priv->cache_view_wanted))
+      {
+        if (!changed)
+          changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+        g_hash_table_add (changed, accessible);
+      }
+    }
+    /* Can dispose of accessibles, which takes them out of changed */
+    g_ptr_array_unref (new_requests);
+  }
+
+  /* Take one accessible at a time: dropping an old view can dispose of
+   * accessibles, which takes them out of the table */
+  while (changed && g_hash_table_size (changed) > 0)
+  {
+    g_hash_table_iter_init (&iter, changed);
+    g_hash_table_iter_next (&iter, &key, NULL);
+    g_hash_table_iter_remove (&iter);
+    set_view (key, cache_view_new (key));
+  }
+}
+
+static gboolean
+publish_callback (gpointer data)
+{
+  publish_source = NULL;
+  atspi_accessible_publish_cache_views ();
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+request_callback (gpointer data)
+{
+  g_mutex_lock (&view_lock);
+  request_source = NULL;
+  g_mutex_unlock (&view_lock);
+  atspi_accessible_publish_cache_views ();
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * Notes that the cache of @accessible has changed, so that its view is
+ * published again and snapshots stop reusing it.  Called by everything
+ * that updates cached_properties or the children array.
+ */
+void
+_atspi_accessible_cache_changed (AtspiAccessible *accessible)
+{
+  g_atomic_pointer_set (&cache_thread, g_thread_self ());
+  _atspi_snapshot_note_change (accessible);
+
+  if (!g_atomic_int_get (&accessible->priv->cache_view_wanted))
+    return;
+
+  if (!changed)
+    changed = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_add (changed, accessible);
+
+  if (!publish_source)
+  {
+    publish_source = g_idle_source_new ();
+    g_source_set_callback (publish_source, publish_callback, NULL, NULL);
+    g_source_attach (publish_source, atspi_main_context);
+    g_source_unref (publish_source);
+  }
+}
+
+/* Called when @accessible goes away */
+void
+_atspi_accessible_drop_cache_view (AtspiAccessible *accessible)
+{
+  g_atomic_int_set (&accessible->priv->cache_view_wanted, FALSE);
+  if (changed)
+    g_hash_table_remove (changed, accessible);
+  set_view (accessible, NULL);
+}
+
+/* Publishes a fresh view of @accessible, from now on and right away */
+static void
+publish_now (AtspiAccessible *accessible)
+{
+  g_atomic_pointer_set (&cache_thread, g_thread_self ());
+  g_atomic_int_set (&accessible->priv->cache_view_wanted, TRUE);
+  if (changed)
+    g_hash_table_remove (changed, accessible);
+  set_view (accessible, cache_view_new (accessible));
+}
+
+static void
+request_subtree (AtspiAccessible *accessible, gint depth, GHashTable *seen)
+{
+  guint i;
+
+  if (g_hash_table_contains (seen, accessible))
+    return;
+  g_hash_table_add (seen, accessible);
+  publish_now (accessible);
+
+  if (depth == 0 || !accessible->children ||
+      !(_atspi_accessible_get_cached_properties (accessible) &
+        ATSPI_CACHE_CHILDREN))
+    return;
+  for (i = 0; i < accessible->children->len; i++)
+  {
+    AtspiAccessible *child = g_ptr_array_index (accessible->children, i);
+    if (child)
+      request_subtree (child, (depth > 0 ? depth - 1 : depth), seen);
+  }
+}
+
+/**
+ * atspi_accessible_request_cache_views:
+ * @root: the #AtspiAccessible at the top of the subtree.
+ * @depth: how many levels of cached descendants to include, or -1 for
+ *         all.
+ *
+ * Publishes views of @root and of its descendants, so that worker
+ * threads find them on their first call to
+ * atspi_accessible_ref_cache_view (), and keeps them up to date from
+ * then on.  Only descendants that are already in the cache are visited;
+ * nothing is fetched.  Call it from the main context.
+ **/
+void
+atspi_accessible_request_cache_views (AtspiAccessible *root, gint depth)
+{
+  GHashTable *seen;
+
+  g_return_if_fail (ATSPI_IS_ACCESSIBLE (root));
+
+  seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+  request_subtree (root, depth, seen);
+  g_hash_table_destroy (seen);
+}
+
+/**
+ * atspi_accessible_ref_cache_view:
+ * @accessible: an #AtspiAccessible.
+ *
+ * Gets the most recently published view of what is cached for
+ * @accessible.  Unlike the other accessors, this may be called from any
+ * thread, provided the caller holds a reference to @accessible.  The
+ * view never changes and never makes D-Bus calls; properties that were
+ * not cached when it was published are simply missing from it.
+ *
+ * Views are only published for accessibles that have been asked about.
+ * Called from the main context's thread, this publishes an up-to-date
+ * view of @accessible first if need be.  From any other thread, the
+ * first call for @accessible returns NULL and has its view published
+ * when the main context is next idle, or on
+ * atspi_accessible_publish_cache_views (); use
+ * atspi_accessible_request_cache_views () beforehand to avoid that.
+ * Once published, the view follows every change to the cache of
+ * @accessible.
+ *
+ * Returns: (transfer full) (nullable): the view, or NULL if nothing has
+ * been published for @accessible yet.
+ **/
+AtspiCacheView *
+atspi_accessible_ref_cache_view (AtspiAccessible *accessible)
+{
+  AtspiCacheView *view;
+
+  g_return_val_if_fail (ATSPI_IS_ACCESSIBLE (accessible), NULL);
+
+  /* Nothing else swaps views on this thread, so no need to lock */
+  if (g_thread_self () == g_atomic_pointer_get (&cache_thread))
+  {
+    if (!accessible->priv->cache_view ||
+        (changed && g_hash_table_contains (changed, accessible)))
+      publish_now (accessible);
+    return atspi_cache_view_ref (accessible->priv->cache_view);
+  }
+
+  g_mutex_lock (&view_lock);
+  view = accessible->priv->cache_view;
+  if (view)
+    g_atomic_int_inc (&view->ref_count);
+  else if (!g_atomic_int_get (&accessible->priv->cache_view_wanted))
+  {
+    g_atomic_int_set (&accessible->priv->cache_view_wanted, TRUE);
+    if (!requested)
+      requested = g_ptr_array_new_with_free_func (g_object_unref);
+    g_ptr_array_add (requested, g_object_ref (accessible));
+    if (!request_source)
+    {
+      request_source = g_idle_source_new ();
+      g_source_set_callback (request_source, request_callback, NULL, NULL);
+      g_source_attach (request_source, atspi_main_context);
+      g_source_unref (request_source);
+    }
+  }
+  g_mutex_unlock (&view_lock);
+  return view;
+}
+
+/**
+ * atspi_cache_view_ref:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: (transfer full): @view, with a reference added.
+ **/
+AtspiCacheView *
+atspi_cache_view_ref (AtspiCacheView *view)
+{
+  g_atomic_int_inc (&view->ref_count);
+  return view;
+}
+
+/**
+ * atspi_cache_view_unref:
+ * @view: an #AtspiCacheView.
+ *
+ * Drops a reference to @view.  The last one may be dropped on any
+ * thread; the objects the view refers to are then released on the main
+ * context.
+ **/
+void
+atspi_cache_view_unref (AtspiCacheView *view)
+{
+  GSource *source;
+
+  if (!g_atomic_int_dec_and_test (&view->ref_count))
+    return;
+
+  /* Releasing the last reference to an accessible disposes of it,
+   * which must happen where the cache is changed */
+  if (g_thread_self () == view->owner)
+  {
+    cache_view_free (view);
+    return;
+  }
+  source = g_idle_source_new ();
+  g_source_set_callback (source, cache_view_free, view, NULL);
+  g_source_attach (source, atspi_main_context);
+  g_source_unref (source);
+}
+
+/**
+ * atspi_cache_view_get_cached:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: the #AtspiCache flags for the properties held by @view.  This
+ * is empty if the cache has been cleared since @view was published.
+ **/
+AtspiCache
+atspi_cache_view_get_cached (AtspiCacheView *view)
+{
+  g_return_val_if_fail (view != NULL, ATSPI_CACHE_NONE);
+
+  if (view->generation < _atspi_accessible_stale_generation (view->app))
+    return ATSPI_CACHE_NONE;
+  return view->cached;
+}
+
+/**
+ * atspi_cache_view_get_name:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: (transfer none) (nullable): the cached name, or NULL if it was
+ * not cached.  The string lives as long as @view.
+ **/
+const gchar *
+atspi_cache_view_get_name (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_NAME))
+    return NULL;
+  return (view->name ? view->name : "");
+}
+
+/**
+ * atspi_cache_view_get_description:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: (transfer none) (nullable): the cached description, or NULL if
+ * it was not cached.  The string lives as long as @view.
+ **/
+const gchar *
+atspi_cache_view_get_description (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_DESCRIPTION))
+    return NULL;
+  return (view->description ? view->description : "");
+}
+
+/**
+ * atspi_cache_view_get_role:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: the cached role, or %ATSPI_ROLE_INVALID if it was not cached.
+ **/
+AtspiRole
+atspi_cache_view_get_role (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_ROLE))
+    return ATSPI_ROLE_INVALID;
+  return view->role;
+}
+
+/**
+ * atspi_cache_view_get_states:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: the cached states as a bit mask indexed by #AtspiStateType,
+ * or 0 if they were not cached.
+ **/
+guint64
+atspi_cache_view_get_states (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_STATES))
+    return 0;
+  return view->states;
+}
+
+/**
+ * atspi_cache_view_get_parent:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: (transfer none) (nullable): the cached parent, or NULL if it
+ * was not cached or there is none.  The parent stays alive as long as
+ * @view does.
+ **/
+AtspiAccessible *
+atspi_cache_view_get_parent (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_PARENT))
+    return NULL;
+  return view->parent;
+}
+
+/**
+ * atspi_cache_view_get_child_count:
+ * @view: an #AtspiCacheView.
+ *
+ * Returns: the number of cached children, or -1 if the children were
+ * not cached.
+ **/
+gint
+atspi_cache_view_get_child_count (AtspiCacheView *view)
+{
+  if (!(atspi_cache_view_get_cached (view) & ATSPI_CACHE_CHILDREN) ||
+      !view->children)
+    return -1;
+  return view->children->len;
+}
+
+/**
+ * atspi_cache_view_get_child_at_index:
+ * @view: an #AtspiCacheView.
+ * @child_index: the index of the child, counting from 0.
+ *
+ * Returns: (transfer none) (nullable): the cached child, or NULL if the
+ * children were not cached or this one is not known.  The child stays
+ * alive as long as @view does.
+ **/
+AtspiAccessible *
+atspi_cache_view_get_child_at_index (AtspiCacheView *view, gint child_index)
+{
+  if (child_index < 0 || child_index >= atspi_cache_view_get_child_count (view))
+    return NULL;
+  return g_ptr_array_index (view->children, child_index);
+}
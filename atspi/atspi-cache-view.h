@@ -0,0 +1,79 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ATSPI_CACHE_VIEW_H_
+#define _ATSPI_CACHE_VIEW_H_
+
+#include "glib-object.h"
+
+#include "atspi-constants.h"
+
+#include "atspi-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _AtspiCacheView AtspiCacheView;
+
+#define ATSPI_TYPE_CACHE_VIEW (atspi_cache_view_get_type ())
+
+GType atspi_cache_view_get_type (void);
+
+AtspiCacheView *
+atspi_accessible_ref_cache_view (AtspiAccessible *accessible);
+
+void
+atspi_accessible_publish_cache_views (void);
+
+void
+atspi_accessible_request_cache_views (AtspiAccessible *root, gint depth);
+
+AtspiCacheView *
+atspi_cache_view_ref (AtspiCacheView *view);
+
+void
+atspi_cache_view_unref (AtspiCacheView *view);
+
+AtspiCache
+atspi_cache_view_get_cached (AtspiCacheView *view);
+
+const gchar *
+atspi_cache_view_get_name (AtspiCacheView *view);
+
+const gchar *
+atspi_cache_view_get_description (AtspiCacheView *view);
+
+AtspiRole
+atspi_cache_view_get_role (AtspiCacheView *view);
+
+guint64
+atspi_cache_view_get_states (AtspiCacheView *view);
+
+AtspiAccessible *
+atspi_cache_view_get_parent (AtspiCacheView *view);
+
+gint
+atspi_cache_view_get_child_count (AtspiCacheView *view);
+
+AtspiAccessible *
+atspi_cache_view_get_child_at_index (AtspiCacheView *view, gint child_index);
+
+G_END_DECLS
+
+#endif	/* _ATSPI_CACHE_VIEW_H_ */
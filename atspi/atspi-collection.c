@@ -271,6 +271,129 @@ atspi_collection_get_active_descendant (AtspiCollection *collection, GError **er
   return NULL;
 }
 
+G_DEFINE_TYPE (AtspiCollectionMatchCursor, atspi_collection_match_cursor, G_TYPE_OBJECT)
+
+static void
+atspi_collection_match_cursor_init (AtspiCollectionMatchCursor *cursor)
+{
+}
+
+static void
+atspi_collection_match_cursor_dispose (GObject *object)
+{
+  AtspiCollectionMatchCursor *cursor = ATSPI_COLLECTION_MATCH_CURSOR (object);
+
+  g_clear_object (&cursor->collection);
+  g_clear_object (&cursor->rule);
+  g_clear_object (&cursor->last);
+
+  G_OBJECT_CLASS (atspi_collection_match_cursor_parent_class)->dispose (object);
+}
+
+static void
+atspi_collection_match_cursor_class_init (AtspiCollectionMatchCursorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = atspi_collection_match_cursor_dispose;
+}
+
+/**
+ * atspi_collection_match_cursor_new:
+ * @collection: A pointer to the #AtspiCollection to query.
+ * @rule: An #AtspiMatchRule describing the match criteria.
+ *
+ * Creates a cursor that walks the objects in @collection matching @rule
+ * in canonical order, fetching them from the application in windows
+ * rather than all at once. Use atspi_collection_match_cursor_next () to
+ * retrieve results.
+ *
+ * Returns: (transfer full): A new #AtspiCollectionMatchCursor.
+ **/
+AtspiCollectionMatchCursor *
+atspi_collection_match_cursor_new (AtspiCollection *collection,
+                                   AtspiMatchRule *rule)
+{
+  AtspiCollectionMatchCursor *cursor;
+
+  g_return_val_if_fail (collection != NULL, NULL);
+  g_return_val_if_fail (rule != NULL, NULL);
+
+  cursor = g_object_new (ATSPI_TYPE_COLLECTION_MATCH_CURSOR, NULL);
+  cursor->collection = g_object_ref (collection);
+  cursor->rule = g_object_ref (rule);
+  return cursor;
+}
+
+/**
+ * atspi_collection_match_cursor_next:
+ * @cursor: The #AtspiCollectionMatchCursor to advance.
+ * @n: The maximum number of results to fetch; must be greater than 0.
+ *
+ * Fetches up to @n further matches. The first call issues GetMatches with
+ * a count of @n; later calls continue after the last object returned by
+ * means of GetMatchesFrom, so only one window of references is marshalled
+ * and wrapped at a time.
+ *
+ * Returns: (element-type AtspiAccessible*) (transfer full): The next
+ *          matching #AtspiAccessible objects, an empty array once the
+ *          matches are exhausted, or NULL on exception.
+ **/
+GArray *
+atspi_collection_match_cursor_next (AtspiCollectionMatchCursor *cursor,
+                                    gint n,
+                                    GError **error)
+{
+  GArray *ret;
+
+  g_return_val_if_fail (cursor != NULL, NULL);
+  g_return_val_if_fail (n > 0, NULL);
+
+  if (cursor->done)
+    return g_array_new (TRUE, TRUE, sizeof (AtspiAccessible *));
+
+  if (!cursor->last)
+    ret = atspi_collection_get_matches (cursor->collection, cursor->rule,
+                                        ATSPI_Collection_SORT_ORDER_CANONICAL,
+                                        n, FALSE, error);
+  else
+    ret = atspi_collection_get_matches_from (cursor->collection, cursor->last,
+                                             cursor->rule,
+                                             ATSPI_Collection_SORT_ORDER_CANONICAL,
+                                             ATSPI_Collection_TREE_INORDER,
+                                             n, FALSE, error);
+  if (!ret)
+    return NULL;
+
+  if (ret->len < n)
+    cursor->done = TRUE;
+  if (ret->len > 0)
+  {
+    AtspiAccessible *last = g_array_index (ret, AtspiAccessible *, ret->len - 1);
+    g_clear_object (&cursor->last);
+    if (last)
+      cursor->last = g_object_ref (last);
+    else
+      cursor->done = TRUE;
+  }
+  return ret;
+}
+
+/**
+ * atspi_collection_match_cursor_is_done:
+ * @cursor: The #AtspiCollectionMatchCursor to query.
+ *
+ * Returns: #TRUE if the application has no more matches to report for
+ *          @cursor, #FALSE otherwise.
+ **/
+gboolean
+atspi_collection_match_cursor_is_done (AtspiCollectionMatchCursor *cursor)
+{
+  g_return_val_if_fail (cursor != NULL, TRUE);
+
+  return cursor->done;
+}
+
 static void
 atspi_collection_base_init (AtspiCollection *klass)
 {
@@ -57,6 +57,37 @@ GArray * atspi_collection_get_matches_from (AtspiCollection *collection, AtspiAc
 
 AtspiAccessible * atspi_collection_get_active_descendant (AtspiCollection *collection, GError **error);
 
+#define ATSPI_TYPE_COLLECTION_MATCH_CURSOR                (atspi_collection_match_cursor_get_type ())
+#define ATSPI_COLLECTION_MATCH_CURSOR(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), ATSPI_TYPE_COLLECTION_MATCH_CURSOR, AtspiCollectionMatchCursor))
+#define ATSPI_COLLECTION_MATCH_CURSOR_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), ATSPI_TYPE_COLLECTION_MATCH_CURSOR, AtspiCollectionMatchCursorClass))
+#define ATSPI_IS_COLLECTION_MATCH_CURSOR(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), ATSPI_TYPE_COLLECTION_MATCH_CURSOR))
+#define ATSPI_IS_COLLECTION_MATCH_CURSOR_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), ATSPI_TYPE_COLLECTION_MATCH_CURSOR))
+#define ATSPI_COLLECTION_MATCH_CURSOR_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), ATSPI_TYPE_COLLECTION_MATCH_CURSOR, AtspiCollectionMatchCursorClass))
+
+typedef struct _AtspiCollectionMatchCursor AtspiCollectionMatchCursor;
+struct _AtspiCollectionMatchCursor
+{
+  GObject parent;
+  AtspiCollection *collection;
+  AtspiMatchRule *rule;
+  AtspiAccessible *last;
+  gboolean done;
+};
+
+typedef struct _AtspiCollectionMatchCursorClass AtspiCollectionMatchCursorClass;
+struct _AtspiCollectionMatchCursorClass
+{
+  GObjectClass parent_class;
+};
+
+GType atspi_collection_match_cursor_get_type ();
+
+AtspiCollectionMatchCursor * atspi_collection_match_cursor_new (AtspiCollection *collection, AtspiMatchRule *rule);
+
+GArray * atspi_collection_match_cursor_next (AtspiCollectionMatchCursor *cursor, gint n, GError **error);
+
+gboolean atspi_collection_match_cursor_is_done (AtspiCollectionMatchCursor *cursor);
+
 G_END_DECLS
 
 #endif	/* _ATSPI_COLLECTION_H_ */
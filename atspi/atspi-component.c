@@ -79,13 +79,11 @@ atspi_component_contains (AtspiComponent *obj,
                               gint y,
                               AtspiCoordType ctype, GError **error)
 {
-  dbus_bool_t retval = FALSE;
-  dbus_int32_t d_x = x, d_y = y;
-  dbus_uint32_t d_ctype = ctype;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_component, "Contains", error, "iiu=>b", d_x, d_y, d_ctype, &retval);
+  _atspi_call_component_contains (obj, x, y, ctype, &retval, error);
 
   return retval;
 }
@@ -111,15 +109,344 @@ atspi_component_get_accessible_at_point (AtspiComponent *obj,
                                           gint y,
                                           AtspiCoordType ctype, GError **error)
 {
-  dbus_int32_t d_x = x, d_y = y;
-  dbus_uint32_t d_ctype = ctype;
-  DBusMessage *reply;
+  AtspiAccessible *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_component, "GetAccessibleAtPoint", error, "iiu", d_x, d_y, d_ctype);
+  _atspi_call_component_get_accessible_at_point (obj, x, y, ctype, &retval,
+                                                 error);
+
+  return retval;
+}
+
+/*
+ * Screen extents pushed with events (Component.ScreenExtents) or announced
+ * by object:bounds-changed are kept per accessible and entered into a grid
+ * index, one per top-level window, so that hit tests can be answered
+ * without a round trip per level of the hierarchy. The index holds no
+ * references; an accessible leaves it when it is disposed.
+ */
+
+#define EXTENTS_CELL_SIZE 128
+#define EXTENTS_MAX_CELLS 256
+
+typedef struct
+{
+  AtspiAccessible *key;
+  GHashTable *cells;
+  GPtrArray *oversize;
+  gint64 stale_before;
+} ExtentsIndex;
+
+static GHashTable *extents_indexes = NULL;
+
+static gint
+extents_cell (gint coord)
+{
+  return (coord >= 0 ? coord / EXTENTS_CELL_SIZE
+                     : (coord + 1) / EXTENTS_CELL_SIZE - 1);
+}
+
+static gpointer
+extents_cell_key (gint cx, gint cy)
+{
+  return GUINT_TO_POINTER (((guint) (cx & 0xffff) << 16) | (guint) (cy & 0xffff));
+}
+
+static gboolean
+extents_is_oversize (const AtspiRect *r)
+{
+  gint w = extents_cell (r->x + r->width - 1) - extents_cell (r->x) + 1;
+  gint h = extents_cell (r->y + r->height - 1) - extents_cell (r->y) + 1;
+
+  return (w * h > EXTENTS_MAX_CELLS);
+}
+
+static void
+extents_index_free (ExtentsIndex *index)
+{
+  GHashTableIter iter;
+  gpointer value;
+  gint i;
+
+  g_hash_table_iter_init (&iter, index->cells);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+  {
+    GPtrArray *cell = value;
+    for (i = 0; i < cell->len; i++)
+    {
+      AtspiAccessible *a = g_ptr_array_index (cell, i);
+      a->priv->extents_index_key = NULL;
+    }
+  }
+  for (i = 0; i < index->oversize->len; i++)
+  {
+    AtspiAccessible *a = g_ptr_array_index (index->oversize, i);
+    a->priv->extents_index_key = NULL;
+  }
+  g_hash_table_destroy (index->cells);
+  g_ptr_array_free (index->oversize, TRUE);
+  g_free (index);
+}
+
+/* Returns the ancestor of @obj directly below its application's root (ie,
+ * its top-level window), @obj itself if it is such a window, or the root if
+ * @obj is the root. If the parent chain is not cached all the way up, the
+ * topmost known ancestor is used instead.
+ */
+static AtspiAccessible *
+window_for (AtspiAccessible *obj)
+{
+  AtspiAccessible *root = (obj->parent.app ? obj->parent.app->root : NULL);
+
+  if (obj == root)
+    return obj;
+  while (obj->accessible_parent &&
+         (_atspi_accessible_get_cached_properties (obj) & ATSPI_CACHE_PARENT) &&
+         obj->accessible_parent != root)
+    obj = obj->accessible_parent;
+  return obj;
+}
+
+static ExtentsIndex *
+get_extents_index (AtspiAccessible *key, gboolean create)
+{
+  ExtentsIndex *index;
+
+  if (!extents_indexes)
+  {
+    if (!create)
+      return NULL;
+    extents_indexes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                             NULL,
+                                             (GDestroyNotify) extents_index_free);
+  }
 
-  return _atspi_dbus_return_accessible_from_message (reply);
+  index = g_hash_table_lookup (extents_indexes, key);
+  if (!index && create)
+  {
+    index = g_new0 (ExtentsIndex, 1);
+    index->key = key;
+    index->cells = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                                          (GDestroyNotify) g_ptr_array_unref);
+    index->oversize = g_ptr_array_new ();
+    g_hash_table_insert (extents_indexes, key, index);
+  }
+  return index;
+}
+
+static void
+extents_index_remove (AtspiAccessible *accessible)
+{
+  AtspiAccessiblePrivate *priv = accessible->priv;
+  const AtspiRect *r = &priv->screen_extents;
+  ExtentsIndex *index;
+  gint cx, cy;
+
+  if (!priv->extents_index_key)
+    return;
+  index = get_extents_index (priv->extents_index_key, FALSE);
+  priv->extents_index_key = NULL;
+  if (!index)
+    return;
+
+  if (extents_is_oversize (r))
+  {
+    g_ptr_array_remove_fast (index->oversize, accessible);
+    return;
+  }
+
+  for (cx = extents_cell (r->x); cx <= extents_cell (r->x + r->width - 1); cx++)
+    for (cy = extents_cell (r->y); cy <= extents_cell (r->y + r->height - 1); cy++)
+    {
+      GPtrArray *cell = g_hash_table_lookup (index->cells,
+                                             extents_cell_key (cx, cy));
+      if (cell)
+        g_ptr_array_remove_fast (cell, accessible);
+    }
+}
+
+static void
+extents_index_add (AtspiAccessible *accessible)
+{
+  AtspiAccessiblePrivate *priv = accessible->priv;
+  const AtspiRect *r = &priv->screen_extents;
+  AtspiAccessible *key;
+  ExtentsIndex *index;
+  gint cx, cy;
+
+  if (r->width <= 0 || r->height <= 0)
+    return;
+
+  if (accessible->accessible_parent &&
+      (_atspi_accessible_get_cached_properties (accessible) & ATSPI_CACHE_PARENT))
+    key = window_for (accessible->accessible_parent);
+  else
+    key = window_for (accessible);
+  index = get_extents_index (key, TRUE);
+  priv->extents_index_key = key;
+
+  if (extents_is_oversize (r))
+  {
+    g_ptr_array_add (index->oversize, accessible);
+    return;
+  }
+
+  for (cx = extents_cell (r->x); cx <= extents_cell (r->x + r->width - 1); cx++)
+    for (cy = extents_cell (r->y); cy <= extents_cell (r->y + r->height - 1); cy++)
+    {
+      gpointer cell_key = extents_cell_key (cx, cy);
+      GPtrArray *cell = g_hash_table_lookup (index->cells, cell_key);
+      if (!cell)
+      {
+        cell = g_ptr_array_new ();
+        g_hash_table_insert (index->cells, cell_key, cell);
+      }
+      g_ptr_array_add (cell, accessible);
+    }
+}
+
+void
+_atspi_component_set_screen_extents (AtspiAccessible *accessible,
+                                     const AtspiRect *extents)
+{
+  AtspiAccessiblePrivate *priv = accessible->priv;
+
+  extents_index_remove (accessible);
+  priv->screen_extents = *extents;
+  priv->screen_extents_time = g_get_monotonic_time ();
+  extents_index_add (accessible);
+}
+
+void
+_atspi_component_clear_screen_extents (AtspiAccessible *accessible)
+{
+  extents_index_remove (accessible);
+  accessible->priv->screen_extents_time = 0;
+
+  /* If @accessible was itself a window, drop the index of its contents */
+  if (extents_indexes)
+    g_hash_table_remove (extents_indexes, accessible);
+}
+
+/* Marks every extent cached for the window containing @accessible as stale,
+ * eg. because the window has moved and all screen coordinates shifted.
+ */
+void
+_atspi_component_invalidate_screen_extents (AtspiAccessible *accessible)
+{
+  ExtentsIndex *index = get_extents_index (window_for (accessible), FALSE);
+
+  if (index)
+    index->stale_before = g_get_monotonic_time () + 1;
+}
+
+static gboolean
+extents_contains (AtspiAccessible *a, gint x, gint y)
+{
+  const AtspiRect *r = &a->priv->screen_extents;
+
+  return (x >= r->x && x < r->x + r->width &&
+          y >= r->y && y < r->y + r->height);
+}
+
+static AtspiAccessible *
+lookup_child_at_point (AtspiAccessible *parent, gint x, gint y,
+                       gint64 min_time, gint64 *time_out)
+{
+  ExtentsIndex *index = get_extents_index (window_for (parent), FALSE);
+  GPtrArray *candidates[2];
+  AtspiAccessible *best = NULL;
+  gint i, j;
+
+  if (!index)
+    return NULL;
+  min_time = MAX (min_time, index->stale_before);
+
+  candidates[0] = g_hash_table_lookup (index->cells,
+                                       extents_cell_key (extents_cell (x),
+                                                         extents_cell (y)));
+  candidates[1] = index->oversize;
+  for (i = 0; i < 2; i++)
+  {
+    if (!candidates[i])
+      continue;
+    for (j = 0; j < candidates[i]->len; j++)
+    {
+      AtspiAccessible *a = g_ptr_array_index (candidates[i], j);
+      if (a->accessible_parent != parent ||
+          !(_atspi_accessible_get_cached_properties (a) & ATSPI_CACHE_PARENT) ||
+          a->priv->screen_extents_time < min_time ||
+          !extents_contains (a, x, y))
+        continue;
+      /* Among overlapping siblings, prefer the one whose extents are newest */
+      if (!best || a->priv->screen_extents_time > best->priv->screen_extents_time)
+        best = a;
+    }
+  }
+
+  if (best)
+    *time_out = best->priv->screen_extents_time;
+  return best;
+}
+
+/**
+ * atspi_component_get_accessible_at_point_cached:
+ * @obj: a pointer to the #AtspiComponent to query.
+ * @x: a #gint specifying the x coordinate of the point in question.
+ * @y: a #gint specifying the y coordinate of the point in question.
+ * @ctype: the coordinate system of the point (@x, @y)
+ *         (e.g. ATSPI_COORD_TYPE_WINDOW, ATSPI_COORD_TYPE_SCREEN).
+ * @max_age: the oldest cached extents, in milliseconds, that may be used
+ *         to answer the query, or -1 to accept extents of any age.
+ * @age: (out) (allow-none): set to the age, in milliseconds, of the cached
+ *         extents used to answer the query, or to -1 if the application
+ *         had to be asked.
+ *
+ * Like atspi_component_get_accessible_at_point (), but first consults the
+ * screen extents cached from events for the children of @obj. Only if no
+ * child with sufficiently recent extents contains the point, or @ctype is
+ * not %ATSPI_COORD_TYPE_SCREEN, is the application queried.
+ *
+ * Returns: (nullable) (transfer full): a pointer to an
+ *          #AtspiAccessible child of the specified component which
+ *          contains the point (@x, @y), or NULL if no child contains
+ *          the point.
+ **/
+AtspiAccessible *
+atspi_component_get_accessible_at_point_cached (AtspiComponent *obj,
+                                                gint x,
+                                                gint y,
+                                                AtspiCoordType ctype,
+                                                gint max_age,
+                                                gint *age,
+                                                GError **error)
+{
+  AtspiAccessible *accessible;
+
+  g_return_val_if_fail (obj != NULL, NULL);
+
+  accessible = ATSPI_ACCESSIBLE (obj);
+  if (age)
+    *age = -1;
+
+  if (ctype == ATSPI_COORD_TYPE_SCREEN && !atspi_no_cache)
+  {
+    gint64 now = g_get_monotonic_time ();
+    gint64 min_time = (max_age < 0 ? 1 : now - (gint64) max_age * 1000);
+    gint64 time = 0;
+    AtspiAccessible *child;
+
+    child = lookup_child_at_point (accessible, x, y, min_time, &time);
+    if (child)
+    {
+      if (age)
+        *age = (now - time) / 1000;
+      return g_object_ref (child);
+    }
+  }
+
+  return atspi_component_get_accessible_at_point (obj, x, y, ctype, error);
 }
 
 /**
@@ -136,7 +463,6 @@ AtspiRect *
 atspi_component_get_extents (AtspiComponent *obj,
                                 AtspiCoordType ctype, GError **error)
 {
-  dbus_uint32_t d_ctype = ctype;
   AtspiRect bbox;
   AtspiAccessible *accessible;
 
@@ -153,7 +479,7 @@ atspi_component_get_extents (AtspiComponent *obj,
     }
   }
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetExtents", error, "u=>(iiii)", d_ctype, &bbox);
+  _atspi_call_component_get_extents (obj, ctype, &bbox, error);
   return atspi_rect_copy (&bbox);
 }
 
@@ -171,8 +497,6 @@ AtspiPoint *
 atspi_component_get_position (AtspiComponent *obj,
                                  AtspiCoordType ctype, GError **error)
 {
-  dbus_int32_t d_x, d_y;
-  dbus_uint32_t d_ctype = ctype;
   AtspiPoint ret;
 
   ret.x = ret.y = -1;
@@ -180,10 +504,8 @@ atspi_component_get_position (AtspiComponent *obj,
   if (!obj)
     return atspi_point_copy (&ret);
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetPosition", error, "u=>ii", d_ctype, &d_x, &d_y);
+  _atspi_call_component_get_position (obj, ctype, &ret.x, &ret.y, error);
 
-  ret.x = d_x;
-  ret.y = d_y;
   return atspi_point_copy (&ret);
 }
 
@@ -198,16 +520,13 @@ atspi_component_get_position (AtspiComponent *obj,
 AtspiPoint *
 atspi_component_get_size (AtspiComponent *obj, GError **error)
 {
-  dbus_int32_t d_w, d_h;
   AtspiPoint ret;
 
   ret.x = ret.y = -1;
   if (!obj)
     return atspi_point_copy (&ret);
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetSize", error, "=>ii", &d_w, &d_h);
-  ret.x = d_w;
-  ret.y = d_h;
+  _atspi_call_component_get_size (obj, &ret.x, &ret.y, error);
   return atspi_point_copy (&ret);
 }
 
@@ -223,9 +542,9 @@ atspi_component_get_size (AtspiComponent *obj, GError **error)
 AtspiComponentLayer
 atspi_component_get_layer (AtspiComponent *obj, GError **error)
 {
-  dbus_uint32_t zlayer = -1;
+  guint zlayer = -1;
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetLayer", error, "=>u", &zlayer);
+  _atspi_call_component_get_layer (obj, &zlayer, error);
 
   return zlayer;
 }
@@ -243,9 +562,9 @@ atspi_component_get_layer (AtspiComponent *obj, GError **error)
 gshort
 atspi_component_get_mdi_z_order (AtspiComponent *obj, GError **error)
 {
-  dbus_uint16_t retval = -1;
+  gshort retval = -1;
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetMDIZOrder", error, "=>n", &retval);
+  _atspi_call_component_get_mdiz_order (obj, &retval, error);
 
   return retval;
 }
@@ -263,9 +582,9 @@ atspi_component_get_mdi_z_order (AtspiComponent *obj, GError **error)
 gboolean
 atspi_component_grab_focus (AtspiComponent *obj, GError **error)
 {
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GrabFocus", error, "=>b", &retval);
+  _atspi_call_component_grab_focus (obj, &retval, error);
 
   return retval;
 }
@@ -281,9 +600,9 @@ atspi_component_grab_focus (AtspiComponent *obj, GError **error)
 gdouble      
 atspi_component_get_alpha    (AtspiComponent *obj, GError **error)
 {
-  double retval = 1;
+  gdouble retval = 1;
 
-  _atspi_dbus_call (obj, atspi_interface_component, "GetAlpha", error, "=>d", &retval);
+  _atspi_call_component_get_alpha (obj, &retval, error);
 
   return retval;
 }
@@ -373,14 +692,11 @@ atspi_component_set_position (AtspiComponent *obj,
                               AtspiCoordType ctype,
                               GError **error)
 {
-  dbus_int32_t d_x = x, d_y = y;
-  dbus_uint32_t d_ctype = ctype;
-  dbus_bool_t ret = FALSE;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_component, "SetPosition", error,
-                    "iiu=>b", d_x, d_y, d_ctype, &ret);
+  _atspi_call_component_set_position (obj, x, y, ctype, &ret, error);
 
   return ret;
 }
@@ -401,13 +717,11 @@ atspi_component_set_size (AtspiComponent *obj,
                           gint height,
                           GError **error)
 {
-  dbus_int32_t d_width = width, d_height = height;
-  dbus_bool_t ret = FALSE;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_component, "SetSize", error, "ii=>b",
-                    d_width, d_height, &ret);
+  _atspi_call_component_set_size (obj, width, height, &ret, error);
 
   return ret;
 }
@@ -87,6 +87,8 @@ gboolean atspi_component_contains (AtspiComponent *obj, gint x, gint y, AtspiCoo
 
 AtspiAccessible *atspi_component_get_accessible_at_point (AtspiComponent *obj, gint x, gint y, AtspiCoordType ctype, GError **error);
 
+AtspiAccessible *atspi_component_get_accessible_at_point_cached (AtspiComponent *obj, gint x, gint y, AtspiCoordType ctype, gint max_age, gint *age, GError **error);
+
 AtspiRect *atspi_component_get_extents (AtspiComponent *obj, AtspiCoordType ctype, GError **error);
 
 AtspiPoint *atspi_component_get_position (AtspiComponent *obj, AtspiCoordType ctype, GError **error);
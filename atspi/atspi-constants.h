@@ -1331,8 +1331,12 @@ typedef enum
   ATSPI_CACHE_ROLE        = 1 << 5,
   ATSPI_CACHE_INTERFACES  = 1 << 6,
   ATSPI_CACHE_ATTRIBUTES = 1 << 7,
+  ATSPI_CACHE_CARET_OFFSET = 1 << 8,
+  ATSPI_CACHE_CURRENT_VALUE = 1 << 9,
+  ATSPI_CACHE_SELECTION_COUNT = 1 << 10,
+  ATSPI_CACHE_CHILD_COUNT = 1 << 11,
   ATSPI_CACHE_ALL         = 0x3fffffff,
-  ATSPI_CACHE_DEFAULT = ATSPI_CACHE_PARENT | ATSPI_CACHE_CHILDREN | ATSPI_CACHE_NAME | ATSPI_CACHE_DESCRIPTION | ATSPI_CACHE_STATES | ATSPI_CACHE_ROLE | ATSPI_CACHE_INTERFACES,
+  ATSPI_CACHE_DEFAULT = ATSPI_CACHE_PARENT | ATSPI_CACHE_CHILDREN | ATSPI_CACHE_NAME | ATSPI_CACHE_DESCRIPTION | ATSPI_CACHE_STATES | ATSPI_CACHE_ROLE | ATSPI_CACHE_INTERFACES | ATSPI_CACHE_CARET_OFFSET | ATSPI_CACHE_CURRENT_VALUE | ATSPI_CACHE_SELECTION_COUNT | ATSPI_CACHE_CHILD_COUNT,
   ATSPI_CACHE_UNDEFINED   = 0x40000000,
 } AtspiCache;
 
@@ -38,9 +38,34 @@ void _atspi_send_event (AtspiEvent *e);
 
 DBusHandlerResult _atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data);
 
+/* An event signal whose type has been worked out, with its iterator
+ * left at the any_data variant */
+typedef struct
+{
+  gchar *type;
+  gint detail1;
+  gint detail2;
+  DBusMessageIter iter;
+} AtspiParsedEvent;
+
+AtspiParsedEvent *_atspi_dbus_parse_event (DBusMessage *message);
+
+DBusHandlerResult _atspi_dbus_dispatch_event (DBusMessage *message, AtspiParsedEvent *parsed);
+
+void _atspi_parsed_event_free (AtspiParsedEvent *parsed);
+
 void
 _atspi_reregister_event_listeners ();
 
+/* Cache flags that are only kept up to date by events which the
+ * application emits solely while someone is listening for them */
+#define _ATSPI_CACHE_EVENT_DRIVEN (ATSPI_CACHE_CARET_OFFSET | \
+                                   ATSPI_CACHE_CURRENT_VALUE | \
+                                   ATSPI_CACHE_SELECTION_COUNT)
+
+AtspiCache
+_atspi_event_listener_get_cache_mask (void);
+
 G_END_DECLS
 
 #endif	/* _ATSPI_EVENT_LISTENER_H_ */
@@ -37,18 +37,51 @@ typedef struct
   char *name;
   char *detail;
   GArray *properties;
+  /* Bus name of the application the listener is restricted to, and the
+   * path of the subtree root within it, or NULL for the whole app */
+  char *scope_app;
+  char *scope_path;
 } EventListenerEntry;
 
-G_DEFINE_TYPE (AtspiEventListener, atspi_event_listener, G_TYPE_OBJECT)
+typedef struct _DispatchQueue DispatchQueue;
+
+typedef struct
+{
+  /* Set by atspi_event_listener_set_dispatch_context () */
+  DispatchQueue *dispatch_queue;
+} AtspiEventListenerPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (AtspiEventListener, atspi_event_listener, G_TYPE_OBJECT)
+
+static void dispatch_queue_unbind (DispatchQueue *dq);
+static void dispatch_queue_unref (gpointer data);
 
 void
 atspi_event_listener_init (AtspiEventListener *listener)
 {
 }
 
+static void
+atspi_event_listener_finalize (GObject *object)
+{
+  AtspiEventListenerPrivate *priv;
+
+  priv = atspi_event_listener_get_instance_private (ATSPI_EVENT_LISTENER (object));
+  if (priv->dispatch_queue)
+  {
+    dispatch_queue_unbind (priv->dispatch_queue);
+    dispatch_queue_unref (priv->dispatch_queue);
+  }
+
+  G_OBJECT_CLASS (atspi_event_listener_parent_class)->finalize (object);
+}
+
 void
 atspi_event_listener_class_init (AtspiEventListenerClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = atspi_event_listener_finalize;
 }
 
 static void
@@ -166,6 +199,10 @@ atspi_event_listener_new_simple (AtspiEventListenerSimpleCB callback,
 
 static GList *event_listeners = NULL;
 
+/* Cache flags from _ATSPI_CACHE_EVENT_DRIVEN whose events are currently
+ * being delivered to us */
+static AtspiCache event_cache_mask = ATSPI_CACHE_NONE;
+
 static gchar *
 convert_name_from_dbus (const char *name, gboolean path_hack)
 {
@@ -201,8 +238,10 @@ cache_process_children_changed (AtspiEvent *event)
 {
   AtspiAccessible *child;
 
+  _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_CHILD_COUNT);
+
   if (!G_VALUE_HOLDS (&event->any_data, ATSPI_TYPE_ACCESSIBLE) ||
-      !(event->source->cached_properties & ATSPI_CACHE_CHILDREN) ||
+      !(_atspi_accessible_get_cached_properties (event->source) & ATSPI_CACHE_CHILDREN) ||
       atspi_state_set_contains (event->source->states, ATSPI_STATE_MANAGES_DESCENDANTS))
     return;
 
@@ -212,27 +251,35 @@ cache_process_children_changed (AtspiEvent *event)
 
   if (!strncmp (event->type, "object:children-changed:add", 27))
   {
-    g_ptr_array_remove (event->source->children, child); /* just to be safe */
+    _atspi_accessible_remove_child (event->source, child); /* just to be safe */
     if (event->detail1 < 0 || event->detail1 > event->source->children->len)
     {
-      event->source->cached_properties &= ~ATSPI_CACHE_CHILDREN;
+      _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_CHILDREN);
       return;
     }
-    /* Unfortunately, there's no g_ptr_array_insert or similar */
-    g_ptr_array_add (event->source->children, NULL);
-    memmove (event->source->children->pdata + event->detail1 + 1,
-             event->source->children->pdata + event->detail1,
-             (event->source->children->len - event->detail1 - 1) * sizeof (gpointer));
-    g_ptr_array_index (event->source->children, event->detail1) = g_object_ref (child);
+    _atspi_accessible_insert_child (event->source, event->detail1, child);
   }
   else
   {
-    g_ptr_array_remove (event->source->children, child);
+    _atspi_accessible_remove_child (event->source, child);
+    _atspi_component_clear_screen_extents (child);
     if (child == child->parent.app->root)
       g_object_run_dispose (G_OBJECT (child->parent.app));
   }
 }
 
+static void
+cache_process_value_changed (AtspiEvent *event)
+{
+  if (G_VALUE_HOLDS_DOUBLE (&event->any_data))
+  {
+    event->source->priv->current_value = g_value_get_double (&event->any_data);
+    _atspi_accessible_add_cache (event->source, ATSPI_CACHE_CURRENT_VALUE);
+  }
+  else
+    _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_CURRENT_VALUE);
+}
+
 static void
 cache_process_property_change (AtspiEvent *event)
 {
@@ -248,7 +295,7 @@ cache_process_property_change (AtspiEvent *event)
     else
     {
       event->source->accessible_parent = NULL;
-      event->source->cached_properties &= ~ATSPI_CACHE_PARENT;
+      _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_PARENT);
     }
   }
   else if (!strcmp (event->type, "object:property-change:accessible-name"))
@@ -263,7 +310,7 @@ cache_process_property_change (AtspiEvent *event)
     else
     {
       event->source->name = NULL;
-      event->source->cached_properties &= ~ATSPI_CACHE_NAME;
+      _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_NAME);
     }
   }
   else if (!strcmp (event->type, "object:property-change:accessible-description"))
@@ -278,7 +325,7 @@ cache_process_property_change (AtspiEvent *event)
     else
     {
       event->source->description = NULL;
-      event->source->cached_properties &= ~ATSPI_CACHE_DESCRIPTION;
+      _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_DESCRIPTION);
     }
   }
   else if (!strcmp (event->type, "object:property-change:accessible-role"))
@@ -290,9 +337,20 @@ cache_process_property_change (AtspiEvent *event)
     }
     else
     {
-      event->source->cached_properties &= ~ATSPI_CACHE_ROLE;
+      _atspi_accessible_remove_cache (event->source, ATSPI_CACHE_ROLE);
     }
   }
+  else if (!strcmp (event->type, "object:property-change:accessible-value"))
+  {
+    cache_process_value_changed (event);
+  }
+}
+
+static void
+cache_process_caret_moved (AtspiEvent *event)
+{
+  event->source->priv->caret_offset = event->detail1;
+  _atspi_accessible_add_cache (event->source, ATSPI_CACHE_CARET_OFFSET);
 }
 
 static void
@@ -301,6 +359,25 @@ cache_process_state_changed (AtspiEvent *event)
   if (event->source->states)
     atspi_state_set_set_by_name (event->source->states, event->type + 21,
                                  event->detail1);
+  _atspi_accessible_cache_changed (event->source);
+  if (!event->detail1 && !strcmp (event->type, "object:state-changed:showing"))
+    _atspi_component_clear_screen_extents (event->source);
+}
+
+static void
+cache_process_bounds_changed (AtspiEvent *event)
+{
+  AtspiAccessible *source = event->source;
+  AtspiApplication *app = source->parent.app;
+
+  if (!G_VALUE_HOLDS (&event->any_data, ATSPI_TYPE_RECT))
+    return;
+
+  /* A window moving shifts the screen extents of everything inside it */
+  if (app && source->accessible_parent == app->root)
+    _atspi_component_invalidate_screen_extents (source);
+  _atspi_component_set_screen_extents (source,
+                                       g_value_get_boxed (&event->any_data));
 }
 
 static dbus_bool_t
@@ -407,6 +484,47 @@ convert_event_type_to_dbus (const char *eventType, char **categoryp, char **name
   return TRUE;
 }
 
+static gboolean
+listener_covers (EventListenerEntry *e, const char *name, const char *detail)
+{
+  /* A scoped listener only receives one application's events */
+  return (!e->scope_app && !strcmp (e->category, "Object") &&
+          (!e->name || !e->name [0] || !strcmp (e->name, name)) &&
+          (!e->detail || !detail || !strcmp (e->detail, detail)));
+}
+
+static void
+update_event_cache_mask (void)
+{
+  AtspiCache mask = ATSPI_CACHE_NONE;
+  AtspiCache lost;
+  GList *l;
+
+  for (l = event_listeners; l; l = l->next)
+  {
+    EventListenerEntry *e = l->data;
+    if (listener_covers (e, "TextCaretMoved", NULL))
+      mask |= ATSPI_CACHE_CARET_OFFSET;
+    if (listener_covers (e, "PropertyChange", "accessible-value"))
+      mask |= ATSPI_CACHE_CURRENT_VALUE;
+    if (listener_covers (e, "SelectionChanged", NULL))
+      mask |= ATSPI_CACHE_SELECTION_COUNT;
+  }
+
+  /* Once nobody listens, changes go unannounced, so anything cached
+   * under these flags cannot be trusted again later */
+  lost = event_cache_mask & ~mask;
+  event_cache_mask = mask;
+  if (lost)
+    _atspi_clear_cached_properties (lost);
+}
+
+AtspiCache
+_atspi_event_listener_get_cache_mask (void)
+{
+  return event_cache_mask;
+}
+
 static void
 listener_entry_free (EventListenerEntry *e)
 {
@@ -415,10 +533,20 @@ listener_entry_free (EventListenerEntry *e)
   g_free (e->category);
   g_free (e->name);
   if (e->detail) g_free (e->detail);
+  g_free (e->scope_app);
+  g_free (e->scope_path);
   callback_unref (callback);
   g_free (e);
 }
 
+static gchar *
+scope_match_rule (const char *matchrule, const char *scope_app)
+{
+  if (!scope_app)
+    return g_strdup (matchrule);
+  return g_strconcat (matchrule, ",sender='", scope_app, "'", NULL);
+}
+
 /**
  * atspi_event_listener_register:
  * @listener: The #AtspiEventListener to register against an event type.
@@ -531,8 +659,11 @@ atspi_event_listener_register (AtspiEventListener *listener,
  * for a description of the format and legal event types.
 * @properties: (element-type gchar*) (transfer none) (allow-none): a list of
  *             properties that should be sent along with the event. The
- *             properties are valued for the duration of the event callback.k
- *             TODO: Document.
+ *             properties are valued for the duration of the event callback.
+ *             "Name", "Description", "Role", "States", "Parent",
+ *             "ChildCount", "Text.CaretOffset" and "Value.CurrentValue"
+ *             are also stored in the accessible's cache, so querying them
+ *             from the callback does not require a round trip.
  *
  * Adds an in-process callback function to an existing #AtspiEventListener.
  *
@@ -555,11 +686,55 @@ atspi_event_listener_register_full (AtspiEventListener *listener,
                                                            error);
 }
 
+/* Appends the event type, properties and scope of @e, as expected by
+ * the registry's RegisterEvent and RegisterEvents methods */
+static void
+append_registration (DBusMessageIter *iter, EventListenerEntry *e)
+{
+  DBusMessageIter iter_array, iter_struct;
+  const char *app = (e->scope_app ? e->scope_app : "");
+  const char *path;
+  gint i;
+
+  if (!e->scope_app)
+    path = ATSPI_DBUS_PATH_NULL;
+  else
+    path = (e->scope_path ? e->scope_path : ATSPI_DBUS_PATH_ROOT);
+
+  dbus_message_iter_append_basic (iter, DBUS_TYPE_STRING, &e->event_type);
+  dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, "s", &iter_array);
+  for (i = 0; i < e->properties->len; i++)
+    dbus_message_iter_append_basic (&iter_array, DBUS_TYPE_STRING,
+                                    &g_array_index (e->properties, char *, i));
+  dbus_message_iter_close_container (iter, &iter_array);
+  dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &iter_struct);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_STRING, &app);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_OBJECT_PATH, &path);
+  dbus_message_iter_close_container (iter, &iter_struct);
+}
+
 static gboolean
 notify_event_registered (EventListenerEntry *e)
 {
 
-  if (e->properties)
+  if (e->scope_app)
+  {
+    DBusMessage *message, *reply;
+    DBusMessageIter iter;
+
+    message = dbus_message_new_method_call (atspi_bus_registry,
+                                            atspi_path_registry,
+                                            atspi_interface_registry,
+                                            "RegisterEvent");
+    if (!message)
+      return FALSE;
+    dbus_message_iter_init_append (message, &iter);
+    append_registration (&iter, e);
+    reply = _atspi_dbus_send_with_reply_and_block (message, NULL);
+    if (reply)
+      dbus_message_unref (reply);
+  }
+  else if (e->properties)
     dbind_method_call_reentrant (_atspi_bus (), atspi_bus_registry,
 	                         atspi_path_registry,
 	                         atspi_interface_registry,
@@ -576,6 +751,62 @@ notify_event_registered (EventListenerEntry *e)
   return TRUE;
 }
 
+/*
+ * Tells the registry about several listeners with a single RegisterEvents
+ * call.  Registries predating that method get one RegisterEvent each.
+ */
+static gboolean
+notify_events_registered (GList *entries)
+{
+  DBusMessage *message, *reply;
+  DBusMessageIter iter, iter_array, iter_struct;
+  DBusError d_error;
+  gboolean unknown_method;
+  GList *l;
+
+  if (!entries)
+    return TRUE;
+  if (!entries->next)
+    return notify_event_registered (entries->data);
+
+  message = dbus_message_new_method_call (atspi_bus_registry,
+                                          atspi_path_registry,
+                                          atspi_interface_registry,
+                                          "RegisterEvents");
+  if (!message)
+    return FALSE;
+  dbus_message_iter_init_append (message, &iter);
+  dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "(sas(so))",
+                                    &iter_array);
+  for (l = entries; l; l = l->next)
+  {
+    dbus_message_iter_open_container (&iter_array, DBUS_TYPE_STRUCT, NULL,
+                                      &iter_struct);
+    append_registration (&iter_struct, l->data);
+    dbus_message_iter_close_container (&iter_array, &iter_struct);
+  }
+  dbus_message_iter_close_container (&iter, &iter_array);
+
+  dbus_error_init (&d_error);
+  reply = dbind_send_and_allow_reentry (_atspi_bus (), message, &d_error);
+  dbus_message_unref (message);
+  unknown_method = dbus_error_has_name (&d_error, DBUS_ERROR_UNKNOWN_METHOD);
+  if (reply)
+  {
+    unknown_method = (dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR &&
+                      !strcmp (dbus_message_get_error_name (reply),
+                               DBUS_ERROR_UNKNOWN_METHOD));
+    dbus_message_unref (reply);
+  }
+  dbus_error_free (&d_error);
+
+  if (unknown_method)
+    for (l = entries; l; l = l->next)
+      notify_event_registered (l->data);
+
+  return TRUE;
+}
+
 /**
  * atspi_event_listener_register_from_callback:
  * @callback: (scope notified): the #AtspiEventListenerCB to be registered 
@@ -622,31 +853,32 @@ copy_event_properties (GArray *src)
   return dst;
 }
 
-gboolean
-atspi_event_listener_register_from_callback_full (AtspiEventListenerCB callback,
-				                  void *user_data,
-				                  GDestroyNotify callback_destroyed,
-				                  const gchar              *event_type,
-				                  GArray *properties,
-				                  GError **error)
+/* Adds a listener entry and its match rules without telling the
+ * registry about it */
+static EventListenerEntry *
+add_entry (AtspiEventListenerCB callback,
+           void *user_data,
+           GDestroyNotify callback_destroyed,
+           const gchar *event_type,
+           GArray *properties,
+           AtspiAccessible *scope)
 {
   EventListenerEntry *e;
-  DBusError d_error;
   GPtrArray *matchrule_array;
   gint i;
 
   if (!callback)
     {
-      return FALSE;
+      return NULL;
     }
 
   if (!event_type)
   {
     g_warning ("called atspi_event_listener_register_from_callback with a NULL event_type");
-    return FALSE;
+    return NULL;
   }
 
-  e = g_new (EventListenerEntry, 1);
+  e = g_new0 (EventListenerEntry, 1);
   e->event_type = g_strdup (event_type);
   e->callback = callback;
   e->user_data = user_data;
@@ -656,41 +888,424 @@ atspi_event_listener_register_from_callback_full (AtspiEventListenerCB callback,
   if (!convert_event_type_to_dbus (event_type, &e->category, &e->name, &e->detail, &matchrule_array))
   {
     g_free (e);
-    return FALSE;
+    return NULL;
   }
   e->properties = copy_event_properties (properties);
+  if (scope)
+  {
+    e->scope_app = g_strdup (scope->parent.app->bus_name);
+    if (scope != scope->parent.app->root)
+      e->scope_path = g_strdup (scope->parent.path);
+  }
   event_listeners = g_list_prepend (event_listeners, e);
   for (i = 0; i < matchrule_array->len; i++)
   {
-    char *matchrule = g_ptr_array_index (matchrule_array, i);
-    dbus_error_init (&d_error);
-    dbus_bus_add_match (_atspi_bus(), matchrule, &d_error);
-    if (dbus_error_is_set (&d_error))
-      {
-        g_warning ("Atspi: Adding match: %s", d_error.message);
-        dbus_error_free (&d_error);
-        /* TODO: Set error */
-      }
-
+    char *matchrule = scope_match_rule (g_ptr_array_index (matchrule_array, i),
+                                        e->scope_app);
+    /* Without an error to fill in, this does not wait for the reply */
+    dbus_bus_add_match (_atspi_bus(), matchrule, NULL);
     g_free (matchrule);
+    g_free (g_ptr_array_index (matchrule_array, i));
   }
   g_ptr_array_free (matchrule_array, TRUE);
 
+  return e;
+}
+
+static gboolean
+register_entry (AtspiEventListenerCB callback,
+                void *user_data,
+                GDestroyNotify callback_destroyed,
+                const gchar *event_type,
+                GArray *properties,
+                AtspiAccessible *scope,
+                GError **error)
+{
+  EventListenerEntry *e;
+
+  e = add_entry (callback, user_data, callback_destroyed, event_type,
+                 properties, scope);
+  if (!e)
+    return FALSE;
+
   notify_event_registered (e);
+  update_event_cache_mask ();
   return TRUE;
 }
 
-void
-_atspi_reregister_event_listeners ()
+gboolean
+atspi_event_listener_register_from_callback_full (AtspiEventListenerCB callback,
+				                  void *user_data,
+				                  GDestroyNotify callback_destroyed,
+				                  const gchar              *event_type,
+				                  GArray *properties,
+				                  GError **error)
+{
+  return register_entry (callback, user_data, callback_destroyed, event_type,
+                         properties, NULL, error);
+}
+
+/**
+ * atspi_event_listener_register_scoped:
+ * @listener: The #AtspiEventListener to register against an event type.
+ * @event_type: a character string indicating the type of events for which
+ *            notification is requested.  See #atspi_event_listener_register
+ * for a description of the format and legal event types.
+ * @scope: the #AtspiAccessible whose events are wanted.  If it is the
+ *            root of its application, all events from that application
+ *            are delivered; otherwise only events from @scope and its
+ *            descendants are.  Descendants are recognized through the
+ *            cached parents, and events from objects whose ancestry is
+ *            not cached are delivered.
+ * @properties: (element-type gchar*) (transfer none) (allow-none): a list of
+ *             properties that should be sent along with the event.  See
+ *             #atspi_event_listener_register_full.
+ *
+ * Adds an in-process callback function to an existing #AtspiEventListener,
+ * restricted to the events of one application or subtree.  The bus only
+ * delivers events from the application in question.  The scope is also
+ * passed on to the registry, but only as information: applications
+ * still emit every event that is registered for.
+ *
+ * Returns: #TRUE if successful, otherwise #FALSE.
+ **/
+gboolean
+atspi_event_listener_register_scoped (AtspiEventListener *listener,
+                                      const gchar *event_type,
+                                      AtspiAccessible *scope,
+                                      GArray *properties,
+                                      GError **error)
+{
+  g_return_val_if_fail (ATSPI_IS_ACCESSIBLE (scope), FALSE);
+
+  if (!scope->parent.app || !scope->parent.app->bus_name)
+  {
+    g_set_error_literal (error, ATSPI_ERROR, ATSPI_ERROR_APPLICATION_GONE,
+                          _("The application no longer exists"));
+    return FALSE;
+  }
+
+  return register_entry (listener->callback, listener->user_data,
+                         listener->cb_destroyed, event_type, properties,
+                         scope, error);
+}
+
+/**
+ * atspi_event_listener_register_batch:
+ * @listener: The #AtspiEventListener to register against the event types.
+ * @event_types: (array zero-terminated=1): a %NULL-terminated array of
+ *            event types.  See #atspi_event_listener_register for a
+ *            description of the format and legal event types.
+ * @properties: (element-type gchar*) (transfer none) (allow-none): a list of
+ *             properties that should be sent along with the events.  See
+ *             #atspi_event_listener_register_full.
+ *
+ * Adds an in-process callback function to an existing #AtspiEventListener
+ * for several event types at once.  This is equivalent to calling
+ * #atspi_event_listener_register_full for each type, but the registry is
+ * told about all of them in a single call.
+ *
+ * Returns: #TRUE if every event type was registered, otherwise #FALSE.
+ **/
+gboolean
+atspi_event_listener_register_batch (AtspiEventListener *listener,
+                                     const gchar * const *event_types,
+                                     GArray *properties,
+                                     GError **error)
+{
+  GList *entries = NULL;
+  gboolean ret = TRUE;
+  gint i;
+
+  g_return_val_if_fail (event_types != NULL, FALSE);
+
+  for (i = 0; event_types [i]; i++)
+  {
+    EventListenerEntry *e = add_entry (listener->callback,
+                                       listener->user_data,
+                                       listener->cb_destroyed,
+                                       event_types [i], properties, NULL);
+    if (e)
+      entries = g_list_prepend (entries, e);
+    else
+      ret = FALSE;
+  }
+
+  notify_events_registered (entries);
+  g_list_free (entries);
+  update_event_cache_mask ();
+  return ret;
+}
+
+static AtspiEvent *atspi_event_copy (AtspiEvent *src);
+static void atspi_event_free (AtspiEvent *event);
+
+/* One copy of an event, shared by the queues it was posted to */
+typedef struct
+{
+  AtspiEvent *event;
+  gint ref_count;
+} SharedEvent;
+
+/* The queue of a listener that runs in a context of its own */
+struct _DispatchQueue
+{
+  AtspiEventListenerCB callback;
+  void *user_data;
+  GMainContext *context;
+  guint max_queued;
+  AtspiEventOverflowPolicy policy;
+  GMutex lock;        /* guards queue, scheduled and bound */
+  GQueue queue;       /* of SharedEvent */
+  gboolean scheduled;
+  gboolean bound;     /* listed in dispatch_queues, which holds a ref */
+  gint ref_count;
+};
+
+/* The queues of listeners that are bound to a context */
+static GList *dispatch_queues = NULL;
+
+static SharedEvent *
+shared_event_new (AtspiEvent *e)
+{
+  SharedEvent *shared = g_new (SharedEvent, 1);
+
+  shared->event = atspi_event_copy (e);
+  shared->ref_count = 1;
+  return shared;
+}
+
+static gboolean
+shared_event_free (gpointer data)
+{
+  SharedEvent *shared = data;
+
+  atspi_event_free (shared->event);
+  g_free (shared);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+shared_event_unref (SharedEvent *shared)
+{
+  if (!g_atomic_int_dec_and_test (&shared->ref_count))
+    return;
+  /* Releasing the source may dispose of it, which must not happen
+   * outside the main context */
+  g_main_context_invoke (atspi_main_context, shared_event_free, shared);
+}
+
+static void
+dispatch_queue_unref (gpointer data)
+{
+  DispatchQueue *dq = data;
+
+  if (!g_atomic_int_dec_and_test (&dq->ref_count))
+    return;
+  g_queue_foreach (&dq->queue, (GFunc) shared_event_unref, NULL);
+  g_queue_clear (&dq->queue);
+  g_main_context_unref (dq->context);
+  g_mutex_clear (&dq->lock);
+  g_free (dq);
+}
+
+static DispatchQueue *
+find_dispatch_queue (AtspiEventListenerCB callback, void *user_data)
 {
   GList *l;
-  EventListenerEntry *e;
 
-  for (l = event_listeners; l; l = l->next)
+  for (l = dispatch_queues; l; l = l->next)
+  {
+    DispatchQueue *dq = l->data;
+    if (dq->callback == callback && dq->user_data == user_data)
+      return dq;
+  }
+  return NULL;
+}
+
+/* Drops the events waiting in @dq */
+static void
+dispatch_queue_flush (DispatchQueue *dq)
+{
+  GQueue pending;
+
+  g_mutex_lock (&dq->lock);
+  pending = dq->queue;
+  g_queue_init (&dq->queue);
+  g_mutex_unlock (&dq->lock);
+  g_queue_foreach (&pending, (GFunc) shared_event_unref, NULL);
+  g_queue_clear (&pending);
+}
+
+/* Stops delivering events through @dq, dropping those still waiting.
+ * Events for its callback are then delivered directly again. */
+static void
+dispatch_queue_unbind (DispatchQueue *dq)
+{
+  gboolean bound;
+
+  g_mutex_lock (&dq->lock);
+  bound = dq->bound;
+  dq->bound = FALSE;
+  g_mutex_unlock (&dq->lock);
+  if (!bound)
+    return;
+
+  dispatch_queues = g_list_remove (dispatch_queues, dq);
+  dispatch_queue_flush (dq);
+  dispatch_queue_unref (dq);
+}
+
+/* Runs in the listener's context */
+static gboolean
+dispatch_queue_run (gpointer data)
+{
+  DispatchQueue *dq = data;
+  SharedEvent *shared;
+
+  for (;;)
+  {
+    /* Nothing is delivered once the listener is deregistered or gone */
+    g_mutex_lock (&dq->lock);
+    shared = (dq->bound ? g_queue_pop_head (&dq->queue) : NULL);
+    if (!shared)
+      dq->scheduled = FALSE;
+    g_mutex_unlock (&dq->lock);
+    if (!shared)
+      break;
+    dq->callback (atspi_event_copy (shared->event), dq->user_data);
+    shared_event_unref (shared);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+same_event (AtspiEvent *a, AtspiEvent *b)
+{
+  return (a->source == b->source && !strcmp (a->type, b->type));
+}
+
+static void
+dispatch_queue_push (DispatchQueue *dq, SharedEvent *shared)
+{
+  SharedEvent *dropped = NULL;
+
+  g_mutex_lock (&dq->lock);
+  if (dq->max_queued && dq->queue.length >= dq->max_queued)
+  {
+    GList *l = NULL;
+
+    if (dq->policy == ATSPI_EVENT_OVERFLOW_DROP_NEWEST)
+    {
+      g_mutex_unlock (&dq->lock);
+      return;
+    }
+    if (dq->policy == ATSPI_EVENT_OVERFLOW_COALESCE)
+    {
+      for (l = dq->queue.head; l; l = l->next)
+        if (same_event (((SharedEvent *) l->data)->event, shared->event))
+          break;
+    }
+    if (l)
     {
-      e = l->data;
-      notify_event_registered (e);
+      dropped = l->data;
+      g_queue_delete_link (&dq->queue, l);
     }
+    else
+      dropped = g_queue_pop_head (&dq->queue);
+  }
+
+  g_atomic_int_inc (&shared->ref_count);
+  g_queue_push_tail (&dq->queue, shared);
+  if (!dq->scheduled)
+  {
+    GSource *source = g_idle_source_new ();
+
+    dq->scheduled = TRUE;
+    g_atomic_int_inc (&dq->ref_count);
+    g_source_set_callback (source, dispatch_queue_run, dq,
+                           dispatch_queue_unref);
+    g_source_attach (source, dq->context);
+    g_source_unref (source);
+  }
+  g_mutex_unlock (&dq->lock);
+
+  if (dropped)
+    shared_event_unref (dropped);
+}
+
+/**
+ * atspi_event_listener_set_dispatch_context:
+ * @listener: The #AtspiEventListener to bind.
+ * @context: (allow-none): The #GMainContext in which to call the
+ *            listener, or %NULL to call it directly again.
+ * @max_queued: The largest number of events waiting for the listener,
+ *            or 0 for no limit.
+ * @policy: What to do with an event once @max_queued are waiting.
+ *
+ * Has events for @listener queued and delivered from @context rather
+ * than calling it directly, one listener after another, while the event
+ * is handled.  A slow listener then holds up only its own queue.  If
+ * @context is run by a thread of its own, the callback is called from
+ * that thread; libatspi objects are not thread-safe, so such a callback
+ * should only read the event and hand anything else back to the main
+ * context.  Properties requested with the event are not kept valid
+ * until a queued listener runs.  The event may be freed from any thread;
+ * what it refers to is then released on the main context.
+ *
+ * This applies to every event type that @listener is registered for.
+ * Events still waiting are dropped when @listener is deregistered from
+ * an event type, and the binding ends once it is deregistered from the
+ * last one or finalized.  A callback that is already running in another
+ * thread may still be finishing when that returns.
+ **/
+void
+atspi_event_listener_set_dispatch_context (AtspiEventListener *listener,
+                                           GMainContext *context,
+                                           guint max_queued,
+                                           AtspiEventOverflowPolicy policy)
+{
+  AtspiEventListenerPrivate *priv;
+  DispatchQueue *dq;
+
+  g_return_if_fail (ATSPI_IS_EVENT_LISTENER (listener));
+
+  priv = atspi_event_listener_get_instance_private (listener);
+  if (priv->dispatch_queue)
+  {
+    /* Whatever was still waiting is not delivered */
+    dispatch_queue_unbind (priv->dispatch_queue);
+    dispatch_queue_unref (priv->dispatch_queue);
+    priv->dispatch_queue = NULL;
+  }
+
+  /* Events are told apart by callback and data only, so another
+   * listener with the same ones loses its binding */
+  dq = find_dispatch_queue (listener->callback, listener->user_data);
+  if (dq)
+    dispatch_queue_unbind (dq);
+
+  if (!context)
+    return;
+
+  dq = g_new0 (DispatchQueue, 1);
+  dq->callback = listener->callback;
+  dq->user_data = listener->user_data;
+  dq->context = g_main_context_ref (context);
+  dq->max_queued = max_queued;
+  dq->policy = policy;
+  g_mutex_init (&dq->lock);
+  g_queue_init (&dq->queue);
+  dq->bound = TRUE;
+  dq->ref_count = 2;    /* for dispatch_queues and the listener */
+  dispatch_queues = g_list_prepend (dispatch_queues, dq);
+  priv->dispatch_queue = dq;
+}
+
+void
+_atspi_reregister_event_listeners ()
+{
+  notify_events_registered (event_listeners);
 }
 
 /**
@@ -772,6 +1387,7 @@ atspi_event_listener_deregister_from_callback (AtspiEventListenerCB callback,
 {
   char *category, *name, *detail;
   GPtrArray *matchrule_array;
+  gboolean removed = FALSE;
   gint i;
   GList *l;
 
@@ -801,8 +1417,10 @@ atspi_event_listener_deregister_from_callback (AtspiEventListenerCB callback,
         event_listeners = l;
       for (i = 0; i < matchrule_array->len; i++)
       {
-	char *matchrule = g_ptr_array_index (matchrule_array, i);
+	char *matchrule = scope_match_rule (g_ptr_array_index (matchrule_array, i),
+	                                    e->scope_app);
 	dbus_bus_remove_match (_atspi_bus(), matchrule, NULL);
+	g_free (matchrule);
       }
       message = dbus_message_new_method_call (atspi_bus_registry,
 	    atspi_path_registry,
@@ -816,15 +1434,35 @@ atspi_event_listener_deregister_from_callback (AtspiEventListenerCB callback,
         dbus_message_unref (reply);
 
       listener_entry_free (e);
+      removed = TRUE;
     }
     else l = g_list_next (l);
   }
+  if (removed && dispatch_queues)
+  {
+    DispatchQueue *dq = find_dispatch_queue (callback, user_data);
+
+    if (dq)
+    {
+      for (l = event_listeners; l; l = l->next)
+      {
+        EventListenerEntry *e = l->data;
+        if (e->callback == callback && e->user_data == user_data)
+          break;
+      }
+      if (l)
+        dispatch_queue_flush (dq);
+      else
+        dispatch_queue_unbind (dq);
+    }
+  }
   g_free (category);
   g_free (name);
   if (detail) g_free (detail);
   for (i = 0; i < matchrule_array->len; i++)
     g_free (g_ptr_array_index (matchrule_array, i));
   g_ptr_array_free (matchrule_array, TRUE);
+  update_event_cache_mask ();
   return TRUE;
 }
 
@@ -863,13 +1501,61 @@ atspi_event_copy (AtspiEvent *src)
   return dst;
 }
 
-static void
-atspi_event_free (AtspiEvent *event)
+static gboolean
+event_free_cb (gpointer data)
 {
+  AtspiEvent *event = data;
+
   g_object_unref (event->source);
   g_free (event->type);
   g_value_unset (&event->any_data);
   g_free (event);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+atspi_event_free (AtspiEvent *event)
+{
+  GSource *source;
+
+  /* Listeners bound to another context may free the event from their
+   * own thread.  The source, and any accessible held in any_data, must
+   * not be disposed there, as that changes the cache. */
+  if (g_main_context_is_owner (atspi_main_context))
+  {
+    event_free_cb (event);
+    return;
+  }
+  source = g_idle_source_new ();
+  g_source_set_callback (source, event_free_cb, event, NULL);
+  g_source_attach (source, atspi_main_context);
+  g_source_unref (source);
+}
+
+static gboolean
+source_in_scope (AtspiAccessible *source, EventListenerEntry *entry)
+{
+  AtspiAccessible *obj;
+
+  if (!entry->scope_app)
+    return TRUE;
+  if (!source->parent.app ||
+      strcmp (source->parent.app->bus_name, entry->scope_app) != 0)
+    return FALSE;
+  if (!entry->scope_path)
+    return TRUE;
+
+  /* Object paths are not hierarchical, so the bus cannot filter by
+   * subtree; walk up the parents instead.  This runs for every event, so
+   * never fetch a parent: deliver the event if one is not cached */
+  for (obj = source; obj; obj = obj->accessible_parent)
+  {
+    if (!strcmp (obj->parent.path, entry->scope_path))
+      return TRUE;
+    if (!_atspi_accessible_is_cached (obj, ATSPI_CACHE_PARENT))
+      return TRUE;
+  }
+  return FALSE;
 }
 
 static gboolean
@@ -893,6 +1579,7 @@ _atspi_send_event (AtspiEvent *e)
   char *category, *name, *detail;
   GList *l;
   GList *called_listeners = NULL;
+  SharedEvent *shared = NULL;
 
   /* Ensure that the value is set to avoid a Python exception */
   /* TODO: Figure out how to do this without using a private field */
@@ -912,7 +1599,8 @@ _atspi_send_event (AtspiEvent *e)
     EventListenerEntry *entry = l->data;
     if (!strcmp (category, entry->category) &&
         (entry->name == NULL || !strcmp (name, entry->name)) &&
-        detail_matches_listener (detail, entry->detail))
+        detail_matches_listener (detail, entry->detail) &&
+        source_in_scope (e->source, entry))
     {
       GList *l2;
       for (l2 = called_listeners; l2; l2 = l2->next)
@@ -923,60 +1611,76 @@ _atspi_send_event (AtspiEvent *e)
       }
       if (!l2)
       {
-        entry->callback (atspi_event_copy (e), entry->user_data);
+        DispatchQueue *dq = (dispatch_queues ?
+                             find_dispatch_queue (entry->callback,
+                                                  entry->user_data) :
+                             NULL);
+        if (dq)
+        {
+          if (!shared)
+            shared = shared_event_new (e);
+          dispatch_queue_push (dq, shared);
+        }
+        else
+          entry->callback (atspi_event_copy (e), entry->user_data);
         called_listeners = g_list_prepend (called_listeners, entry);
       }
     }
   }
+  if (shared)
+    shared_event_unref (shared);
   if (detail) g_free (detail);
   g_free (name);
   g_free (category);
   g_list_free (called_listeners);
 }
 
-DBusHandlerResult
-_atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data)
+/*
+ * Checks the signature of an event signal and works out its type and
+ * details.  Touches neither the cache nor any object, so it may run on
+ * the I/O thread; see ATSPI_IO_THREAD.
+ */
+AtspiParsedEvent *
+_atspi_dbus_parse_event (DBusMessage *message)
 {
   char *detail = NULL;
   const char *category = dbus_message_get_interface (message);
   const char *member = dbus_message_get_member (message);
   const char *signature = dbus_message_get_signature (message);
+  AtspiParsedEvent *parsed;
   gchar *name;
   gchar *converted_type;
-  DBusMessageIter iter, iter_variant;
-  dbus_message_iter_init (message, &iter);
-  AtspiEvent e;
   dbus_int32_t detail1, detail2;
   char *p;
-  GHashTable *cache = NULL;
 
   if (strcmp (signature, "siiv(so)") != 0 &&
       strcmp (signature, "siiva{sv}") != 0)
   {
     g_warning ("Got invalid signature %s for signal %s from interface %s\n", signature, member, category);
-    return DBUS_HANDLER_RESULT_HANDLED;
+    return NULL;
   }
 
-  memset (&e, 0, sizeof (e));
-
   if (category)
   {
     category = g_utf8_strrchr (category, -1, '.');
     if (category == NULL)
     {
       // TODO: Error
-      return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+      return NULL;
     }
     category++;
   }
-  dbus_message_iter_get_basic (&iter, &detail);
-  dbus_message_iter_next (&iter);
-  dbus_message_iter_get_basic (&iter, &detail1);
-  e.detail1 = detail1;
-  dbus_message_iter_next (&iter);
-  dbus_message_iter_get_basic (&iter, &detail2);
-  e.detail2 = detail2;
-  dbus_message_iter_next (&iter);
+
+  parsed = g_new0 (AtspiParsedEvent, 1);
+  dbus_message_iter_init (message, &parsed->iter);
+  dbus_message_iter_get_basic (&parsed->iter, &detail);
+  dbus_message_iter_next (&parsed->iter);
+  dbus_message_iter_get_basic (&parsed->iter, &detail1);
+  parsed->detail1 = detail1;
+  dbus_message_iter_next (&parsed->iter);
+  dbus_message_iter_get_basic (&parsed->iter, &detail2);
+  parsed->detail2 = detail2;
+  dbus_message_iter_next (&parsed->iter);
 
   converted_type = convert_name_from_dbus (category, FALSE);
   name = convert_name_from_dbus (member, FALSE);
@@ -1001,11 +1705,39 @@ _atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data)
     g_free (converted_type);
     converted_type = p;
   }
-  e.type = converted_type;
+  parsed->type = converted_type;
+
+  g_free (name);
+  g_free (detail);
+  return parsed;
+}
+
+void
+_atspi_parsed_event_free (AtspiParsedEvent *parsed)
+{
+  g_free (parsed->type);
+  g_free (parsed);
+}
+
+/* Runs the cache updates and listeners for an event signal that
+ * _atspi_dbus_parse_event has already been through */
+DBusHandlerResult
+_atspi_dbus_dispatch_event (DBusMessage *message, AtspiParsedEvent *parsed)
+{
+  DBusMessageIter iter = parsed->iter;
+  DBusMessageIter iter_variant;
+  AtspiEvent e;
+  char *p;
+  GHashTable *cache = NULL;
+
+  memset (&e, 0, sizeof (e));
+  e.type = parsed->type;
+  e.detail1 = parsed->detail1;
+  e.detail2 = parsed->detail2;
   e.source = _atspi_ref_accessible (dbus_message_get_sender(message), dbus_message_get_path(message));
   if (e.source == NULL)
   {
-    g_warning ("Got no valid source accessible for signal for signal %s from interface %s\n", member, category);
+    g_warning ("Got no valid source accessible for signal for signal %s from interface %s\n", dbus_message_get_member (message), dbus_message_get_interface (message));
     return DBUS_HANDLER_RESULT_HANDLED;
   }
 
@@ -1038,16 +1770,19 @@ _atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data)
       g_value_set_string (&e.any_data, p);
       break;
     }
+    case DBUS_TYPE_DOUBLE:
+    {
+      double d;
+      dbus_message_iter_get_basic (&iter_variant, &d);
+      g_value_init (&e.any_data, G_TYPE_DOUBLE);
+      g_value_set_double (&e.any_data, d);
+      break;
+    }
   default:
     break;
   }
 
   dbus_message_iter_next (&iter);
-  if (dbus_message_iter_get_arg_type (&iter) == DBUS_TYPE_ARRAY)
-  {
-    /* new form -- parse properties sent with event */
-    cache = _atspi_dbus_update_cache_from_dict (e.source, &iter);
-  }
 
   if (!strncmp (e.type, "object:children-changed", 23))
   {
@@ -1061,23 +1796,55 @@ _atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data)
   {
     cache_process_state_changed (&e);
   }
+  else if (!strcmp (e.type, "object:text-caret-moved"))
+  {
+    cache_process_caret_moved (&e);
+  }
+  else if (!strcmp (e.type, "object:selection-changed"))
+  {
+    /* The event does not carry the new count; refetch it on demand */
+    _atspi_accessible_remove_cache (e.source, ATSPI_CACHE_SELECTION_COUNT);
+  }
+  else if (!strcmp (e.type, "object:bounds-changed"))
+  {
+    cache_process_bounds_changed (&e);
+  }
+  else if (!strcmp (e.type, "window:move") || !strcmp (e.type, "window:resize"))
+  {
+    _atspi_component_invalidate_screen_extents (e.source);
+  }
   else if (!strncmp (e.type, "focus", 5))
   {
     /* BGO#663992 - TODO: figure out the real problem */
-    e.source->cached_properties &= ~(ATSPI_CACHE_STATES);
+    _atspi_accessible_remove_cache (e.source, ATSPI_CACHE_STATES);
   }
 
+  /* Parse properties sent with the event last, since they describe the
+   * object after the change and so take precedence over the above */
+  if (dbus_message_iter_get_arg_type (&iter) == DBUS_TYPE_ARRAY)
+    cache = _atspi_dbus_update_cache_from_dict (e.source, &iter);
+
   _atspi_send_event (&e);
 
   if (cache)
     _atspi_accessible_unref_cache (e.source);
 
-  g_free (converted_type);
-  g_free (name);
-  g_free (detail);
   g_object_unref (e.source);
   g_value_unset (&e.any_data);
   return DBUS_HANDLER_RESULT_HANDLED;
 }
 
+DBusHandlerResult
+_atspi_dbus_handle_event (DBusConnection *bus, DBusMessage *message, void *data)
+{
+  AtspiParsedEvent *parsed = _atspi_dbus_parse_event (message);
+  DBusHandlerResult result;
+
+  if (!parsed)
+    return DBUS_HANDLER_RESULT_HANDLED;
+  result = _atspi_dbus_dispatch_event (message, parsed);
+  _atspi_parsed_event_free (parsed);
+  return result;
+}
+
 G_DEFINE_BOXED_TYPE (AtspiEvent, atspi_event, atspi_event_copy, atspi_event_free)
@@ -113,6 +113,25 @@ atspi_event_listener_register_from_callback_full (AtspiEventListenerCB callback,
                                                   GArray *properties,
 				                  GError **error);
 
+gboolean
+atspi_event_listener_register_scoped (AtspiEventListener *listener,
+                                      const gchar *event_type,
+                                      AtspiAccessible *scope,
+                                      GArray *properties,
+                                      GError **error);
+
+gboolean
+atspi_event_listener_register_batch (AtspiEventListener *listener,
+                                     const gchar * const *event_types,
+                                     GArray *properties,
+                                     GError **error);
+
+void
+atspi_event_listener_set_dispatch_context (AtspiEventListener *listener,
+                                           GMainContext *context,
+                                           guint max_queued,
+                                           AtspiEventOverflowPolicy policy);
+
 gboolean
 atspi_event_listener_register_no_data (AtspiEventListenerSimpleCB callback,
 				 GDestroyNotify callback_destroyed,
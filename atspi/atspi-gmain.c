@@ -29,6 +29,8 @@
 #include "glib.h"
 #include <string.h>
 
+#include "atspi-io-thread-private.h"
+
 #include <libintl.h>
 #define _(x) dgettext (GETTEXT_PACKAGE, x)
 #define N_(x) x
@@ -96,12 +98,18 @@ message_queue_dispatch (GSource     *source,
 typedef struct
 {
   GMainContext *context;      /**< the main context */
+  GMainContext *io_context;   /**< where watches and timeouts run; usually context */
+  AtspiDBusIoFunc io_func;    /**< called on io_context after reading */
   GSList *ios;                /**< all IOHandler */
   GSList *timeouts;           /**< all TimeoutHandler */
   DBusConnection *connection; /**< NULL if this is really for a server not a connection */
   GSource *message_queue_source; /**< DBusGMessageQueue */
 } ConnectionSetup;
 
+/* Guards the watch and timeout lists, which libdbus may change from
+ * whichever thread is using the connection once an I/O context is set */
+static GRecMutex setup_lock;
+
 
 typedef struct
 {
@@ -132,6 +140,7 @@ connection_setup_new (GMainContext   *context,
   
   cs->context = context;
   g_main_context_ref (cs->context);  
+  cs->io_context = g_main_context_ref (context);
 
   if (connection)
     {
@@ -196,10 +205,16 @@ io_handler_dispatch (GIOChannel   *source,
   IOHandler *handler;
   guint dbus_condition = 0;
   DBusConnection *connection;
+  AtspiDBusIoFunc io_func;
+  GMainContext *context;
 
   handler = data;
 
+  g_rec_mutex_lock (&setup_lock);
   connection = handler->cs->connection;
+  io_func = handler->cs->io_func;
+  context = g_main_context_ref (handler->cs->context);
+  g_rec_mutex_unlock (&setup_lock);
   
   if (connection)
     dbus_connection_ref (connection);
@@ -220,6 +235,10 @@ io_handler_dispatch (GIOChannel   *source,
   dbus_watch_handle (handler->watch, dbus_condition);
   handler = NULL;
 
+  if (connection && io_func)
+    io_func (connection, context);
+  g_main_context_unref (context);
+
   if (connection)
     dbus_connection_unref (connection);
   
@@ -258,7 +277,7 @@ connection_setup_add_watch (ConnectionSetup *cs,
   handler->source = g_io_create_watch (channel, condition);
   g_source_set_callback (handler->source, (GSourceFunc) io_handler_dispatch, handler,
                          io_handler_source_finalized);
-  g_source_attach (handler->source, cs->context);
+  g_source_attach (handler->source, cs->io_context);
 
   cs->ios = g_slist_prepend (cs->ios, handler);
   
@@ -350,7 +369,7 @@ connection_setup_add_timeout (ConnectionSetup *cs,
   handler->source = g_timeout_source_new (dbus_timeout_get_interval (timeout));
   g_source_set_callback (handler->source, timeout_handler_dispatch, handler,
                          timeout_handler_source_finalized);
-  g_source_attach (handler->source, handler->cs->context);
+  g_source_attach (handler->source, handler->cs->io_context);
 
   cs->timeouts = g_slist_prepend (cs->timeouts, handler);
 
@@ -391,6 +410,7 @@ connection_setup_free (ConnectionSetup *cs)
       g_source_unref (source);
     }
   
+  g_main_context_unref (cs->io_context);
   g_main_context_unref (cs->context);
   g_free (cs);
 }
@@ -403,7 +423,9 @@ add_watch (DBusWatch *watch,
 
   cs = data;
 
+  g_rec_mutex_lock (&setup_lock);
   connection_setup_add_watch (cs, watch);
+  g_rec_mutex_unlock (&setup_lock);
   
   return TRUE;
 }
@@ -416,7 +438,9 @@ remove_watch (DBusWatch *watch,
 
   cs = data;
 
+  g_rec_mutex_lock (&setup_lock);
   connection_setup_remove_watch (cs, watch);
+  g_rec_mutex_unlock (&setup_lock);
 }
 
 static void
@@ -443,7 +467,9 @@ add_timeout (DBusTimeout *timeout,
   if (!dbus_timeout_get_enabled (timeout))
     return TRUE;
 
+  g_rec_mutex_lock (&setup_lock);
   connection_setup_add_timeout (cs, timeout);
+  g_rec_mutex_unlock (&setup_lock);
 
   return TRUE;
 }
@@ -456,7 +482,9 @@ remove_timeout (DBusTimeout *timeout,
 
   cs = data;
 
+  g_rec_mutex_lock (&setup_lock);
   connection_setup_remove_timeout (cs, timeout);
+  g_rec_mutex_unlock (&setup_lock);
 }
 
 static void
@@ -491,6 +519,14 @@ connection_setup_new_from_old (GMainContext    *context,
   g_assert (old->context != context);
   
   cs = connection_setup_new (context, old->connection);
+
+  /* A separate I/O context stays put; only dispatching moves */
+  if (old->io_context != old->context)
+    {
+      g_main_context_unref (cs->io_context);
+      cs->io_context = g_main_context_ref (old->io_context);
+      cs->io_func = old->io_func;
+    }
   
   while (old->ios != NULL)
     {
@@ -552,11 +588,13 @@ atspi_dbus_connection_setup_with_g_main (DBusConnection *connection,
       if (old_setup->context == context)
         return; /* nothing to do */
 
+      g_rec_mutex_lock (&setup_lock);
       cs = connection_setup_new_from_old (context, old_setup);
       
       /* Nuke the old setup */
       dbus_connection_set_data (connection, _dbus_gmain_connection_slot, NULL, NULL);
       old_setup = NULL;
+      g_rec_mutex_unlock (&setup_lock);
     }
 
   if (cs == NULL)
@@ -590,6 +628,48 @@ atspi_dbus_connection_setup_with_g_main (DBusConnection *connection,
   g_error ("Not enough memory to set up DBusConnection for use with GLib");
 }
 
+/*
+ * Moves the watches and timeouts of a connection that has been set up
+ * with atspi_dbus_connection_setup_with_g_main to @io_context, so that
+ * whoever runs @io_context reads and writes the socket while messages
+ * are still dispatched from the original context.  @func is called on
+ * @io_context after each read.  Passing NULL moves everything back.
+ */
+void
+_atspi_dbus_connection_set_io_context (DBusConnection  *connection,
+                                       GMainContext    *io_context,
+                                       AtspiDBusIoFunc  func)
+{
+  ConnectionSetup *cs;
+  GSList *watches = NULL, *timeouts = NULL, *l;
+
+  cs = dbus_connection_get_data (connection, _dbus_gmain_connection_slot);
+  g_return_if_fail (cs != NULL);
+
+  if (io_context == NULL)
+    io_context = cs->context;
+
+  g_rec_mutex_lock (&setup_lock);
+  g_main_context_unref (cs->io_context);
+  cs->io_context = g_main_context_ref (io_context);
+  cs->io_func = (io_context == cs->context ? NULL : func);
+
+  /* Adding a watch again replaces its old handler, as in
+   * connection_setup_new_from_old */
+  for (l = cs->ios; l; l = l->next)
+    watches = g_slist_prepend (watches, ((IOHandler *) l->data)->watch);
+  for (l = cs->timeouts; l; l = l->next)
+    timeouts = g_slist_prepend (timeouts, ((TimeoutHandler *) l->data)->timeout);
+  for (l = watches; l; l = l->next)
+    connection_setup_add_watch (cs, l->data);
+  for (l = timeouts; l; l = l->next)
+    connection_setup_add_timeout (cs, l->data);
+  g_rec_mutex_unlock (&setup_lock);
+
+  g_slist_free (watches);
+  g_slist_free (timeouts);
+}
+
 /**
  * atspi_dbus_server_setup_with_g_main: (skip)
  * @server: the server
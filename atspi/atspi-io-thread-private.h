@@ -0,0 +1,62 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+
+#ifndef _ATSPI_IO_THREAD_PRIVATE_H_
+#define _ATSPI_IO_THREAD_PRIVATE_H_
+
+#include <glib.h>
+#include <dbus/dbus.h>
+
+G_BEGIN_DECLS
+
+typedef void (*AtspiDBusIoFunc) (DBusConnection *connection,
+                                 GMainContext *context);
+
+void
+_atspi_dbus_connection_set_io_context (DBusConnection *connection,
+                                       GMainContext *io_context,
+                                       AtspiDBusIoFunc func);
+
+/* Called on the I/O thread for each message at the head of the incoming
+ * queue.  Returns what to hand to the main context in its place, or NULL
+ * to leave the message to the connection's filters.  Sets *drop instead
+ * when the message should simply be discarded. */
+typedef gpointer (*AtspiIoTakeFunc) (DBusMessage *message, gboolean *drop);
+
+gboolean
+_atspi_io_thread_start (DBusConnection *bus, AtspiIoTakeFunc take,
+                        GSourceFunc ready);
+
+void
+_atspi_io_thread_stop (void);
+
+gboolean
+_atspi_io_thread_running (void);
+
+gpointer
+_atspi_io_thread_pop (void);
+
+void
+_atspi_io_thread_ready_handled (void);
+
+G_END_DECLS
+
+#endif	/* _ATSPI_IO_THREAD_PRIVATE_H_ */
@@ -0,0 +1,257 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "atspi-private.h"
+#include "atspi-io-thread-private.h"
+
+/*
+ * The optional I/O thread (ATSPI_IO_THREAD).  The accessibility bus's
+ * socket is watched from a GMainContext that a thread of its own runs,
+ * so reading and validating incoming messages no longer happens on the
+ * application's main context.  After each read, the messages that the
+ * main context would only queue for later anyway are taken off the
+ * connection, pre-parsed by the take function and handed over through a
+ * single-producer, single-consumer ring that needs no locks.  Replies
+ * and everything else stay with libdbus and are dispatched from the
+ * main context as before.
+ *
+ * A message is pushed while it is still borrowed, and libdbus dispatches
+ * nothing while a message is borrowed, so whatever the main context's
+ * filter sees afterwards arrived later than everything in the ring.
+ */
+
+/* A power of two.  While the ring is full, messages stay with libdbus
+ * and reach the main context through the filter instead. */
+#define RING_SIZE 1024
+
+/* Positions run modulo 2 * RING_SIZE so that full and empty differ */
+#define RING_WRAP(pos) ((pos) & (2 * RING_SIZE - 1))
+
+static gpointer ring[RING_SIZE];
+static gint ring_head;  /* next item to pop; only the main context moves it */
+static gint ring_tail;  /* next slot to fill; only the I/O thread moves it */
+
+static GThread *io_thread;
+static GMainContext *io_context;
+static GMainLoop *io_loop;
+static DBusConnection *io_bus;
+static AtspiIoTakeFunc take_func;
+static GSourceFunc ready_func;
+static gint ready_pending;
+
+/* Bumped after every read, for callers waiting on a reply */
+static GMutex input_lock;
+static GCond input_cond;
+static guint input_serial;
+
+static gboolean
+ring_full (void)
+{
+  return RING_WRAP (g_atomic_int_get (&ring_tail) -
+                    g_atomic_int_get (&ring_head)) == RING_SIZE;
+}
+
+/* The caller has checked ring_full; nobody else can fill the ring */
+static void
+ring_push (gpointer item)
+{
+  gint tail = g_atomic_int_get (&ring_tail);
+
+  ring[tail & (RING_SIZE - 1)] = item;
+  /* A full barrier, so the slot is written before it is published */
+  g_atomic_int_set (&ring_tail, RING_WRAP (tail + 1));
+}
+
+gpointer
+_atspi_io_thread_pop (void)
+{
+  gint head = g_atomic_int_get (&ring_head);
+  gpointer item;
+
+  if (head == g_atomic_int_get (&ring_tail))
+    return NULL;
+  item = ring[head & (RING_SIZE - 1)];
+  g_atomic_int_set (&ring_head, RING_WRAP (head + 1));
+  return item;
+}
+
+/* Runs on the I/O thread after libdbus has read from the socket */
+static void
+after_read (DBusConnection *bus, GMainContext *context)
+{
+  DBusMessage *message;
+  gboolean pushed = FALSE;
+
+  g_mutex_lock (&input_lock);
+  input_serial++;
+  g_cond_broadcast (&input_cond);
+  g_mutex_unlock (&input_lock);
+
+  while (!ring_full () && (message = dbus_connection_borrow_message (bus)))
+  {
+    gboolean drop = FALSE;
+    gpointer item = take_func (message, &drop);
+
+    if (!item && !drop)
+    {
+      /* Only ever take from the head, to keep the order */
+      dbus_connection_return_message (bus, message);
+      break;
+    }
+    if (item)
+    {
+      ring_push (item);
+      pushed = TRUE;
+    }
+    dbus_connection_steal_borrowed_message (bus, message);
+    dbus_message_unref (message);
+  }
+
+  if (pushed && g_atomic_int_compare_and_exchange (&ready_pending, 0, 1))
+  {
+    GSource *source = g_idle_source_new ();
+    g_source_set_callback (source, ready_func, NULL, NULL);
+    g_source_attach (source, context);
+    g_source_unref (source);
+  }
+
+  /* Anything left is dispatched from the main context as usual */
+  if (dbus_connection_get_dispatch_status (bus) == DBUS_DISPATCH_DATA_REMAINS)
+    g_main_context_wakeup (context);
+}
+
+/* Stands in for dbus_connection_read_write_dispatch in dbind, since the
+ * main context must not poll a socket that the I/O thread reads from */
+static dbus_bool_t
+wait_for_input (DBusConnection *bus, int timeout)
+{
+  gint64 end_time = -1;
+  guint serial;
+
+  if (timeout >= 0)
+    end_time = g_get_monotonic_time () + (gint64) timeout * 1000;
+
+  g_mutex_lock (&input_lock);
+  serial = input_serial;
+  g_mutex_unlock (&input_lock);
+
+  if (dbus_connection_get_dispatch_status (bus) == DBUS_DISPATCH_DATA_REMAINS)
+  {
+    dbus_connection_dispatch (bus);
+    return dbus_connection_get_is_connected (bus);
+  }
+
+  g_mutex_lock (&input_lock);
+  while (input_serial == serial && dbus_connection_get_is_connected (bus))
+  {
+    if (end_time < 0)
+      g_cond_wait (&input_cond, &input_lock);
+    else if (!g_cond_wait_until (&input_cond, &input_lock, end_time))
+      break;
+  }
+  g_mutex_unlock (&input_lock);
+
+  return dbus_connection_get_is_connected (bus);
+}
+
+static gpointer
+io_thread_func (gpointer data)
+{
+  g_main_context_push_thread_default (io_context);
+  g_main_loop_run (io_loop);
+  g_main_context_pop_thread_default (io_context);
+  return NULL;
+}
+
+/*
+ * Starts reading @bus on a thread of its own.  @take is called there
+ * for each message at the head of the incoming queue; @ready is added
+ * as an idle callback to the main context whenever something has been
+ * taken, and must call _atspi_io_thread_ready_handled before popping.
+ * dbus_threads_init_default must have been called before @bus was
+ * opened.
+ */
+gboolean
+_atspi_io_thread_start (DBusConnection *bus, AtspiIoTakeFunc take,
+                        GSourceFunc ready)
+{
+  GError *error = NULL;
+
+  if (io_thread)
+    return TRUE;
+
+  take_func = take;
+  ready_func = ready;
+  io_context = g_main_context_new ();
+  io_loop = g_main_loop_new (io_context, FALSE);
+  io_thread = g_thread_try_new ("atspi-io", io_thread_func, NULL, &error);
+  if (!io_thread)
+  {
+    g_warning ("AT-SPI: Couldn't start the I/O thread: %s", error->message);
+    g_error_free (error);
+    g_main_loop_unref (io_loop);
+    io_loop = NULL;
+    g_main_context_unref (io_context);
+    io_context = NULL;
+    return FALSE;
+  }
+
+  io_bus = dbus_connection_ref (bus);
+  _atspi_dbus_connection_set_io_context (bus, io_context, after_read);
+  dbind_set_wait_function (wait_for_input);
+  return TRUE;
+}
+
+/*
+ * Hands the connection back to the main context and joins the thread.
+ * Items still in the ring are left for the caller to pop.
+ */
+void
+_atspi_io_thread_stop (void)
+{
+  if (!io_thread)
+    return;
+
+  dbind_set_wait_function (NULL);
+  _atspi_dbus_connection_set_io_context (io_bus, NULL, NULL);
+  g_main_loop_quit (io_loop);
+  g_thread_join (io_thread);
+  io_thread = NULL;
+
+  g_main_loop_unref (io_loop);
+  io_loop = NULL;
+  g_main_context_unref (io_context);
+  io_context = NULL;
+  dbus_connection_unref (io_bus);
+  io_bus = NULL;
+  g_atomic_int_set (&ready_pending, 0);
+}
+
+gboolean
+_atspi_io_thread_running (void)
+{
+  return (io_thread != NULL);
+}
+
+void
+_atspi_io_thread_ready_handled (void)
+{
+  g_atomic_int_set (&ready_pending, 0);
+}
@@ -95,6 +95,10 @@ DBusMessage *_atspi_dbus_call_partial (gpointer obj, const char *interface, cons
 
 DBusMessage *_atspi_dbus_call_partial_va (gpointer obj, const char *interface, const char *method, GError **error, const char *type, va_list args);
 
+DBusMessage *_atspi_dbus_new_call (gpointer obj, const char *interface, const char *method, GError **error);
+
+DBusMessage *_atspi_dbus_send_call (gpointer obj, DBusMessage *message, const char *signature, GError **error);
+
 dbus_bool_t _atspi_dbus_get_property (gpointer obj, const char *interface, const char *name, GError **error, const char *type, void *data);
 
 DBusMessage * _atspi_dbus_send_with_reply_and_block (DBusMessage *message, GError **error);
@@ -153,6 +157,7 @@ typedef enum
 } AtspiError;
 
 extern GMainLoop *atspi_main_loop;
+extern GMainContext *atspi_main_context;
 extern gboolean atspi_no_cache;
 
 GHashTable *_atspi_get_live_refs ();
@@ -161,6 +166,8 @@ gchar *_atspi_name_compat (gchar *in);
 
 GHashTable *_atspi_dbus_update_cache_from_dict (AtspiAccessible *accessible, DBusMessageIter *iter);
 
+void _atspi_clear_cached_properties (AtspiCache flags);
+
 gboolean _atspi_get_allow_sync ();
 
 gboolean _atspi_set_allow_sync (gboolean val);
@@ -29,6 +29,7 @@
  */
 
 #include "atspi-private.h"
+#include "atspi-lookup-tables.h"
 #ifdef HAVE_X11
 #include "X11/Xlib.h"
 #endif
@@ -73,38 +74,10 @@ const char *atspi_interface_text = ATSPI_DBUS_INTERFACE_TEXT;
 const char *atspi_interface_cache = ATSPI_DBUS_INTERFACE_CACHE;
 const char *atspi_interface_value = ATSPI_DBUS_INTERFACE_VALUE;
 
-static const char *interfaces[] =
-{
-  ATSPI_DBUS_INTERFACE_ACCESSIBLE,
-  ATSPI_DBUS_INTERFACE_ACTION,
-  ATSPI_DBUS_INTERFACE_APPLICATION,
-  ATSPI_DBUS_INTERFACE_COLLECTION,
-  ATSPI_DBUS_INTERFACE_COMPONENT,
-  ATSPI_DBUS_INTERFACE_DOCUMENT,
-  ATSPI_DBUS_INTERFACE_EDITABLE_TEXT,
-  ATSPI_DBUS_INTERFACE_HYPERLINK,
-  ATSPI_DBUS_INTERFACE_HYPERTEXT,
-  ATSPI_DBUS_INTERFACE_IMAGE,
-  "org.a11y.atspi.LoginHelper",
-  ATSPI_DBUS_INTERFACE_SELECTION,
-  ATSPI_DBUS_INTERFACE_TABLE,
-  ATSPI_DBUS_INTERFACE_TABLE_CELL,
-  ATSPI_DBUS_INTERFACE_TEXT,
-  ATSPI_DBUS_INTERFACE_VALUE,
-  NULL
-};
-
 gint
 _atspi_get_iface_num (const char *iface)
 {
-  /* TODO: Use a binary search or hash to improve performance */
-  int i;
-
-  for (i = 0; interfaces[i]; i++)
-  {
-    if (!strcmp(iface, interfaces[i])) return i;
-  }
-  return -1;
+  return _atspi_lookup_interface (iface);
 }
 
 GHashTable *
@@ -278,7 +251,9 @@ ref_accessible (const char *app_name, const char *path)
     {
       app->root = _atspi_accessible_new (app, atspi_path_root);
       app->root->accessible_parent = atspi_get_desktop (0);
-      g_ptr_array_add (app->root->accessible_parent->children, g_object_ref (app->root));
+      _atspi_accessible_insert_child (app->root->accessible_parent,
+                                      app->root->accessible_parent->children->len,
+                                      app->root);
     }
     return g_object_ref (app->root);
   }
@@ -449,11 +424,8 @@ add_accessible_from_iter (DBusMessageIter *iter)
     /* Get index in parent */
     dbus_message_iter_get_basic (&iter_struct, &index);
     if (index >= 0 && accessible->accessible_parent)
-    {
-      if (index >= accessible->accessible_parent->children->len)
-        g_ptr_array_set_size (accessible->accessible_parent->children, index + 1);
-      g_ptr_array_index (accessible->accessible_parent->children, index) = g_object_ref (accessible);
-    }
+      _atspi_accessible_set_child (accessible->accessible_parent, index,
+                                   accessible);
 
     /* get child count */
     dbus_message_iter_next (&iter_struct);
@@ -474,8 +446,10 @@ add_accessible_from_iter (DBusMessageIter *iter)
       AtspiAccessible *child;
       get_reference_from_iter (&iter_array, &app_name, &path);
       child = ref_accessible (app_name, path);
-      g_ptr_array_remove (accessible->children, child);
-      g_ptr_array_add (accessible->children, child);
+      _atspi_accessible_remove_child (accessible, child);
+      _atspi_accessible_insert_child (accessible, accessible->children->len,
+                                      child);
+      g_object_unref (child);
     }
     children_cached = TRUE;
   }
@@ -715,6 +689,8 @@ typedef struct
   DBusConnection *bus;
   DBusMessage *message;
   void *data;
+  dbus_int64_t queued;  /* for tracing */
+  AtspiParsedEvent *event;  /* when pre-parsed on the I/O thread */
 } BusDataClosure;
 
 static GSource *process_deferred_messages_source = NULL;
@@ -728,7 +704,10 @@ process_deferred_message (BusDataClosure *closure)
   if (type == DBUS_MESSAGE_TYPE_SIGNAL &&
       !strncmp (interface, "org.a11y.atspi.Event.", 21))
   {
-    _atspi_dbus_handle_event (closure->bus, closure->message, closure->data);
+    if (closure->event)
+      _atspi_dbus_dispatch_event (closure->message, closure->event);
+    else
+      _atspi_dbus_handle_event (closure->bus, closure->message, closure->data);
   }
   if (dbus_message_is_method_call (closure->message, atspi_interface_device_event_listener, "NotifyEvent"))
   {
@@ -749,8 +728,29 @@ process_deferred_message (BusDataClosure *closure)
   }
 }
 
+static void
+bus_data_closure_free (BusDataClosure *closure)
+{
+  if (closure->event)
+    _atspi_parsed_event_free (closure->event);
+  dbus_message_unref (closure->message);
+  dbus_connection_unref (closure->bus);
+  g_free (closure);
+}
+
 static GQueue *deferred_messages = NULL;
 
+/* Moves what the I/O thread has taken behind what we deferred ourselves,
+ * which all arrived earlier */
+static void
+collect_io_thread_messages (void)
+{
+  BusDataClosure *closure;
+
+  while ((closure = _atspi_io_thread_pop ()))
+    g_queue_push_tail (deferred_messages, closure);
+}
+
 static gboolean
 process_deferred_messages (void)
 {
@@ -760,17 +760,36 @@ process_deferred_messages (void)
   if (in_process_deferred_messages)
     return TRUE;
   in_process_deferred_messages = 1;
-  while ((closure = g_queue_pop_head (deferred_messages)))
+  for (;;)
   {
+    dbus_int64_t start;
+
+    if (g_queue_is_empty (deferred_messages))
+      collect_io_thread_messages ();
+    closure = g_queue_pop_head (deferred_messages);
+    if (!closure)
+      break;
+    start = (dbind_tracing ? dbind_trace_now () : 0);
+    DBIND_TRACE (DBIND_TRACE_DEFERRED, closure->message, closure->queued);
     process_deferred_message (closure);
-    dbus_message_unref (closure->message);
-    dbus_connection_unref (closure->bus);
-    g_free (closure);
+    DBIND_TRACE (DBIND_TRACE_HANDLED, closure->message, start);
+    bus_data_closure_free (closure);
   }
   in_process_deferred_messages = 0;
   return FALSE;
 }
 
+static gboolean strict_sync = FALSE;
+
+/* Handles what arrived during a blocking call, unless strict sync mode
+ * leaves that to the main loop */
+static void
+process_deferred_messages_after_call (void)
+{
+  if (!strict_sync)
+    process_deferred_messages ();
+}
+
 static gboolean
 process_deferred_messages_callback (gpointer data)
 {
@@ -789,7 +808,10 @@ defer_message (DBusConnection *connection, DBusMessage *message, void *user_data
   closure->bus = dbus_connection_ref (bus);
   closure->message = dbus_message_ref (message);
   closure->data = user_data;
+  closure->queued = (dbind_tracing ? dbind_trace_now () : 0);
+  closure->event = NULL;
 
+  collect_io_thread_messages ();
   g_queue_push_tail (deferred_messages, closure);
 
   if (process_deferred_messages_source == NULL)
@@ -810,6 +832,13 @@ atspi_dbus_filter (DBusConnection *bus, DBusMessage *message, void *data)
   int type = dbus_message_get_type (message);
   const char *interface = dbus_message_get_interface (message);
 
+  if (type == DBUS_MESSAGE_TYPE_SIGNAL || type == DBUS_MESSAGE_TYPE_METHOD_CALL)
+  {
+    DBIND_TRACE (DBIND_TRACE_INCOMING, message, 0);
+    if (dbind_recording)
+      dbind_record_incoming (message);
+  }
+
   if (type == DBUS_MESSAGE_TYPE_SIGNAL &&
       !strncmp (interface, "org.a11y.atspi.Event.", 21))
   {
@@ -835,6 +864,81 @@ atspi_dbus_filter (DBusConnection *bus, DBusMessage *message, void *data)
   return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 }
 
+/* The I/O thread's counterpart to atspi_dbus_filter: takes what the
+ * filter would only defer, so that it can be pre-parsed there */
+static gpointer
+take_message (DBusMessage *message, gboolean *drop)
+{
+  int type = dbus_message_get_type (message);
+  const char *interface = dbus_message_get_interface (message);
+  AtspiParsedEvent *event = NULL;
+  BusDataClosure *closure;
+
+  if (type == DBUS_MESSAGE_TYPE_SIGNAL && interface &&
+      !strncmp (interface, "org.a11y.atspi.Event.", 21))
+  {
+    event = _atspi_dbus_parse_event (message);
+    if (!event)
+    {
+      *drop = TRUE;
+      return NULL;
+    }
+  }
+  else if (!dbus_message_is_method_call (message, atspi_interface_device_event_listener, "NotifyEvent") &&
+           !dbus_message_is_signal (message, atspi_interface_cache, "AddAccessible") &&
+           !dbus_message_is_signal (message, atspi_interface_cache, "RemoveAccessible"))
+    return NULL;
+
+  closure = g_new (BusDataClosure, 1);
+  closure->bus = dbus_connection_ref (bus);
+  closure->message = dbus_message_ref (message);
+  closure->data = NULL;
+  closure->queued = 0;
+  closure->event = event;
+  return closure;
+}
+
+static gboolean
+io_thread_ready_callback (gpointer data)
+{
+  _atspi_io_thread_ready_handled ();
+  process_deferred_messages ();
+  return G_SOURCE_REMOVE;
+}
+
+static GSource *replay_source = NULL;
+
+/* Feeds the next recorded message to the filter, as if it had just
+ * arrived; see ATSPI_REPLAY */
+static gboolean
+replay_next_message (gpointer data)
+{
+  DBusMessage *message = dbind_replay_next_incoming ();
+
+  if (!message)
+  {
+    replay_source = NULL;
+    if (atspi_main_loop)
+      atspi_event_quit ();
+    return G_SOURCE_REMOVE;
+  }
+
+  atspi_dbus_filter (bus, message, NULL);
+  dbus_message_unref (message);
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+start_replay (const char *filename)
+{
+  if (!dbind_replay_open (filename))
+    return;
+  replay_source = g_idle_source_new ();
+  g_source_set_callback (replay_source, replay_next_message, NULL, NULL);
+  g_source_attach (replay_source, atspi_main_context);
+  g_source_unref (replay_source);
+}
+
 /*
  * Returns a 'canonicalized' value for DISPLAY,
  * with the screen number stripped off if present.
@@ -872,6 +976,20 @@ spi_display_name (void)
   return canonical_display_name;
 }
 
+/* Whether identical concurrent instances of a call may share one reply */
+static dbus_bool_t
+is_read_only_call (DBusMessage *message)
+{
+  const char *interface = dbus_message_get_interface (message);
+  const char *member = dbus_message_get_member (message);
+
+  if (!interface || !member)
+    return FALSE;
+  if (!strcmp (interface, DBUS_INTERFACE_PROPERTIES))
+    return (!strcmp (member, "Get") || !strcmp (member, "GetAll"));
+  return !strncmp (member, "Get", 3);
+}
+
 /**
  * atspi_init:
  *
@@ -884,6 +1002,7 @@ atspi_init (void)
 {
   char *match;
   const gchar *no_cache;
+  const gchar *trace, *record, *replay, *io_thread;
 
   if (atspi_inited)
     {
@@ -894,6 +1013,30 @@ atspi_init (void)
 
   _atspi_get_live_refs();
 
+  trace = g_getenv ("ATSPI_TRACE");
+  if (trace && trace[0])
+    dbind_trace_open (trace);
+
+  /* Replies must come from the recording before anything is asked */
+  replay = g_getenv ("ATSPI_REPLAY");
+  if (replay && replay[0])
+    start_replay (replay);
+  else
+  {
+    record = g_getenv ("ATSPI_RECORD");
+    if (record && record[0])
+      dbind_record_open (record);
+  }
+
+  /* Tracing and recording see every message on the main context, so
+   * they rule out the I/O thread */
+  io_thread = g_getenv ("ATSPI_IO_THREAD");
+  if (io_thread && g_strcmp0 (io_thread, "0") != 0 &&
+      !dbind_tracing && !dbind_recording && !replay_source)
+    dbus_threads_init_default ();
+  else
+    io_thread = NULL;
+
   bus = atspi_get_a11y_bus ();
   if (!bus)
     return 2;
@@ -926,6 +1069,13 @@ atspi_init (void)
 
   deferred_messages = g_queue_new ();
 
+  dbind_set_share_predicate (is_read_only_call);
+
+  if (io_thread)
+    _atspi_io_thread_start (bus, take_message, io_thread_ready_callback);
+
+  _atspi_statistics_init ();
+
   return 0;
 }
 
@@ -1000,7 +1150,24 @@ atspi_exit (void)
       leaked = 0;
     }
 
+  _atspi_statistics_shutdown ();
+  if (_atspi_io_thread_running ())
+  {
+    BusDataClosure *closure;
+
+    _atspi_io_thread_stop ();
+    while ((closure = _atspi_io_thread_pop ()))
+      bus_data_closure_free (closure);
+  }
+  if (replay_source)
+  {
+    g_source_destroy (replay_source);
+    replay_source = NULL;
+  }
   cleanup ();
+  dbind_trace_close ();
+  dbind_record_close ();
+  dbind_replay_close ();
 
   return leaked;
 }
@@ -1098,6 +1265,7 @@ _atspi_dbus_call (gpointer obj, const char *interface, const char *method, GErro
   dbus_bool_t retval;
   DBusError err;
   AtspiObject *aobj = ATSPI_OBJECT (obj);
+  gint64 start;
 
   if (!check_app (aobj->app, error))
     return FALSE;
@@ -1111,12 +1279,15 @@ _atspi_dbus_call (gpointer obj, const char *interface, const char *method, GErro
   va_start (args, type);
   dbus_error_init (&err);
   set_timeout (aobj->app);
+  start = g_get_monotonic_time ();
   retval = dbind_method_call_reentrant_va (aobj->app->bus, aobj->app->bus_name,
                                            aobj->path, interface, method, &err,
                                            type, args);
+  _atspi_statistics_ipc (interface, method, g_get_monotonic_time () - start,
+                         !retval);
   va_end (args);
   check_for_hang (NULL, &err, aobj->app->bus, aobj->app->bus_name);
-  process_deferred_messages ();
+  process_deferred_messages_after_call ();
   if (dbus_error_is_set (&err))
   {
     g_set_error(error, ATSPI_ERROR, ATSPI_ERROR_IPC, "%s", err.message);
@@ -1152,6 +1323,7 @@ _atspi_dbus_call_partial_va (gpointer obj,
     DBusMessage *msg = NULL, *reply = NULL;
     DBusMessageIter iter;
     const char *p;
+  gint64 start;
 
   dbus_error_init (&err);
 
@@ -1167,13 +1339,16 @@ _atspi_dbus_call_partial_va (gpointer obj,
   dbind_any_marshal_va (&iter, &p, args);
 
   set_timeout (aobj->app);
+  start = g_get_monotonic_time ();
   reply = dbind_send_and_allow_reentry (aobj->app->bus, msg, &err);
+  _atspi_statistics_ipc (interface, method, g_get_monotonic_time () - start,
+                         !reply || dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR);
   check_for_hang (reply, &err, aobj->app->bus, aobj->app->bus_name);
 out:
   va_end (args);
   if (msg)
     dbus_message_unref (msg);
-  process_deferred_messages ();
+  process_deferred_messages_after_call ();
   if (dbus_error_is_set (&err))
   {
     /* TODO: Set gerror */
@@ -1193,6 +1368,83 @@ out:
   return reply;
 }
 
+/*
+ * Creates a method call on @obj for the generated stubs in atspi-stubs.c,
+ * or returns NULL, setting @error, if the call cannot be made.
+ */
+DBusMessage *
+_atspi_dbus_new_call (gpointer obj, const char *interface, const char *method, GError **error)
+{
+  AtspiObject *aobj = ATSPI_OBJECT (obj);
+
+  if (!check_app (aobj->app, error))
+    return NULL;
+
+  if (!allow_sync)
+  {
+    _atspi_set_error_no_sync (error);
+    return NULL;
+  }
+
+  return dbus_message_new_method_call (aobj->app->bus_name, aobj->path,
+                                       interface, method);
+}
+
+/*
+ * Sends @message, taking ownership of it, and returns the reply if it
+ * has the given signature.  Otherwise returns NULL and sets @error.
+ */
+DBusMessage *
+_atspi_dbus_send_call (gpointer obj, DBusMessage *message, const char *signature, GError **error)
+{
+  AtspiObject *aobj = ATSPI_OBJECT (obj);
+  DBusMessage *reply;
+  DBusError err;
+  gint64 start;
+
+  dbus_error_init (&err);
+  set_timeout (aobj->app);
+  start = g_get_monotonic_time ();
+  reply = dbind_send_and_allow_reentry (aobj->app->bus, message, &err);
+  _atspi_statistics_ipc (dbus_message_get_interface (message),
+                         dbus_message_get_member (message),
+                         g_get_monotonic_time () - start,
+                         !reply || dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR);
+  check_for_hang (reply, &err, aobj->app->bus, aobj->app->bus_name);
+  dbus_message_unref (message);
+  process_deferred_messages_after_call ();
+
+  if (!reply)
+  {
+    g_set_error_literal (error, ATSPI_ERROR, ATSPI_ERROR_IPC,
+                         dbus_error_is_set (&err) ? err.message : "No reply");
+    dbus_error_free (&err);
+    return NULL;
+  }
+
+  if (dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR)
+  {
+    dbus_set_error_from_message (&err, reply);
+    g_set_error_literal (error, ATSPI_ERROR, ATSPI_ERROR_IPC, err.message);
+    dbus_error_free (&err);
+    dbus_message_unref (reply);
+    return NULL;
+  }
+
+  if (strcmp (dbus_message_get_signature (reply), signature) != 0)
+  {
+    g_warning ("at-spi: Expected message signature %s but got %s",
+               signature, dbus_message_get_signature (reply));
+    g_set_error (error, ATSPI_ERROR, ATSPI_ERROR_IPC,
+                 "Unexpected reply signature %s",
+                 dbus_message_get_signature (reply));
+    dbus_message_unref (reply);
+    return NULL;
+  }
+
+  return reply;
+}
+
 dbus_bool_t
 _atspi_dbus_get_property (gpointer obj, const char *interface, const char *name, GError **error, const char *type, void *data)
 {
@@ -1202,6 +1454,7 @@ _atspi_dbus_get_property (gpointer obj, const char *interface, const char *name,
   dbus_bool_t retval = FALSE;
   AtspiObject *aobj = ATSPI_OBJECT (obj);
   char expected_type = (type [0] == '(' ? 'r' : type [0]);
+  gint64 start;
 
   if (!aobj)
     return FALSE;
@@ -1227,10 +1480,14 @@ _atspi_dbus_get_property (gpointer obj, const char *interface, const char *name,
   dbus_message_append_args (message, DBUS_TYPE_STRING, &interface, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
   dbus_error_init (&err);
   set_timeout (aobj->app);
+  start = g_get_monotonic_time ();
   reply = dbind_send_and_allow_reentry (aobj->app->bus, message, &err);
+  /* Recorded under the property name, which is more useful than "Get" */
+  _atspi_statistics_ipc (interface, name, g_get_monotonic_time () - start,
+                         !reply || dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR);
   check_for_hang (reply, &err, aobj->app->bus, aobj->app->bus_name);
   dbus_message_unref (message);
-  process_deferred_messages ();
+  process_deferred_messages_after_call ();
   if (!reply)
   {
     // TODO: throw exception
@@ -1283,6 +1540,7 @@ _atspi_dbus_send_with_reply_and_block (DBusMessage *message, GError **error)
   DBusError err;
   AtspiApplication *app;
   DBusConnection *bus;
+  gint64 start;
 
   app = get_application (dbus_message_get_destination (message));
 
@@ -1292,8 +1550,13 @@ _atspi_dbus_send_with_reply_and_block (DBusMessage *message, GError **error)
   bus = (app ? app->bus : _atspi_bus());
   dbus_error_init (&err);
   set_timeout (app);
+  start = g_get_monotonic_time ();
   reply = dbind_send_and_allow_reentry (bus, message, &err);
-  process_deferred_messages ();
+  _atspi_statistics_ipc (dbus_message_get_interface (message),
+                         dbus_message_get_member (message),
+                         g_get_monotonic_time () - start,
+                         !reply || dbus_message_get_type (reply) == DBUS_MESSAGE_TYPE_ERROR);
+  process_deferred_messages_after_call ();
   dbus_message_unref (message);
   if (dbus_error_is_set (&err))
   {
@@ -1419,12 +1682,14 @@ _atspi_dbus_set_interfaces (AtspiAccessible *accessible, DBusMessageIter *iter)
 void
 _atspi_dbus_set_state (AtspiAccessible *accessible, DBusMessageIter *iter)
 {
-  DBusMessageIter iter_array;
+  /* Peek through a copy; callers move past the array themselves */
+  DBusMessageIter iter_copy = *iter;
   gint count;
-  dbus_uint32_t *states;
+  const dbus_uint32_t *states;
 
-  dbus_message_iter_recurse (iter, &iter_array);
-  dbus_message_iter_get_fixed_array (&iter_array, &states, &count);
+  if (!dbind_any_peek_fixed_array (&iter_copy, DBUS_TYPE_UINT32,
+                                   (const void **) &states, &count))
+    count = 0;
   if (count != 2)
   {
     g_warning ("AT-SPI: expected 2 values in states array; got %d\n", count);
@@ -1574,8 +1839,11 @@ atspi_get_a11y_bus (void)
     if (!dbus_connection_allocate_data_slot (&a11y_dbus_slot))
       g_warning ("at-spi: Unable to allocate D-Bus slot");
 
+  /* Lets tests and benchmarks point everything at a private bus */
+  address = g_strdup (g_getenv ("AT_SPI_BUS_ADDRESS"));
 #ifdef HAVE_X11
-  address = get_accessibility_bus_address_x11 ();
+  if (!address)
+    address = get_accessibility_bus_address_x11 ();
 #endif
   if (!address)
     address = get_accessibility_bus_address_dbus ();
@@ -1641,6 +1909,27 @@ atspi_set_timeout (gint val, gint startup_time)
   app_startup_time = startup_time;
 }
 
+/**
+ * atspi_set_strict_sync:
+ * @strict: %TRUE to keep event handling out of method calls.
+ *
+ * By default, a method call that blocks for its reply then handles the
+ * events, device events and cache updates that arrived while it waited,
+ * before returning.  Listeners can therefore run on the caller's stack.
+ *
+ * In strict sync mode these messages are left queued, and are handled
+ * the next time the main loop runs, so a method call costs a single
+ * round trip and runs no callbacks.  Calls answered by the calling
+ * process itself still dispatch while waiting, since they could not be
+ * answered otherwise.
+ */
+void
+atspi_set_strict_sync (gboolean strict)
+{
+  strict_sync = strict;
+  dbind_set_strict_sync (strict);
+}
+
 /**
  * atspi_set_main_context:
  * @cnx: The #GMainContext to use.
@@ -1711,26 +2000,7 @@ _atspi_name_compat (gchar *name)
 gchar *
 atspi_role_get_name (AtspiRole role)
 {
-  gchar *retval = NULL;
-  GTypeClass *type_class;
-  GEnumValue *value;
-
-  type_class = g_type_class_ref (ATSPI_TYPE_ROLE);
-  g_return_val_if_fail (G_IS_ENUM_CLASS (type_class), NULL);
-
-  value = g_enum_get_value (G_ENUM_CLASS (type_class), role);
-
-  if (value)
-    {
-      retval = g_strdup (value->value_nick);
-    }
-
-  g_type_class_unref (type_class);
-
-  if (retval)
-    return _atspi_name_compat (retval);
-
-  return NULL;
+  return g_strdup (_atspi_lookup_role_name (role));
 }
 
 GHashTable *
@@ -1748,10 +2018,67 @@ _atspi_dbus_update_cache_from_dict (AtspiAccessible *accessible, DBusMessageIter
     dbus_message_iter_get_basic (&iter_dict_entry, &key);
     dbus_message_iter_next (&iter_dict_entry);
     dbus_message_iter_recurse (&iter_dict_entry, &iter_variant);
+    int type = dbus_message_iter_get_arg_type (&iter_variant);
     if (!strcmp (key, "interfaces"))
     {
       _atspi_dbus_set_interfaces (accessible, &iter_variant);
     }
+    else if (!strcmp (key, "Name") && type == DBUS_TYPE_STRING)
+    {
+      const char *str;
+      dbus_message_iter_get_basic (&iter_variant, &str);
+      g_free (accessible->name);
+      accessible->name = g_strdup (str);
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_NAME);
+    }
+    else if (!strcmp (key, "Description") && type == DBUS_TYPE_STRING)
+    {
+      const char *str;
+      dbus_message_iter_get_basic (&iter_variant, &str);
+      g_free (accessible->description);
+      accessible->description = g_strdup (str);
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_DESCRIPTION);
+    }
+    else if (!strcmp (key, "Role") && type == DBUS_TYPE_UINT32)
+    {
+      dbus_uint32_t role;
+      dbus_message_iter_get_basic (&iter_variant, &role);
+      accessible->role = role;
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_ROLE);
+    }
+    else if (!strcmp (key, "States") && type == DBUS_TYPE_ARRAY &&
+             dbus_message_iter_get_element_type (&iter_variant) == DBUS_TYPE_UINT32)
+    {
+      _atspi_dbus_set_state (accessible, &iter_variant);
+    }
+    else if (!strcmp (key, "Parent") && type == DBUS_TYPE_STRUCT)
+    {
+      if (accessible->accessible_parent)
+        g_object_unref (accessible->accessible_parent);
+      accessible->accessible_parent = _atspi_dbus_return_accessible_from_iter (&iter_variant);
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_PARENT);
+    }
+    else if (!strcmp (key, "ChildCount") && type == DBUS_TYPE_INT32)
+    {
+      dbus_int32_t count;
+      dbus_message_iter_get_basic (&iter_variant, &count);
+      accessible->priv->child_count = count;
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_CHILD_COUNT);
+    }
+    else if (!strcmp (key, "Text.CaretOffset") && type == DBUS_TYPE_INT32)
+    {
+      dbus_int32_t offset;
+      dbus_message_iter_get_basic (&iter_variant, &offset);
+      accessible->priv->caret_offset = offset;
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_CARET_OFFSET);
+    }
+    else if (!strcmp (key, "Value.CurrentValue") && type == DBUS_TYPE_DOUBLE)
+    {
+      double d;
+      dbus_message_iter_get_basic (&iter_variant, &d);
+      accessible->priv->current_value = d;
+      _atspi_accessible_add_cache (accessible, ATSPI_CACHE_CURRENT_VALUE);
+    }
     else if (!strcmp (key, "Attributes"))
     {
       char *iter_sig = dbus_message_iter_get_signature (&iter_variant);
@@ -1791,6 +2118,7 @@ _atspi_dbus_update_cache_from_dict (AtspiAccessible *accessible, DBusMessageIter
       dbus_message_iter_get_basic (&iter_struct, &d_int);
       extents.height = d_int;
       g_value_set_boxed (val, &extents);
+      _atspi_component_set_screen_extents (accessible, &extents);
     }
     if (val)
       g_hash_table_insert (cache, g_strdup (key), val); 
@@ -1800,6 +2128,33 @@ _atspi_dbus_update_cache_from_dict (AtspiAccessible *accessible, DBusMessageIter
   return cache;
 }
 
+static void
+clear_cached_properties_in_app (gpointer key, gpointer value, gpointer data)
+{
+  AtspiApplication *app = value;
+  AtspiCache flags = GPOINTER_TO_UINT (data);
+  GHashTableIter iter;
+  gpointer obj;
+
+  if (!app->hash)
+    return;
+  g_hash_table_iter_init (&iter, app->hash);
+  while (g_hash_table_iter_next (&iter, NULL, &obj))
+    if (ATSPI_IS_ACCESSIBLE (obj))
+      _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), flags);
+  if (app->root)
+    _atspi_accessible_remove_cache (app->root, flags);
+}
+
+/* Drops the given cache flags from every accessible we know of */
+void
+_atspi_clear_cached_properties (AtspiCache flags)
+{
+  if (app_hash)
+    g_hash_table_foreach (app_hash, clear_cached_properties_in_app,
+                          GUINT_TO_POINTER (flags));
+}
+
 gboolean
 _atspi_get_allow_sync ()
 {
@@ -43,10 +43,15 @@ atspi_get_a11y_bus ();
 void
 atspi_set_timeout (gint val, gint startup_time);
 
+void
+atspi_set_strict_sync (gboolean strict);
+
 void
 atspi_set_main_context (GMainContext *cnx);
 
 gchar * atspi_role_get_name (AtspiRole role);
+
+GVariant * atspi_get_statistics (void);
 G_END_DECLS
 
 #endif	/* _ATSPI_MISC_H_ */
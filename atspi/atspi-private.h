@@ -28,13 +28,16 @@
 #include <config.h>
 #include "atspi-device-listener-private.h"
 #include "atspi-event-listener-private.h"
+#include "atspi-io-thread-private.h"
 #include "atspi-matchrule-private.h"
 #include "atspi-misc-private.h"
+#include "atspi-statistics-private.h"
 
 #include "glib/gi18n.h"
 
 #include "atspi.h"
 #include "atspi-accessible-private.h"
+#include "atspi-stubs.h"
 
 G_BEGIN_DECLS
 void _atspi_reregister_device_listeners ();
@@ -38,11 +38,19 @@
 gint
 atspi_selection_get_n_selected_children (AtspiSelection *obj, GError **error)
 {
+  AtspiAccessible *accessible = ATSPI_ACCESSIBLE (obj);
   dbus_int32_t retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_get_property (obj, atspi_interface_selection, "NSelectedChildren", error, "i", &retval);
+  if (_atspi_accessible_test_cache (accessible, ATSPI_CACHE_SELECTION_COUNT))
+    return accessible->priv->n_selected_children;
+
+  if (_atspi_dbus_get_property (obj, atspi_interface_selection, "NSelectedChildren", error, "i", &retval))
+  {
+    accessible->priv->n_selected_children = retval;
+    _atspi_accessible_add_cache (accessible, ATSPI_CACHE_SELECTION_COUNT);
+  }
 
   return retval;
 }
@@ -106,6 +114,7 @@ atspi_selection_select_child (AtspiSelection *obj,
   g_return_val_if_fail (obj != NULL, FALSE);
 
   _atspi_dbus_call (obj, atspi_interface_selection, "SelectChild", error, "i=>b", d_child_index, &retval);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_SELECTION_COUNT);
 
   return retval;
 }
@@ -135,6 +144,7 @@ atspi_selection_deselect_selected_child (AtspiSelection *obj,
   g_return_val_if_fail (obj != NULL, FALSE);
 
   _atspi_dbus_call (obj, atspi_interface_selection, "DeselectSelectedChild", error, "i=>b", d_selected_child_index, &retval);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_SELECTION_COUNT);
 
   return retval;
 }
@@ -164,6 +174,7 @@ atspi_selection_deselect_child (AtspiSelection *obj,
   g_return_val_if_fail (obj != NULL, FALSE);
 
   _atspi_dbus_call (obj, atspi_interface_selection, "DeselectChild", error, "i=>b", d_child_index, &retval);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_SELECTION_COUNT);
 
   return retval;
 }
@@ -213,6 +224,7 @@ atspi_selection_select_all (AtspiSelection *obj, GError **error)
   g_return_val_if_fail (obj != NULL, FALSE);
 
   _atspi_dbus_call (obj, atspi_interface_selection, "SelectAll", error, "=>b", &retval);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_SELECTION_COUNT);
 
   return retval;
 }
@@ -235,6 +247,7 @@ atspi_selection_clear_selection (AtspiSelection *obj, GError **error)
   g_return_val_if_fail (obj != NULL, FALSE);
 
   _atspi_dbus_call (obj, atspi_interface_selection, "ClearSelection", error, "=>b", &retval);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_SELECTION_COUNT);
 
   return retval;
 }
@@ -0,0 +1,703 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "atspi-private.h"
+
+/*
+ * Immutable snapshots of a subtree.
+ *
+ * The nodes built by one call to atspi_accessible_snapshot () are laid
+ * out in pre-order in one array (a segment), with their strings in one
+ * string chunk and their children listed by index in a second array.  A
+ * later snapshot of the same root reuses any subtree of the previous one
+ * that was taken entirely from the cache and has not changed since:
+ * instead of copying it, its child link points into the older segment,
+ * which is kept alive for as long as it is referred to.
+ *
+ * To know when a subtree has changed, every change to the cache stamps
+ * a new serial on the changed accessible and on all of its ancestors.
+ */
+
+#define SNAPSHOT_PROPERTIES (ATSPI_CACHE_NAME | ATSPI_CACHE_DESCRIPTION | \
+                             ATSPI_CACHE_ROLE | ATSPI_CACHE_STATES)
+
+typedef struct _SnapshotSegment SnapshotSegment;
+
+/* A child link; segment is NULL for nodes in the same segment */
+typedef struct
+{
+  SnapshotSegment *segment;
+  guint index;
+} SnapshotLink;
+
+struct _AtspiSnapshotNode
+{
+  SnapshotSegment *segment;
+  AtspiAccessible *accessible;
+  const gchar *name;
+  const gchar *description;
+  AtspiRole role;
+  guint64 states;
+  guint first_link;
+  guint n_children;
+  guint subtree_size;
+
+  /* For deciding whether a later snapshot can reuse the subtree */
+  gint depth;
+  guint serial;
+  gboolean complete;
+};
+
+/* Segments are only ever referenced and released on the main context */
+struct _SnapshotSegment
+{
+  gint ref_count;
+  AtspiSnapshotNode *nodes;
+  guint n_nodes;
+  SnapshotLink *links;
+  GStringChunk *strings;
+  GPtrArray *shared;         /* segments that our links point into */
+  gsize retained;            /* nodes kept alive, counting shared ones */
+};
+
+struct _AtspiSnapshot
+{
+  gint ref_count;
+  GThread *owner;
+  SnapshotSegment *segment;
+  AtspiCache mask;
+  guint generation;
+};
+
+typedef struct
+{
+  GArray *nodes;
+  GArray *links;
+  GStringChunk *strings;
+  GHashTable *shared;
+  GHashTable *path;
+  AtspiCache mask;
+  AtspiSnapshot *previous;
+} SnapshotBuilder;
+
+static guint change_serial = 0;
+
+/* Snapshots being built or not yet freed; changes need no stamping
+ * while there are none, as nothing can be reused then */
+static guint n_snapshots = 0;
+
+G_DEFINE_BOXED_TYPE (AtspiSnapshot, atspi_snapshot, atspi_snapshot_ref,
+                     atspi_snapshot_unref)
+
+/*
+ * Stamps @accessible and its ancestors as changed.  Called whenever the
+ * cache of @accessible changes.
+ */
+void
+_atspi_snapshot_note_change (AtspiAccessible *accessible)
+{
+  guint serial;
+
+  if (n_snapshots == 0)
+    return;
+
+  serial = ++change_serial;
+  /* Follow the children arrays the snapshots were built from; stopping
+   * at stamped objects also stops at cycles */
+  while (accessible && accessible->priv->subtree_serial != serial)
+  {
+    accessible->priv->subtree_serial = serial;
+    if (accessible->priv->children_owner)
+      accessible = accessible->priv->children_owner;
+    else
+      accessible = accessible->accessible_parent;
+  }
+}
+
+static void
+segment_unref (SnapshotSegment *segment)
+{
+  guint i;
+
+  if (--segment->ref_count > 0)
+    return;
+
+  for (i = 0; i < segment->n_nodes; i++)
+    g_object_unref (segment->nodes[i].accessible);
+  g_free (segment->nodes);
+  g_free (segment->links);
+  g_string_chunk_free (segment->strings);
+  g_ptr_array_unref (segment->shared);
+  g_free (segment);
+}
+
+static const AtspiSnapshotNode *
+builder_node (SnapshotBuilder *b, const SnapshotLink *link)
+{
+  if (link->segment)
+    return &link->segment->nodes[link->index];
+  return &g_array_index (b->nodes, AtspiSnapshotNode, link->index);
+}
+
+static const gchar *
+intern (SnapshotBuilder *b, const gchar *string)
+{
+  return g_string_chunk_insert_const (b->strings, string ? string : "");
+}
+
+static gboolean
+can_reuse (SnapshotBuilder *b, AtspiAccessible *accessible,
+           const AtspiSnapshotNode *old, gint depth)
+{
+  return (b->previous && old->accessible == accessible && old->complete &&
+          old->depth == depth &&
+          old->serial == accessible->priv->subtree_serial);
+}
+
+static const AtspiSnapshotNode *
+find_old_child (const AtspiSnapshotNode *old, AtspiAccessible *child,
+                gint child_index)
+{
+  guint i, first;
+
+  if (!old || child_index < 0)
+    return NULL;
+
+  /* Children usually keep their place or move by one */
+  first = (child_index > 0 ? child_index - 1 : 0);
+  for (i = first; i <= (guint) child_index + 1 && i < old->n_children; i++)
+  {
+    const AtspiSnapshotNode *candidate;
+
+    candidate = atspi_snapshot_node_get_child (old, i);
+    if (candidate->accessible == child)
+      return candidate;
+  }
+  return NULL;
+}
+
+/*
+ * Appends the subtree of @accessible to the builder, or links to @old if
+ * that still describes it.  Errors are only reported for the root, which
+ * is the only node passed a non-NULL @error.
+ */
+static gboolean
+build_node (SnapshotBuilder *b, AtspiAccessible *accessible,
+            const AtspiSnapshotNode *old, gint depth, SnapshotLink *link,
+            GError **error)
+{
+  AtspiSnapshotNode node = { 0 };
+  GError *tmp = NULL;
+  AtspiCache needed;
+  guint index;
+
+  if (old && can_reuse (b, accessible, old, depth))
+  {
+    link->segment = old->segment;
+    link->index = old - old->segment->nodes;
+    g_hash_table_add (b->shared, old->segment);
+    return TRUE;
+  }
+
+  needed = b->mask & SNAPSHOT_PROPERTIES;
+  if (depth != 0)
+    needed |= ATSPI_CACHE_CHILDREN;
+
+  /* Taken first: anything fetched below stamps a newer serial */
+  node.serial = accessible->priv->subtree_serial;
+  node.complete = _atspi_accessible_is_cached (accessible, needed);
+  node.depth = depth;
+  node.subtree_size = 1;
+
+  if (b->mask & ATSPI_CACHE_NAME)
+    node.name = intern (b, atspi_accessible_peek_name (accessible, &tmp));
+  if (!tmp && (b->mask & ATSPI_CACHE_DESCRIPTION))
+  {
+    gchar *description = atspi_accessible_get_description (accessible, &tmp);
+    node.description = intern (b, description);
+    g_free (description);
+  }
+  if (!tmp && (b->mask & ATSPI_CACHE_ROLE))
+    node.role = atspi_accessible_get_role (accessible, &tmp);
+  if (!tmp && (b->mask & ATSPI_CACHE_STATES))
+    node.states = atspi_accessible_peek_states_mask (accessible);
+  if (tmp)
+  {
+    if (error)
+    {
+      g_propagate_error (error, tmp);
+      return FALSE;
+    }
+    g_clear_error (&tmp);
+    node.complete = FALSE;
+  }
+
+  node.accessible = g_object_ref (accessible);
+  index = b->nodes->len;
+  g_array_set_size (b->nodes, index + 1);
+
+  if (depth != 0)
+  {
+    GArray *children = g_array_new (FALSE, FALSE, sizeof (SnapshotLink));
+    gint child_depth = (depth > 0 ? depth - 1 : depth);
+    gint count = atspi_accessible_get_child_count (accessible, NULL);
+    gint i;
+
+    g_hash_table_add (b->path, accessible);
+    for (i = 0; i < count; i++)
+    {
+      AtspiAccessible *child;
+      SnapshotLink child_link;
+      const AtspiSnapshotNode *built;
+
+      child = atspi_accessible_peek_child_at_index (accessible, i, NULL);
+      if (!child)
+      {
+        node.complete = FALSE;
+        continue;
+      }
+      if (g_hash_table_contains (b->path, child))
+        continue;
+
+      /* Fetching may process events that drop the child from our array */
+      g_object_ref (child);
+      build_node (b, child, find_old_child (old, child, i), child_depth,
+                  &child_link, NULL);
+      g_object_unref (child);
+      built = builder_node (b, &child_link);
+      node.subtree_size += built->subtree_size;
+      node.complete = node.complete && built->complete;
+      g_array_append_val (children, child_link);
+    }
+    g_hash_table_remove (b->path, accessible);
+
+    node.first_link = b->links->len;
+    node.n_children = children->len;
+    g_array_append_vals (b->links, children->data, children->len);
+    g_array_free (children, TRUE);
+  }
+
+  g_array_index (b->nodes, AtspiSnapshotNode, index) = node;
+  link->segment = NULL;
+  link->index = index;
+  return TRUE;
+}
+
+/* Copies @src and everything below it into the builder */
+static guint
+copy_node (SnapshotBuilder *b, const AtspiSnapshotNode *src)
+{
+  AtspiSnapshotNode node = *src;
+  GArray *children;
+  guint index;
+  guint i;
+
+  node.accessible = g_object_ref (src->accessible);
+  if (src->name)
+    node.name = intern (b, src->name);
+  if (src->description)
+    node.description = intern (b, src->description);
+  index = b->nodes->len;
+  g_array_set_size (b->nodes, index + 1);
+
+  children = g_array_sized_new (FALSE, FALSE, sizeof (SnapshotLink),
+                                src->n_children);
+  for (i = 0; i < src->n_children; i++)
+  {
+    SnapshotLink link;
+
+    link.segment = NULL;
+    link.index = copy_node (b, atspi_snapshot_node_get_child (src, i));
+    g_array_append_val (children, link);
+  }
+  node.first_link = b->links->len;
+  g_array_append_vals (b->links, children->data, children->len);
+  g_array_free (children, TRUE);
+
+  g_array_index (b->nodes, AtspiSnapshotNode, index) = node;
+  return index;
+}
+
+static void
+builder_init (SnapshotBuilder *b, AtspiCache mask, AtspiSnapshot *previous)
+{
+  b->nodes = g_array_new (FALSE, TRUE, sizeof (AtspiSnapshotNode));
+  b->links = g_array_new (FALSE, FALSE, sizeof (SnapshotLink));
+  b->strings = g_string_chunk_new (1024);
+  b->shared = g_hash_table_new (g_direct_hash, g_direct_equal);
+  b->path = g_hash_table_new (g_direct_hash, g_direct_equal);
+  b->mask = mask;
+  b->previous = previous;
+}
+
+/* Turns what was built into a segment, or frees it if @keep is FALSE */
+static SnapshotSegment *
+builder_finish (SnapshotBuilder *b, gboolean keep)
+{
+  SnapshotSegment *segment;
+  GHashTableIter iter;
+  gpointer key;
+  guint i;
+
+  g_hash_table_destroy (b->path);
+  if (!keep)
+  {
+    for (i = 0; i < b->nodes->len; i++)
+      g_object_unref (g_array_index (b->nodes, AtspiSnapshotNode,
+                                     i).accessible);
+    g_array_free (b->nodes, TRUE);
+    g_array_free (b->links, TRUE);
+    g_string_chunk_free (b->strings);
+    g_hash_table_destroy (b->shared);
+    return NULL;
+  }
+
+  segment = g_new0 (SnapshotSegment, 1);
+  segment->ref_count = 1;
+  segment->n_nodes = b->nodes->len;
+  segment->nodes = (AtspiSnapshotNode *) g_array_free (b->nodes, FALSE);
+  segment->links = (SnapshotLink *) g_array_free (b->links, FALSE);
+  segment->strings = b->strings;
+  segment->retained = segment->n_nodes;
+  segment->shared =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) segment_unref);
+
+  g_hash_table_iter_init (&iter, b->shared);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+  {
+    SnapshotSegment *shared = key;
+    shared->ref_count++;
+    segment->retained += shared->retained;
+    g_ptr_array_add (segment->shared, shared);
+  }
+  g_hash_table_destroy (b->shared);
+
+  for (i = 0; i < segment->n_nodes; i++)
+    segment->nodes[i].segment = segment;
+  return segment;
+}
+
+static gboolean
+snapshot_free (gpointer data)
+{
+  AtspiSnapshot *snapshot = data;
+  AtspiAccessible *root = snapshot->segment->nodes[0].accessible;
+
+  if (root->priv->snapshot == snapshot)
+    root->priv->snapshot = NULL;
+  segment_unref (snapshot->segment);
+  g_free (snapshot);
+  n_snapshots--;
+  return G_SOURCE_REMOVE;
+}
+
+/* Adds a reference to the last snapshot of @root, unless it is being
+ * freed */
+static AtspiSnapshot *
+ref_previous (AtspiAccessible *root)
+{
+  AtspiSnapshot *snapshot = root->priv->snapshot;
+  gint count;
+
+  if (!snapshot)
+    return NULL;
+
+  do
+  {
+    count = g_atomic_int_get (&snapshot->ref_count);
+    if (count == 0)
+      return NULL;
+  }
+  while (!g_atomic_int_compare_and_exchange (&snapshot->ref_count, count,
+                                             count + 1));
+  return snapshot;
+}
+
+/**
+ * atspi_accessible_snapshot:
+ * @root: the #AtspiAccessible at the top of the snapshot.
+ * @depth: how many levels of descendants to include, or -1 for all.
+ * @mask: the #AtspiCache flags of the properties to record for each
+ *        node; only %ATSPI_CACHE_NAME, %ATSPI_CACHE_DESCRIPTION,
+ *        %ATSPI_CACHE_ROLE and %ATSPI_CACHE_STATES are used.
+ *
+ * Records the subtree below @root as it is now, for walking it while the
+ * tree itself keeps changing.  Properties and children are taken from
+ * the cache where possible and fetched otherwise.  The snapshot never
+ * changes afterwards and may be read, and released, from any thread,
+ * but it must be taken on the main context.
+ *
+ * If a previous snapshot of @root with the same @mask is still alive,
+ * subtrees of it that were fully cached and have not changed since are
+ * shared with the new snapshot rather than recorded again; if nothing
+ * at all has changed, the previous snapshot itself is returned.
+ *
+ * Returns: (transfer full): the snapshot, or NULL if the properties of
+ * @root could not be fetched.  Failures below @root leave the affected
+ * properties empty.
+ **/
+AtspiSnapshot *
+atspi_accessible_snapshot (AtspiAccessible *root, gint depth, AtspiCache mask,
+                           GError **error)
+{
+  AtspiSnapshot *previous, *snapshot;
+  const AtspiSnapshotNode *old = NULL;
+  SnapshotBuilder b;
+  SnapshotSegment *segment;
+  SnapshotLink link;
+  guint generation;
+
+  g_return_val_if_fail (ATSPI_IS_ACCESSIBLE (root), NULL);
+
+  mask &= SNAPSHOT_PROPERTIES;
+  generation = _atspi_accessible_get_cache_generation ();
+  previous = ref_previous (root);
+  if (previous &&
+      (previous->mask != mask || previous->generation != generation))
+  {
+    atspi_snapshot_unref (previous);
+    previous = NULL;
+  }
+
+  builder_init (&b, mask, previous);
+  if (previous)
+  {
+    old = previous->segment->nodes;
+    if (can_reuse (&b, root, old, depth))
+    {
+      builder_finish (&b, FALSE);
+      return previous;
+    }
+  }
+
+  /* Counted from here, so that changes seen while fetching are stamped */
+  n_snapshots++;
+  if (!build_node (&b, root, old, depth, &link, error))
+  {
+    n_snapshots--;
+    builder_finish (&b, FALSE);
+    if (previous)
+      atspi_snapshot_unref (previous);
+    return NULL;
+  }
+  segment = builder_finish (&b, TRUE);
+
+  /* Sharing keeps whole older segments alive; copy everything into one
+   * once they hold more stale nodes than live ones */
+  if (segment->retained > 2 * segment->nodes[0].subtree_size)
+  {
+    builder_init (&b, mask, NULL);
+    copy_node (&b, segment->nodes);
+    segment_unref (segment);
+    segment = builder_finish (&b, TRUE);
+  }
+
+  snapshot = g_new0 (AtspiSnapshot, 1);
+  snapshot->ref_count = 1;
+  snapshot->owner = g_thread_self ();
+  snapshot->segment = segment;
+  snapshot->mask = mask;
+  snapshot->generation = generation;
+  root->priv->snapshot = snapshot;
+
+  if (previous)
+    atspi_snapshot_unref (previous);
+  return snapshot;
+}
+
+/**
+ * atspi_snapshot_ref:
+ * @snapshot: an #AtspiSnapshot.
+ *
+ * Returns: (transfer full): @snapshot, with a reference added.
+ **/
+AtspiSnapshot *
+atspi_snapshot_ref (AtspiSnapshot *snapshot)
+{
+  g_atomic_int_inc (&snapshot->ref_count);
+  return snapshot;
+}
+
+/**
+ * atspi_snapshot_unref:
+ * @snapshot: an #AtspiSnapshot.
+ *
+ * Drops a reference to @snapshot.  The last one may be dropped on any
+ * thread; the accessibles it refers to are then released on the main
+ * context.
+ **/
+void
+atspi_snapshot_unref (AtspiSnapshot *snapshot)
+{
+  GSource *source;
+
+  if (!g_atomic_int_dec_and_test (&snapshot->ref_count))
+    return;
+
+  if (g_thread_self () == snapshot->owner)
+  {
+    snapshot_free (snapshot);
+    return;
+  }
+  source = g_idle_source_new ();
+  g_source_set_callback (source, snapshot_free, snapshot, NULL);
+  g_source_attach (source, atspi_main_context);
+  g_source_unref (source);
+}
+
+/**
+ * atspi_snapshot_get_root:
+ * @snapshot: an #AtspiSnapshot.
+ *
+ * Returns: (transfer none): the node for the root of @snapshot.  Nodes
+ * live as long as the snapshot.
+ **/
+const AtspiSnapshotNode *
+atspi_snapshot_get_root (AtspiSnapshot *snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, NULL);
+
+  return snapshot->segment->nodes;
+}
+
+/**
+ * atspi_snapshot_get_n_nodes:
+ * @snapshot: an #AtspiSnapshot.
+ *
+ * Returns: the number of nodes in @snapshot, including the root.
+ **/
+guint
+atspi_snapshot_get_n_nodes (AtspiSnapshot *snapshot)
+{
+  g_return_val_if_fail (snapshot != NULL, 0);
+
+  return snapshot->segment->nodes[0].subtree_size;
+}
+
+/**
+ * atspi_snapshot_node_get_accessible:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: (transfer none): the #AtspiAccessible that @node was recorded
+ * from.  Only use it on the main context.
+ **/
+AtspiAccessible *
+atspi_snapshot_node_get_accessible (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, NULL);
+
+  return node->accessible;
+}
+
+/**
+ * atspi_snapshot_node_get_name:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: (transfer none) (nullable): the name of @node, or NULL if
+ * names were not recorded.
+ **/
+const gchar *
+atspi_snapshot_node_get_name (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, NULL);
+
+  return node->name;
+}
+
+/**
+ * atspi_snapshot_node_get_description:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: (transfer none) (nullable): the description of @node, or
+ * NULL if descriptions were not recorded.
+ **/
+const gchar *
+atspi_snapshot_node_get_description (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, NULL);
+
+  return node->description;
+}
+
+/**
+ * atspi_snapshot_node_get_role:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: the role of @node, or %ATSPI_ROLE_INVALID if roles were not
+ * recorded.
+ **/
+AtspiRole
+atspi_snapshot_node_get_role (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, ATSPI_ROLE_INVALID);
+
+  return node->role;
+}
+
+/**
+ * atspi_snapshot_node_get_states:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: the states of @node as a bit mask indexed by #AtspiStateType,
+ * or 0 if states were not recorded.
+ **/
+guint64
+atspi_snapshot_node_get_states (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, 0);
+
+  return node->states;
+}
+
+/**
+ * atspi_snapshot_node_get_child_count:
+ * @node: an #AtspiSnapshotNode.
+ *
+ * Returns: the number of children recorded for @node.
+ **/
+gint
+atspi_snapshot_node_get_child_count (const AtspiSnapshotNode *node)
+{
+  g_return_val_if_fail (node != NULL, 0);
+
+  return node->n_children;
+}
+
+/**
+ * atspi_snapshot_node_get_child:
+ * @node: an #AtspiSnapshotNode.
+ * @child_index: the index of the child, counting from 0.
+ *
+ * Returns: (transfer none) (nullable): the child of @node at
+ * @child_index, or NULL if there is none.
+ **/
+const AtspiSnapshotNode *
+atspi_snapshot_node_get_child (const AtspiSnapshotNode *node,
+                               gint child_index)
+{
+  const SnapshotLink *link;
+
+  g_return_val_if_fail (node != NULL, NULL);
+
+  if (child_index < 0 || child_index >= node->n_children)
+    return NULL;
+  link = &node->segment->links[node->first_link + child_index];
+  return &(link->segment ? link->segment : node->segment)->nodes[link->index];
+}
@@ -0,0 +1,79 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ATSPI_SNAPSHOT_H_
+#define _ATSPI_SNAPSHOT_H_
+
+#include "glib-object.h"
+
+#include "atspi-constants.h"
+
+#include "atspi-types.h"
+
+G_BEGIN_DECLS
+
+typedef struct _AtspiSnapshot AtspiSnapshot;
+typedef struct _AtspiSnapshotNode AtspiSnapshotNode;
+
+#define ATSPI_TYPE_SNAPSHOT (atspi_snapshot_get_type ())
+
+GType atspi_snapshot_get_type (void);
+
+AtspiSnapshot *
+atspi_accessible_snapshot (AtspiAccessible *root, gint depth, AtspiCache mask,
+                           GError **error);
+
+AtspiSnapshot *
+atspi_snapshot_ref (AtspiSnapshot *snapshot);
+
+void
+atspi_snapshot_unref (AtspiSnapshot *snapshot);
+
+const AtspiSnapshotNode *
+atspi_snapshot_get_root (AtspiSnapshot *snapshot);
+
+guint
+atspi_snapshot_get_n_nodes (AtspiSnapshot *snapshot);
+
+AtspiAccessible *
+atspi_snapshot_node_get_accessible (const AtspiSnapshotNode *node);
+
+const gchar *
+atspi_snapshot_node_get_name (const AtspiSnapshotNode *node);
+
+const gchar *
+atspi_snapshot_node_get_description (const AtspiSnapshotNode *node);
+
+AtspiRole
+atspi_snapshot_node_get_role (const AtspiSnapshotNode *node);
+
+guint64
+atspi_snapshot_node_get_states (const AtspiSnapshotNode *node);
+
+gint
+atspi_snapshot_node_get_child_count (const AtspiSnapshotNode *node);
+
+const AtspiSnapshotNode *
+atspi_snapshot_node_get_child (const AtspiSnapshotNode *node,
+                               gint child_index);
+
+G_END_DECLS
+
+#endif	/* _ATSPI_SNAPSHOT_H_ */
@@ -23,6 +23,7 @@
  */
 
 #include "atspi-private.h"
+#include "atspi-lookup-tables.h"
 
 static void atspi_state_set_class_init (AtspiStateSetClass *klass);
 
@@ -87,28 +88,23 @@ _atspi_state_set_new_internal (AtspiAccessible *accessible, gint64 states)
 void
 atspi_state_set_set_by_name (AtspiStateSet *set, const gchar *name, gboolean enabled)
 {
-  GTypeClass *type_class;
-  GEnumValue *value;
+  gint value;
 
   if (set->accessible &&
-      !(set->accessible->cached_properties & ATSPI_CACHE_STATES))
+      !(_atspi_accessible_get_cached_properties (set->accessible) & ATSPI_CACHE_STATES))
     return;
 
-  type_class = g_type_class_ref (ATSPI_TYPE_STATE_TYPE);
+  value = _atspi_lookup_state (name);
 
-  value = g_enum_get_value_by_nick (G_ENUM_CLASS (type_class), name);
-
-  if (!value)
+  if (value < 0)
   {
     g_warning ("AT-SPI: Attempt to set unknown state '%s'", name);
   }
   else
     if (enabled)
-      set->states |= ((gint64)1 << value->value);
+      set->states |= ((gint64)1 << value);
     else
-      set->states &= ~((gint64)1 << value->value);
-
-  g_type_class_unref (type_class);
+      set->states &= ~((gint64)1 << value);
 }
 
 static void
@@ -118,16 +114,18 @@ refresh_states (AtspiStateSet *set)
   dbus_uint32_t *states;
 
   if (!set->accessible ||
-      (set->accessible->cached_properties & ATSPI_CACHE_STATES))
+      (_atspi_accessible_get_cached_properties (set->accessible) & ATSPI_CACHE_STATES))
     return;
 
-  if (!_atspi_dbus_call (set->accessible, atspi_interface_accessible, "GetState", NULL, "=>au", &state_array))
+  if (!_atspi_call_accessible_get_state (set->accessible, &state_array, NULL))
     return;
 
-  states = (dbus_uint32_t *) state_array->data;
-
-  set->states = ((gint64)states [1]) << 32;
-  set->states |= (gint64) states [0];
+  if (state_array->len == 2)
+  {
+    states = (dbus_uint32_t *) state_array->data;
+    set->states = ((gint64)states [1]) << 32;
+    set->states |= (gint64) states [0];
+  }
   g_array_free (state_array, TRUE);
 }
 
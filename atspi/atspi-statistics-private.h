@@ -0,0 +1,53 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef _ATSPI_STATISTICS_PRIVATE_H_
+#define _ATSPI_STATISTICS_PRIVATE_H_
+
+#include "glib-object.h"
+
+#include "atspi-accessible.h"
+
+G_BEGIN_DECLS
+
+void
+_atspi_statistics_init (void);
+
+void
+_atspi_statistics_shutdown (void);
+
+void
+_atspi_statistics_cache_lookup (AtspiAccessible *accessible, AtspiCache flag,
+                                gboolean hit);
+
+void
+_atspi_statistics_cache_invalidated (AtspiAccessible *accessible,
+                                     AtspiCache flags);
+
+void
+_atspi_statistics_forget_application (AtspiApplication *app);
+
+void
+_atspi_statistics_ipc (const char *interface, const char *method,
+                       gint64 usec, gboolean failed);
+
+G_END_DECLS
+
+#endif	/* _ATSPI_STATISTICS_PRIVATE_H_ */
@@ -0,0 +1,379 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+
+#include "atspi-private.h"
+#include "atspi-statistics-private.h"
+
+/* Enough for every flag up to ATSPI_CACHE_ALL */
+#define N_CACHE_FLAGS 30
+
+/* Bucket i counts calls taking from 2^(i-1) up to 2^i microseconds;
+ * the last one also takes everything slower */
+#define N_LATENCY_BUCKETS 24
+
+typedef struct
+{
+  guint64 hits;
+  guint64 misses;
+  guint64 invalidations;
+} CacheCounters;
+
+typedef struct
+{
+  CacheCounters flags[N_CACHE_FLAGS];
+} AppStatistics;
+
+typedef struct
+{
+  guint64 calls;
+  guint64 errors;
+  guint64 total_usec;
+  guint64 max_usec;
+  guint64 histogram[N_LATENCY_BUCKETS];
+} IpcStatistics;
+
+/* AtspiApplication -> AppStatistics */
+static GHashTable *app_statistics;
+
+/* interface -> (method -> IpcStatistics) */
+static GHashTable *ipc_statistics;
+
+static guint dump_source_id;
+
+static CacheCounters *
+get_cache_counters (AtspiAccessible *accessible, AtspiCache flag)
+{
+  AtspiApplication *app = accessible->parent.app;
+  AppStatistics *stats;
+  gint bit = g_bit_nth_lsf (flag, -1);
+
+  if (!app || bit < 0 || bit >= N_CACHE_FLAGS)
+    return NULL;
+
+  if (!app_statistics)
+    app_statistics = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, g_free);
+
+  stats = g_hash_table_lookup (app_statistics, app);
+  if (!stats)
+  {
+    stats = g_new0 (AppStatistics, 1);
+    g_hash_table_insert (app_statistics, app, stats);
+  }
+  return &stats->flags[bit];
+}
+
+void
+_atspi_statistics_cache_lookup (AtspiAccessible *accessible, AtspiCache flag,
+                                gboolean hit)
+{
+  CacheCounters *counters = get_cache_counters (accessible, flag);
+
+  if (!counters)
+    return;
+  if (hit)
+    counters->hits++;
+  else
+    counters->misses++;
+}
+
+void
+_atspi_statistics_cache_invalidated (AtspiAccessible *accessible,
+                                     AtspiCache flags)
+{
+  gint bit = -1;
+
+  while ((bit = g_bit_nth_lsf (flags, bit)) >= 0)
+  {
+    CacheCounters *counters = get_cache_counters (accessible, 1 << bit);
+    if (counters)
+      counters->invalidations++;
+  }
+}
+
+void
+_atspi_statistics_forget_application (AtspiApplication *app)
+{
+  if (app_statistics)
+    g_hash_table_remove (app_statistics, app);
+}
+
+void
+_atspi_statistics_ipc (const char *interface, const char *method,
+                       gint64 usec, gboolean failed)
+{
+  GHashTable *methods;
+  IpcStatistics *stats;
+
+  if (!interface || !method)
+    return;
+
+  if (!ipc_statistics)
+    ipc_statistics = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify) g_hash_table_unref);
+
+  methods = g_hash_table_lookup (ipc_statistics, interface);
+  if (!methods)
+  {
+    methods = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+    g_hash_table_insert (ipc_statistics, g_strdup (interface), methods);
+  }
+
+  stats = g_hash_table_lookup (methods, method);
+  if (!stats)
+  {
+    stats = g_new0 (IpcStatistics, 1);
+    g_hash_table_insert (methods, g_strdup (method), stats);
+  }
+
+  if (usec < 0)
+    usec = 0;
+  stats->calls++;
+  if (failed)
+    stats->errors++;
+  stats->total_usec += usec;
+  stats->max_usec = MAX (stats->max_usec, usec);
+  stats->histogram[MIN (g_bit_storage (usec), N_LATENCY_BUCKETS - 1)]++;
+}
+
+static guint64
+estimate_bytes (AtspiAccessible *accessible)
+{
+  guint64 bytes = sizeof (AtspiAccessible) + sizeof (AtspiAccessiblePrivate);
+
+  if (accessible->parent.path)
+    bytes += strlen (accessible->parent.path) + 1;
+  if (accessible->name)
+    bytes += strlen (accessible->name) + 1;
+  if (accessible->description)
+    bytes += strlen (accessible->description) + 1;
+  if (accessible->children)
+    bytes += accessible->children->len * sizeof (gpointer);
+  if (accessible->attributes)
+    bytes += g_hash_table_size (accessible->attributes) * 4 * sizeof (gpointer);
+  if (accessible->states)
+    bytes += sizeof (AtspiStateSet);
+  return bytes;
+}
+
+static GVariant *
+build_app_statistics (AtspiApplication *app, AppStatistics *stats)
+{
+  GVariantBuilder builder, cache;
+  GFlagsClass *flags_class;
+  guint64 bytes = 0;
+  guint objects = 0;
+  gint i;
+
+  if (app->hash)
+  {
+    GHashTableIter iter;
+    gpointer value;
+
+    objects = g_hash_table_size (app->hash);
+    g_hash_table_iter_init (&iter, app->hash);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+      bytes += estimate_bytes (value);
+  }
+
+  g_variant_builder_init (&cache, G_VARIANT_TYPE ("a{s(ttt)}"));
+  flags_class = g_type_class_ref (ATSPI_TYPE_CACHE);
+  for (i = 0; i < N_CACHE_FLAGS; i++)
+  {
+    CacheCounters *c = &stats->flags[i];
+    GFlagsValue *value;
+
+    if (!c->hits && !c->misses && !c->invalidations)
+      continue;
+    value = g_flags_get_first_value (flags_class, 1 << i);
+    if (!value)
+      continue;
+    g_variant_builder_add (&cache, "{s(ttt)}", value->value_nick,
+                           c->hits, c->misses, c->invalidations);
+  }
+  g_type_class_unref (flags_class);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&builder, "{sv}", "objects",
+                         g_variant_new_uint32 (objects));
+  g_variant_builder_add (&builder, "{sv}", "bytes",
+                         g_variant_new_uint64 (bytes));
+  g_variant_builder_add (&builder, "{sv}", "cache",
+                         g_variant_builder_end (&cache));
+  return g_variant_builder_end (&builder);
+}
+
+static GVariant *
+build_ipc_statistics (IpcStatistics *stats)
+{
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&builder, "{sv}", "calls",
+                         g_variant_new_uint64 (stats->calls));
+  g_variant_builder_add (&builder, "{sv}", "errors",
+                         g_variant_new_uint64 (stats->errors));
+  g_variant_builder_add (&builder, "{sv}", "total-usec",
+                         g_variant_new_uint64 (stats->total_usec));
+  g_variant_builder_add (&builder, "{sv}", "max-usec",
+                         g_variant_new_uint64 (stats->max_usec));
+  g_variant_builder_add (&builder, "{sv}", "histogram",
+                         g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+                                                    stats->histogram,
+                                                    N_LATENCY_BUCKETS,
+                                                    sizeof (guint64)));
+  return g_variant_builder_end (&builder);
+}
+
+/**
+ * atspi_get_statistics:
+ *
+ * Gets counters describing how well the cache is working and how much
+ * time is spent waiting on other processes, to help choose a cache mask
+ * (see atspi_accessible_set_cache_mask).
+ *
+ * The result is a dictionary (type a{sv}) with these keys:
+ *
+ * "applications": a dictionary keyed by the bus name of each application
+ * whose cache has been used.  Each value is a
+ * dictionary holding "objects", the number of objects alive (u),
+ * "bytes", a rough estimate of the memory they use (t), and "cache",
+ * mapping each #AtspiCache flag nick to its hit, miss and invalidation
+ * counts (a{s(ttt)}).
+ *
+ * "ipc": a dictionary keyed by "interface.method" (or
+ * "interface.property" for property fetches).  Each value is a
+ * dictionary holding "calls", "errors", "total-usec", "max-usec" (all t)
+ * and "histogram" (at), whose element i counts the calls that took less
+ * than 2^i microseconds but not less than 2^(i-1).
+ *
+ * If the ATSPI_STATISTICS environment variable is set to a number of
+ * seconds, these statistics are also printed to stderr at that interval
+ * and on atspi_exit.
+ *
+ * Returns: (transfer full): a #GVariant holding the statistics.
+ */
+GVariant *
+atspi_get_statistics (void)
+{
+  GVariantBuilder builder, apps, ipc;
+  GHashTableIter iter, method_iter;
+  gpointer key, value, method, stats;
+
+  g_variant_builder_init (&apps, G_VARIANT_TYPE_VARDICT);
+  if (app_statistics)
+  {
+    g_hash_table_iter_init (&iter, app_statistics);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      AtspiApplication *app = key;
+      g_variant_builder_add (&apps, "{sv}", app->bus_name,
+                             build_app_statistics (app, value));
+    }
+  }
+
+  g_variant_builder_init (&ipc, G_VARIANT_TYPE_VARDICT);
+  if (ipc_statistics)
+  {
+    g_hash_table_iter_init (&iter, ipc_statistics);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      g_hash_table_iter_init (&method_iter, value);
+      while (g_hash_table_iter_next (&method_iter, &method, &stats))
+      {
+        gchar *name = g_strconcat (key, ".", method, NULL);
+        g_variant_builder_add (&ipc, "{sv}", name,
+                               build_ipc_statistics (stats));
+        g_free (name);
+      }
+    }
+  }
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+  g_variant_builder_add (&builder, "{sv}", "applications",
+                         g_variant_builder_end (&apps));
+  g_variant_builder_add (&builder, "{sv}", "ipc",
+                         g_variant_builder_end (&ipc));
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static void
+dump_statistics (void)
+{
+  GVariant *statistics = atspi_get_statistics ();
+  gchar *text = g_variant_print (statistics, FALSE);
+
+  g_printerr ("at-spi statistics: %s\n", text);
+  g_free (text);
+  g_variant_unref (statistics);
+}
+
+static gboolean
+dump_statistics_cb (gpointer data)
+{
+  dump_statistics ();
+  return TRUE;
+}
+
+void
+_atspi_statistics_init (void)
+{
+  const gchar *interval = g_getenv ("ATSPI_STATISTICS");
+  gint seconds;
+  GSource *source;
+
+  if (!interval || dump_source_id)
+    return;
+  seconds = atoi (interval);
+  if (seconds <= 0)
+    return;
+
+  source = g_timeout_source_new_seconds (seconds);
+  g_source_set_callback (source, dump_statistics_cb, NULL, NULL);
+  dump_source_id = g_source_attach (source, atspi_main_context);
+  g_source_unref (source);
+}
+
+void
+_atspi_statistics_shutdown (void)
+{
+  if (dump_source_id)
+  {
+    GSource *source = g_main_context_find_source_by_id (atspi_main_context,
+                                                        dump_source_id);
+    if (source)
+      g_source_destroy (source);
+    dump_source_id = 0;
+    dump_statistics ();
+  }
+
+  if (app_statistics)
+  {
+    g_hash_table_destroy (app_statistics);
+    app_statistics = NULL;
+  }
+  if (ipc_statistics)
+  {
+    g_hash_table_destroy (ipc_statistics);
+    ipc_statistics = NULL;
+  }
+}
@@ -130,14 +130,13 @@ atspi_table_get_accessible_at (AtspiTable *obj,
                                  gint column,
                                  GError **error)
 {
-  dbus_int32_t d_row = row, d_column = column;
-  DBusMessage *reply;
+  AtspiAccessible *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_table, "GetAccessibleAt", error, "ii", d_row, d_column);
+  _atspi_call_table_get_accessible_at (obj, row, column, &retval, error);
 
-  return _atspi_dbus_return_accessible_from_message (reply);
+  return retval;
 }
 
 /**
@@ -161,12 +160,11 @@ atspi_table_get_index_at (AtspiTable *obj,
                             gint column,
                             GError **error)
 {
-  dbus_int32_t d_row = row, d_column = column;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetIndexAt", error, "ii=>i", d_row, d_column, &retval);
+  _atspi_call_table_get_index_at (obj, row, column, &retval, error);
 	  
   return retval;
 }
@@ -189,12 +187,11 @@ atspi_table_get_row_at_index (AtspiTable *obj,
                                gint index,
                                GError **error)
 {
-  dbus_int32_t d_index = index;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetRowAtIndex", error, "i=>i", d_index, &retval);
+  _atspi_call_table_get_row_at_index (obj, index, &retval, error);
 	  
   return retval;
 }
@@ -217,12 +214,11 @@ atspi_table_get_column_at_index (AtspiTable *obj,
                                   gint index,
                                   GError **error)
 {
-  dbus_int32_t d_index = index;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetColumnAtIndex", error, "i=>i", d_index, &retval);
+  _atspi_call_table_get_column_at_index (obj, index, &retval, error);
 	  
   return retval;
 }
@@ -242,12 +238,11 @@ atspi_table_get_row_description (AtspiTable *obj,
 				   gint  row,
 				   GError **error)
 {
-  dbus_int32_t d_row = row;
   char *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetRowDescription", error, "i=>s", d_row, &retval);
+  _atspi_call_table_get_row_description (obj, row, &retval, error);
 	  
   return retval;
 }
@@ -266,12 +261,11 @@ gchar *
 atspi_table_get_column_description (AtspiTable *obj,
 				      gint         column, GError **error)
 {
-  dbus_int32_t d_column = column;
   char *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetColumnDescription", error, "i=>s", d_column, &retval);
+  _atspi_call_table_get_column_description (obj, column, &retval, error);
 
   return retval;
 }
@@ -294,12 +288,11 @@ atspi_table_get_row_extent_at (AtspiTable *obj,
                                 gint         column,
                                 GError **error)
 {
-  dbus_int32_t d_row = row, d_column = column;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetRowExtentAt", error, "ii=>i", d_row, d_column, &retval);
+  _atspi_call_table_get_row_extent_at (obj, row, column, &retval, error);
 	  
   return retval;
 }
@@ -322,12 +315,11 @@ atspi_table_get_column_extent_at (AtspiTable *obj,
                                    gint         column,
                                    GError **error)
 {
-  dbus_int32_t d_row = row, d_column = column;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetColumnExtentAt", error, "ii=>i", d_row, d_column, &retval);
+  _atspi_call_table_get_column_extent_at (obj, row, column, &retval, error);
 	  
   return retval;
 }
@@ -348,14 +340,13 @@ atspi_table_get_row_header (AtspiTable *obj,
 			      gint         row,
 			      GError **error)
 {
-  dbus_int32_t d_row = row;
-  DBusMessage *reply;
+  AtspiAccessible *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_table, "GetRowHeader", error, "i", d_row);
+  _atspi_call_table_get_row_header (obj, row, &retval, error);
 
-  return _atspi_dbus_return_accessible_from_message (reply);
+  return retval;
 }
 
 /**
@@ -375,14 +366,13 @@ atspi_table_get_column_header (AtspiTable *obj,
 				 gint column,
 				 GError **error)
 {
-  dbus_int32_t d_column = column;
-  DBusMessage *reply;
+  AtspiAccessible *retval = NULL;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_table, "GetColumnHeader", error, "i", d_column);
+  _atspi_call_table_get_column_header (obj, column, &retval, error);
 
-  return _atspi_dbus_return_accessible_from_message (reply);
+  return retval;
 }
 
 /**
@@ -423,7 +413,7 @@ atspi_table_get_selected_rows (AtspiTable *obj,
 
   g_return_val_if_fail (obj != NULL, 0);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetSelectedRows", error, "=>ai", &rows);
+  _atspi_call_table_get_selected_rows (obj, &rows, error);
 
   return rows;
 }
@@ -446,7 +436,7 @@ atspi_table_get_selected_columns (AtspiTable *obj,
 
   g_return_val_if_fail (obj != NULL, 0);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetSelectedColumns", error, "=>ai", &columns);
+  _atspi_call_table_get_selected_columns (obj, &columns, error);
 
   return columns;
 }
@@ -487,12 +477,11 @@ atspi_table_is_row_selected (AtspiTable *obj,
                                gint row,
                                GError **error)
 {
-  dbus_int32_t d_row = row;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "IsRowSelected", error, "i=>b", d_row, &retval);
+  _atspi_call_table_is_row_selected (obj, row, &retval, error);
 
   return retval;
 }
@@ -512,12 +501,11 @@ atspi_table_is_column_selected (AtspiTable *obj,
                                   gint column,
                                   GError **error)
 {
-  dbus_int32_t d_column = column;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "IsColumnSelected", error, "i=>b", d_column, &retval);
+  _atspi_call_table_is_column_selected (obj, column, &retval, error);
 	  
   return retval;
 }
@@ -537,12 +525,11 @@ atspi_table_add_row_selection (AtspiTable *obj,
 				 gint row,
 				 GError **error)
 {
-  dbus_int32_t d_row = row;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "AddRowSelection", error, "i=>b", d_row, &retval);
+  _atspi_call_table_add_row_selection (obj, row, &retval, error);
 	  
   return retval;
 }
@@ -562,12 +549,11 @@ atspi_table_add_column_selection (AtspiTable *obj,
 				    gint column,
 				    GError **error)
 {
-  dbus_int32_t d_column = column;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "AddColumnSelection", error, "i=>b", d_column, &retval);
+  _atspi_call_table_add_column_selection (obj, column, &retval, error);
 	  
   return retval;
 }
@@ -588,12 +574,11 @@ atspi_table_remove_row_selection (AtspiTable *obj,
 				    gint row,
 				    GError **error)
 {
-  dbus_int32_t d_row = row;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "RemoveRowSelection", error, "i=>b", d_row, &retval);
+  _atspi_call_table_remove_row_selection (obj, row, &retval, error);
 	  
   return retval;
 }
@@ -615,12 +600,11 @@ atspi_table_remove_column_selection (AtspiTable *obj,
 				       gint column,
 				       GError **error)
 {
-  dbus_int32_t d_column = column;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "RemoveColumnSelection", error, "i=>b", d_column, &retval);
+  _atspi_call_table_remove_column_selection (obj, column, &retval, error);
 	  
   return retval;
 }
@@ -673,16 +657,17 @@ atspi_table_get_row_column_extents_at_index (AtspiTable *obj,
 					    gint *row_extents, gint *col_extents, 
 					    gboolean *is_selected, GError **error)
 {
-  dbus_int32_t d_index = index;
-  dbus_bool_t retval = FALSE;
-  dbus_int32_t d_row = 0,  d_col = 0, d_row_extents = 0, d_col_extents = 0;
-  dbus_bool_t d_is_selected = FALSE;
+  gboolean retval = FALSE;
+  gint d_row = 0,  d_col = 0, d_row_extents = 0, d_col_extents = 0;
+  gboolean d_is_selected = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "GetRowColumnExtentsAtIndex",
-                    error, "i=>biiiib", d_index, &retval, &d_row, &d_col,
-                    &d_row_extents, &d_col_extents, &d_is_selected);
+  _atspi_call_table_get_row_column_extents_at_index (obj, index, &retval,
+                                                     &d_row, &d_col,
+                                                     &d_row_extents,
+                                                     &d_col_extents,
+                                                     &d_is_selected, error);
 
   *row = d_row;
   *col = d_col;
@@ -710,12 +695,11 @@ atspi_table_is_selected (AtspiTable *obj,
                             gint column,
                             GError **error)
 {
-  dbus_int32_t d_row = row, d_column = column;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_table, "IsSelected", error, "ii=>b", d_row, d_column, &retval);
+  _atspi_call_table_is_selected (obj, row, column, &retval, error);
 	  
   return retval;
 }
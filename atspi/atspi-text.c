@@ -105,11 +105,10 @@ atspi_text_get_text (AtspiText *obj,
                         GError **error)
 {
   gchar *retval = NULL;
-  dbus_int32_t d_start_offset = start_offset, d_end_offset = end_offset;
 
   g_return_val_if_fail (obj != NULL, g_strdup (""));
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetText", error, "ii=>s", d_start_offset, d_end_offset, &retval);
+  _atspi_call_text_get_text (obj, start_offset, end_offset, &retval, error);
 
   if (!retval)
     retval = g_strdup ("");
@@ -128,11 +127,19 @@ atspi_text_get_text (AtspiText *obj,
 gint
 atspi_text_get_caret_offset (AtspiText *obj, GError **error)
 {
+  AtspiAccessible *accessible = ATSPI_ACCESSIBLE (obj);
   dbus_int32_t retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_get_property (obj, atspi_interface_text, "CaretOffset", error, "i", &retval);
+  if (_atspi_accessible_test_cache (accessible, ATSPI_CACHE_CARET_OFFSET))
+    return accessible->priv->caret_offset;
+
+  if (_atspi_dbus_get_property (obj, atspi_interface_text, "CaretOffset", error, "i", &retval))
+  {
+    accessible->priv->caret_offset = retval;
+    _atspi_accessible_add_cache (accessible, ATSPI_CACHE_CARET_OFFSET);
+  }
 
   return retval;
 }
@@ -192,31 +199,13 @@ atspi_text_get_text_attributes (AtspiText *obj,
 			   gint *end_offset,
 			   GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_int32_t d_start_offset, d_end_offset;
-  DBusMessage *reply;
-  DBusMessageIter iter;
   GHashTable *ret = NULL;
 
   if (obj == NULL)
    return NULL;
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_text, "GetAttributes", error, "i", d_offset);
-  _ATSPI_DBUS_CHECK_SIG (reply, "a{ss}ii", error, ret)
-
-  dbus_message_iter_init (reply, &iter);
-  ret = _atspi_dbus_hash_from_iter (&iter);
-  dbus_message_iter_next (&iter);
-
-  dbus_message_iter_get_basic (&iter, &d_start_offset);
-  if (start_offset)
-    *start_offset = d_start_offset;
-  dbus_message_iter_next (&iter);
-  dbus_message_iter_get_basic (&iter, &d_end_offset);
-  if (end_offset)
-    *end_offset = d_end_offset;
-
-  dbus_message_unref (reply);
+  _atspi_call_text_get_attributes (obj, offset, &ret, start_offset,
+                                   end_offset, error);
   return ret;
 }
 
@@ -248,33 +237,13 @@ atspi_text_get_attribute_run (AtspiText *obj,
 			      gint *end_offset,
 			      GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_int32_t d_start_offset, d_end_offset;
-  DBusMessage *reply;
-  DBusMessageIter iter;
   GHashTable *ret = NULL;
 
   if (obj == NULL)
    return NULL;
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_text,
-                                    "GetAttributeRun", error, "ib", d_offset,
-                                    include_defaults);
-  _ATSPI_DBUS_CHECK_SIG (reply, "a{ss}ii", error, ret)
-
-  dbus_message_iter_init (reply, &iter);
-  ret = _atspi_dbus_hash_from_iter (&iter);
-  dbus_message_iter_next (&iter);
-
-  dbus_message_iter_get_basic (&iter, &d_start_offset);
-  if (start_offset)
-    *start_offset = d_start_offset;
-  dbus_message_iter_next (&iter);
-  dbus_message_iter_get_basic (&iter, &d_end_offset);
-  if (end_offset)
-    *end_offset = d_end_offset;
-
-  dbus_message_unref (reply);
+  _atspi_call_text_get_attribute_run (obj, offset, include_defaults, &ret,
+                                      start_offset, end_offset, error);
   return ret;
 }
 
@@ -319,11 +288,11 @@ atspi_text_get_text_attribute_value (AtspiText *obj,
                                      GError **error)
 {
   gchar *retval = NULL;
-  dbus_int32_t d_i = offset;
 
   g_return_val_if_fail (obj != NULL, NULL);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetAttributeValue", error, "is=>s", d_i, (const gchar *)attribute_value, &retval);
+  _atspi_call_text_get_attribute_value (obj, offset, attribute_value, &retval,
+                                        error);
 
   if (!retval)
     retval = g_strdup ("");
@@ -348,12 +317,12 @@ atspi_text_get_text_attribute_value (AtspiText *obj,
 GHashTable *
 atspi_text_get_default_attributes (AtspiText *obj, GError **error)
 {
-  DBusMessage *reply;
+  GHashTable *ret = NULL;
 
     g_return_val_if_fail (obj != NULL, NULL);
 
-  reply = _atspi_dbus_call_partial (obj, atspi_interface_text, "GetDefaultAttributes", error, "");
-  return _atspi_dbus_return_hash_from_message (reply);
+  _atspi_call_text_get_default_attributes (obj, &ret, error);
+  return ret;
 }
 
 
@@ -371,12 +340,12 @@ atspi_text_set_caret_offset (AtspiText *obj,
                                gint new_offset,
                                GError **error)
 {
-  dbus_int32_t d_new_offset = new_offset;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "SetCaretOffset", error, "i=>b", d_new_offset, &retval);
+  _atspi_call_text_set_caret_offset (obj, new_offset, &retval, error);
+  _atspi_accessible_remove_cache (ATSPI_ACCESSIBLE (obj), ATSPI_CACHE_CARET_OFFSET);
 
   return retval;
 }
@@ -402,21 +371,15 @@ atspi_text_get_text_before_offset (AtspiText *obj,
                                     AtspiTextBoundaryType type,
                                     GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t d_start_offset = -1, d_end_offset = -1;
   AtspiTextRange *range = g_new0 (AtspiTextRange, 1);
 
   range->start_offset = range->end_offset = -1;
   if (!obj)
     return range;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetTextBeforeOffset", error,
-                    "iu=>sii", d_offset, d_type, &range->content,
-                    &d_start_offset, &d_end_offset);
-
-  range->start_offset = d_start_offset;
-  range->end_offset = d_end_offset;
+  _atspi_call_text_get_text_before_offset (obj, offset, type, &range->content,
+                                           &range->start_offset, &range->end_offset,
+                                           error);
   if (!range->content)
     range->content = g_strdup ("");
 
@@ -472,21 +435,15 @@ atspi_text_get_string_at_offset (AtspiText *obj,
                                  AtspiTextGranularity granularity,
                                  GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_uint32_t d_granularity = granularity;
-  dbus_int32_t d_start_offset = -1, d_end_offset = -1;
   AtspiTextRange *range = g_new0 (AtspiTextRange, 1);
 
   range->start_offset = range->end_offset = -1;
   if (!obj)
     return range;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetStringAtOffset", error,
-                    "iu=>sii", d_offset, d_granularity, &range->content,
-                    &d_start_offset, &d_end_offset);
-
-  range->start_offset = d_start_offset;
-  range->end_offset = d_end_offset;
+  _atspi_call_text_get_string_at_offset (obj, offset, granularity, &range->content,
+                                         &range->start_offset, &range->end_offset,
+                                         error);
   if (!range->content)
     range->content = g_strdup ("");
 
@@ -516,21 +473,15 @@ atspi_text_get_text_at_offset (AtspiText *obj,
                                     AtspiTextBoundaryType type,
                                     GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t d_start_offset = -1, d_end_offset = -1;
   AtspiTextRange *range = g_new0 (AtspiTextRange, 1);
 
   range->start_offset = range->end_offset = -1;
   if (!obj)
     return range;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetTextAtOffset", error,
-                    "iu=>sii", d_offset, d_type, &range->content,
-                    &d_start_offset, &d_end_offset);
-
-  range->start_offset = d_start_offset;
-  range->end_offset = d_end_offset;
+  _atspi_call_text_get_text_at_offset (obj, offset, type, &range->content,
+                                       &range->start_offset, &range->end_offset,
+                                       error);
   if (!range->content)
     range->content = g_strdup ("");
 
@@ -559,21 +510,15 @@ atspi_text_get_text_after_offset (AtspiText *obj,
                                     AtspiTextBoundaryType type,
                                     GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t d_start_offset = -1, d_end_offset = -1;
   AtspiTextRange *range = g_new0 (AtspiTextRange, 1);
 
   range->start_offset = range->end_offset = -1;
   if (!obj)
     return range;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetTextAfterOffset", error,
-                    "iu=>sii", d_offset, d_type, &range->content,
-                    &d_start_offset, &d_end_offset);
-
-  range->start_offset = d_start_offset;
-  range->end_offset = d_end_offset;
+  _atspi_call_text_get_text_after_offset (obj, offset, type, &range->content,
+                                          &range->start_offset, &range->end_offset,
+                                          error);
   if (!range->content)
     range->content = g_strdup ("");
 
@@ -598,12 +543,11 @@ atspi_text_get_character_at_offset (AtspiText *obj,
                                      gint offset,
                                      GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetCharacterAtOffset", error, "i=>i", d_offset, &retval);
+  _atspi_call_text_get_character_at_offset (obj, offset, &retval, error);
 
   return retval;
 }
@@ -628,9 +572,6 @@ atspi_text_get_character_extents (AtspiText *obj,
 				    AtspiCoordType type,
 				    GError **error)
 {
-  dbus_int32_t d_offset = offset;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t d_x, d_y, d_width, d_height;
   AtspiRect ret;
 
   ret.x = ret.y = ret.width = ret.height = -1;
@@ -638,12 +579,8 @@ atspi_text_get_character_extents (AtspiText *obj,
   if (obj == NULL)
     return atspi_rect_copy (&ret);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetCharacterExtents", error, "iu=>iiii", d_offset, d_type, &d_x, &d_y, &d_width, &d_height);
-
-  ret.x = d_x;
-  ret.y = d_y;
-  ret.width = d_width;
-  ret.height = d_height;
+  _atspi_call_text_get_character_extents (obj, offset, type, &ret.x, &ret.y,
+                                          &ret.width, &ret.height, error);
   return atspi_rect_copy (&ret);
 }
 
@@ -668,13 +605,11 @@ atspi_text_get_offset_at_point (AtspiText *obj,
 				 AtspiCoordType type,
 				 GError **error)
 {
-  dbus_int32_t d_x = x, d_y = y;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t retval = -1;
+  gint retval = -1;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetOffsetAtPoint", error, "iiu=>i", d_x, d_y, d_type, &retval);
+  _atspi_call_text_get_offset_at_point (obj, x, y, type, &retval, error);
 
   return retval;
 }
@@ -702,9 +637,6 @@ atspi_text_get_range_extents (AtspiText *obj,
 				AtspiCoordType type,
 				GError **error)
 {
-  dbus_int32_t d_start_offset = start_offset, d_end_offset = end_offset;
-  dbus_uint32_t d_type = type;
-  dbus_int32_t d_x, d_y, d_width, d_height;
   AtspiRect ret;
 
   ret.x = ret.y = ret.width = ret.height = -1;
@@ -712,12 +644,9 @@ atspi_text_get_range_extents (AtspiText *obj,
   if (obj == NULL)
     return atspi_rect_copy (&ret);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetRangeExtents", error, "iiu=>iiii", d_start_offset, d_end_offset, d_type, &d_x, &d_y, &d_width, &d_height);
-
-  ret.x = d_x;
-  ret.y = d_y;
-  ret.width = d_width;
-  ret.height = d_height;
+  _atspi_call_text_get_range_extents (obj, start_offset, end_offset, type,
+                                      &ret.x, &ret.y, &ret.width, &ret.height,
+                                      error);
   return atspi_rect_copy (&ret);
 }
 
@@ -778,11 +707,11 @@ atspi_text_get_bounded_ranges (AtspiText *obj,
 gint
 atspi_text_get_n_selections (AtspiText *obj, GError **error)
 {
-  dbus_int32_t retval = 0;
+  gint retval = 0;
 
   g_return_val_if_fail (obj != NULL, -1);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetNSelections", error, "=>i", &retval);
+  _atspi_call_text_get_n_selections (obj, &retval, error);
 
   return retval;
 }
@@ -800,8 +729,6 @@ atspi_text_get_selection (AtspiText *obj,
 			     gint selection_num,
 			     GError **error)
 {
-  dbus_int32_t d_selection_num = selection_num;
-  dbus_int32_t d_start_offset, d_end_offset;
   AtspiRange *ret = g_new (AtspiRange, 1);
 
   ret->start_offset = ret->end_offset = -1;
@@ -809,10 +736,8 @@ atspi_text_get_selection (AtspiText *obj,
   if (!obj)
     return ret;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "GetSelection", error, "i=>ii", d_selection_num, &d_start_offset, &d_end_offset);
-
-  ret->start_offset = d_start_offset;
-  ret->end_offset = d_end_offset;
+  _atspi_call_text_get_selection (obj, selection_num, &ret->start_offset,
+                                  &ret->end_offset, error);
   return ret;
 }
 
@@ -831,10 +756,10 @@ atspi_text_add_selection (AtspiText *obj,
 			     gint start_offset, gint end_offset,
 			     GError **error)
 {
-  dbus_int32_t d_start_offset = start_offset, d_end_offset = end_offset;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
-  _atspi_dbus_call (obj, atspi_interface_text, "AddSelection", error, "ii=>b", d_start_offset, d_end_offset, &retval);
+  _atspi_call_text_add_selection (obj, start_offset, end_offset, &retval,
+                                  error);
 
   return retval;
 }
@@ -853,12 +778,11 @@ atspi_text_remove_selection (AtspiText *obj,
 				gint selection_num,
 				GError **error)
 {
-  dbus_int32_t d_selection_num = selection_num;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "RemoveSelection", error, "i=>b", d_selection_num, &retval);
+  _atspi_call_text_remove_selection (obj, selection_num, &retval, error);
 
   return retval;
 }
@@ -882,12 +806,12 @@ atspi_text_set_selection (AtspiText *obj,
 			     gint end_offset,
 			     GError **error)
 {
-  dbus_int32_t d_selection_num = selection_num, d_start_offset = start_offset, d_end_offset = end_offset;
-  dbus_bool_t retval = FALSE;
+  gboolean retval = FALSE;
 
   g_return_val_if_fail (obj != NULL, FALSE);
 
-  _atspi_dbus_call (obj, atspi_interface_text, "SetSelection", error, "iii=>b", d_selection_num, d_start_offset, d_end_offset, &retval);
+  _atspi_call_text_set_selection (obj, selection_num, start_offset,
+                                  end_offset, &retval, error);
 
   return retval;
 }
@@ -155,4 +155,22 @@ typedef enum {
   ATSPI_KEYLISTENER_CANCONSUME = 1 << 1,
   ATSPI_KEYLISTENER_ALL_WINDOWS = 1 << 2
 } AtspiKeyListenerSyncType;
+
+/**
+ * AtspiEventOverflowPolicy:
+ * @ATSPI_EVENT_OVERFLOW_DROP_OLDEST: The oldest queued event is discarded
+ * to make room for the new one.
+ * @ATSPI_EVENT_OVERFLOW_DROP_NEWEST: The new event is discarded.
+ * @ATSPI_EVENT_OVERFLOW_COALESCE: A queued event of the same type from the
+ * same source is replaced by the new one, which goes to the back of the
+ * queue; if there is none, the oldest event is discarded.
+ *
+ * What happens when an event is due for a listener whose queue is full.
+ * See #atspi_event_listener_set_dispatch_context.
+ **/
+typedef enum {
+  ATSPI_EVENT_OVERFLOW_DROP_OLDEST,
+  ATSPI_EVENT_OVERFLOW_DROP_NEWEST,
+  ATSPI_EVENT_OVERFLOW_COALESCE
+} AtspiEventOverflowPolicy;
 #endif	/* _ATSPI_TYPES_H_ */
@@ -55,11 +55,19 @@ atspi_value_get_minimum_value (AtspiValue *obj, GError **error)
 gdouble
 atspi_value_get_current_value (AtspiValue *obj, GError **error)
 {
+  AtspiAccessible *accessible = ATSPI_ACCESSIBLE (obj);
   double retval;
 
   g_return_val_if_fail (obj != NULL, 0.0);
 
-  _atspi_dbus_get_property (obj, atspi_interface_value, "CurrentValue", error, "d", &retval);
+  if (_atspi_accessible_test_cache (accessible, ATSPI_CACHE_CURRENT_VALUE))
+    return accessible->priv->current_value;
+
+  if (_atspi_dbus_get_property (obj, atspi_interface_value, "CurrentValue", error, "d", &retval))
+  {
+    accessible->priv->current_value = retval;
+    _atspi_accessible_add_cache (accessible, ATSPI_CACHE_CURRENT_VALUE);
+  }
 
   return retval;
 }
@@ -125,7 +133,9 @@ atspi_value_set_current_value (AtspiValue *obj, gdouble new_value, GError **erro
   dbus_message_iter_append_basic (&iter_variant, DBUS_TYPE_DOUBLE, &d_new_value);
   dbus_message_iter_close_container (&iter, &iter_variant);
     reply = _atspi_dbus_send_with_reply_and_block (message, error);
-  dbus_message_unref (reply);
+  if (reply)
+    dbus_message_unref (reply);
+  _atspi_accessible_remove_cache (accessible, ATSPI_CACHE_CURRENT_VALUE);
 
   return TRUE;
 }
@@ -30,6 +30,7 @@
 #include "atspi-types.h"
 #include "atspi-accessible.h"
 #include "atspi-action.h"
+#include "atspi-cache-view.h"
 #include "atspi-collection.h"
 #include "atspi-component.h"
 #include "atspi-device-listener.h"
@@ -44,6 +45,7 @@
 #include "atspi-registry.h"
 #include "atspi-relation.h"
 #include "atspi-selection.h"
+#include "atspi-snapshot.h"
 #include "atspi-stateset.h"
 #include "atspi-table.h"
 #include "atspi-table-cell.h"
@@ -0,0 +1,169 @@
+#!/usr/bin/env python
+#
+# Generates the name lookup tables used by libatspi:
+#
+#   - D-Bus interface name -> interface number, from the interface names
+#     in xml/*.xml plus any given with --extra-interface
+#   - state nick -> AtspiStateType, from atspi-constants.h
+#   - AtspiRole -> role name, from atspi-constants.h
+#
+# Name -> value lookups use a perfect hash computed here, so at run time
+# they cost one hash, one table load and one strcmp.
+#
+# Usage: gen-lookup-tables.py [--header] [--extra-interface NAME]...
+#                             atspi-constants.h xml-file...
+
+import re
+import sys
+from xml.etree import ElementTree
+
+HEADER = """/*
+ * This file has been generated by gen-lookup-tables.py from
+ * atspi-constants.h and the D-Bus introspection data in xml/.
+ *
+ * DO NOT EDIT.
+ */
+"""
+
+def parse_enum (text, name):
+    m = re.search (r'typedef enum\s*\{([^}]*)\}\s*' + name + r'\s*;', text)
+    if not m:
+        sys.exit ("gen-lookup-tables: enum %s not found" % name)
+    values = []
+    for line in m.group (1).split ('\n'):
+        line = line.strip ().rstrip (',')
+        if not line:
+            continue
+        if '=' in line:
+            sys.exit ("gen-lookup-tables: %s has explicit values" % name)
+        values.append (line)
+    return values
+
+def strip_prefix (values):
+    # Same rule as glib-mkenums: the longest common prefix ending in '_'
+    prefix = values [0]
+    for v in values [1:]:
+        while not v.startswith (prefix):
+            prefix = prefix [:-1]
+    prefix = prefix [:prefix.rfind ('_') + 1]
+    return [v [len (prefix):].lower ().replace ('_', '-') for v in values]
+
+def string_hash (s, seed):
+    # Must match _atspi_lookup_hash () below
+    h = seed
+    for c in s.encode ('utf-8'):
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h
+
+def perfect_hash (keys):
+    size = 1
+    while size < len (keys):
+        size *= 2
+    while True:
+        for seed in range (1, 1 << 16):
+            slots = [-1] * size
+            for i, k in enumerate (keys):
+                slot = string_hash (k, seed) & (size - 1)
+                if slots [slot] >= 0:
+                    break
+                slots [slot] = i
+            else:
+                return seed, slots
+        size *= 2
+
+def emit_table (out, name, keys):
+    seed, slots = perfect_hash (keys)
+    out.append ("static const char *const %s_names[] =\n{" % name)
+    for k in keys:
+        out.append ('  "%s",' % k)
+    out.append ("};\n")
+    out.append ("static const gint16 %s_slots[] =\n{" % name)
+    for i in range (0, len (slots), 16):
+        out.append ("  " + ", ".join (str (s) for s in slots [i:i + 16]) + ",")
+    out.append ("};\n")
+    out.append ("""gint
+_atspi_lookup_%s (const char *name)
+{
+  gint i = %s_slots [_atspi_lookup_hash (name, %du) & %d];
+
+  return (i >= 0 && !strcmp (name, %s_names [i]) ? i : -1);
+}
+""" % (name, name, seed, len (slots) - 1, name))
+
+def main (argv):
+    header = False
+    extra = []
+    files = []
+    i = 0
+    while i < len (argv):
+        if argv [i] == '--header':
+            header = True
+        elif argv [i] == '--extra-interface':
+            i += 1
+            extra.append (argv [i])
+        else:
+            files.append (argv [i])
+        i += 1
+
+    if header:
+        print (HEADER)
+        print ("""#ifndef _ATSPI_LOOKUP_TABLES_H_
+#define _ATSPI_LOOKUP_TABLES_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gint _atspi_lookup_interface (const char *name);
+
+gint _atspi_lookup_state (const char *nick);
+
+const char *_atspi_lookup_role_name (gint role);
+
+G_END_DECLS
+
+#endif /* _ATSPI_LOOKUP_TABLES_H_ */""")
+        return
+
+    text = open (files [0]).read ()
+    states = strip_prefix (parse_enum (text, 'AtspiStateType'))
+    roles = strip_prefix (parse_enum (text, 'AtspiRole'))
+
+    ifaces = set (extra)
+    for f in files [1:]:
+        for node in ElementTree.parse (f).iter ('interface'):
+            iface = node.get ('name')
+            # Event interfaces carry signals only; objects never implement them
+            if not iface.startswith ('org.a11y.atspi.Event.'):
+                ifaces.add (iface)
+    ifaces = sorted (ifaces)
+    if len (ifaces) > 31:
+        sys.exit ("gen-lookup-tables: too many interfaces for a gint mask")
+
+    out = [HEADER, "#include <string.h>", '#include "atspi-lookup-tables.h"', ""]
+    out.append ("""static inline guint32
+_atspi_lookup_hash (const char *s, guint32 h)
+{
+  while (*s)
+    h = (h ^ (guchar) *s++) * 16777619u;
+  return h;
+}
+""")
+    emit_table (out, 'interface', ifaces)
+    emit_table (out, 'state', states)
+    out.append ("/* Role names in the form returned by atspi_role_get_name () */")
+    out.append ("static const char *const role_names[] =\n{")
+    for r in roles:
+        out.append ('  "%s",' % r.replace ('-', ' '))
+    out.append ("};\n")
+    out.append ("""const char *
+_atspi_lookup_role_name (gint role)
+{
+  if (role < 0 || role >= (gint) G_N_ELEMENTS (role_names))
+    return NULL;
+  return role_names [role];
+}""")
+    print ("\n".join (out))
+
+if __name__ == '__main__':
+    main (sys.argv [1:])
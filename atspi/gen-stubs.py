@@ -0,0 +1,264 @@
+#!/usr/bin/env python
+#
+# Generates typed client stubs for the methods in the given D-Bus
+# introspection files.  Each method becomes
+#
+#   gboolean _atspi_call_<interface>_<method> (gpointer obj, in args...,
+#                                              out pointers..., GError **error)
+#
+# which appends the in arguments directly with libdbus, checks the reply
+# signature once and reads the out arguments directly, without parsing a
+# dbind type string on every call.  Out pointers may be NULL.
+#
+# Methods using types the stubs cannot express are listed as skipped in
+# the generated files; callers keep using _atspi_dbus_call for those.
+#
+# Usage: gen-stubs.py [--header] xml-file...
+
+import re
+import sys
+from xml.etree import ElementTree
+
+HEADER = """/*
+ * This file has been generated by gen-stubs.py from the D-Bus
+ * introspection data in xml/.
+ *
+ * DO NOT EDIT.
+ */
+"""
+
+# D-Bus basic type -> (C type, libdbus temporary type, DBUS_TYPE_ constant)
+BASIC = {
+    'y': ('guchar', 'unsigned char', 'DBUS_TYPE_BYTE'),
+    'b': ('gboolean', 'dbus_bool_t', 'DBUS_TYPE_BOOLEAN'),
+    'n': ('gint16', 'dbus_int16_t', 'DBUS_TYPE_INT16'),
+    'q': ('guint16', 'dbus_uint16_t', 'DBUS_TYPE_UINT16'),
+    'i': ('gint', 'dbus_int32_t', 'DBUS_TYPE_INT32'),
+    'u': ('guint', 'dbus_uint32_t', 'DBUS_TYPE_UINT32'),
+    'x': ('gint64', 'dbus_int64_t', 'DBUS_TYPE_INT64'),
+    't': ('guint64', 'dbus_uint64_t', 'DBUS_TYPE_UINT64'),
+    'd': ('gdouble', 'double', 'DBUS_TYPE_DOUBLE'),
+    's': ('const gchar *', 'const char *', 'DBUS_TYPE_STRING'),
+    'o': ('const gchar *', 'const char *', 'DBUS_TYPE_OBJECT_PATH'),
+    'g': ('const gchar *', 'const char *', 'DBUS_TYPE_SIGNATURE'),
+}
+
+# Struct out arguments that map onto a public libatspi type
+STRUCTS = {
+    '(iiii)': ('AtspiRect', ['x', 'y', 'width', 'height']),
+    '(ii)': ('AtspiPoint', ['x', 'y']),
+}
+
+def snake (name):
+    name = re.sub (r'([A-Z]+)([A-Z][a-z])', r'\1_\2', name)
+    return re.sub (r'([a-z0-9])([A-Z])', r'\1_\2', name).lower ()
+
+def out_type (sig):
+    """C type of an out parameter, or None if the stubs cannot read SIG"""
+    if sig in BASIC:
+        ctype = BASIC [sig][0]
+        if ctype == 'const gchar *':
+            return 'gchar **'
+        return ctype + ' *'
+    if sig == '(so)':
+        return 'AtspiAccessible **'
+    if sig == 'a{ss}':
+        return 'GHashTable **'
+    if len (sig) == 2 and sig [0] == 'a' and sig [1] in 'ybnqiuxtd':
+        return 'GArray **'
+    if sig in STRUCTS:
+        return STRUCTS [sig][0] + ' *'
+    return None
+
+class Method:
+    def __init__ (self, iface, node):
+        self.iface = iface
+        self.name = node.get ('name')
+        self.ins = []
+        self.outs = []
+        for arg in node.findall ('arg'):
+            name = arg.get ('name')
+            if name:
+                name = snake (name)
+            if arg.get ('direction') == 'out':
+                self.outs.append ([name, arg.get ('type')])
+            else:
+                self.ins.append ([name or 'arg%d' % len (self.ins), arg.get ('type')])
+        in_names = set (a [0] for a in self.ins)
+        for i, arg in enumerate (self.outs):
+            if not arg [0]:
+                arg [0] = 'ret' if i == 0 else 'ret%d' % i
+            if arg [0] in in_names:
+                arg [0] += '_out'
+
+    def supported (self):
+        for name, sig in self.ins:
+            if sig not in BASIC:
+                return False
+        for name, sig in self.outs:
+            if not out_type (sig):
+                return False
+        return True
+
+    def func (self):
+        return '_atspi_call_%s_%s' % (self.iface, snake (self.name))
+
+    def prototype (self):
+        params = ['gpointer obj']
+        params += ['%s%s%s' % (BASIC [sig][0], '' if BASIC [sig][0].endswith ('*') else ' ', name)
+                   for name, sig in self.ins]
+        params += ['%s%s' % (out_type (sig), name) for name, sig in self.outs]
+        params.append ('GError **error')
+        indent = ' ' * (len (self.func ()) + 2)
+        return '%s (%s)' % (self.func (), (',\n' + indent).join (params))
+
+def emit_read (out, name, sig, last):
+    if sig in BASIC:
+        ctype, dtype, const = BASIC [sig]
+        out.append ('  {')
+        out.append ('    %s%sv;' % (dtype, '' if dtype.endswith ('*') else ' '))
+        out.append ('    dbus_message_iter_get_basic (&iter, &v);')
+        out.append ('    if (%s)' % name)
+        if ctype == 'const gchar *':
+            out.append ('      *%s = g_strdup (v);' % name)
+        else:
+            out.append ('      *%s = v;' % name)
+        out.append ('  }')
+        if not last:
+            out.append ('  dbus_message_iter_next (&iter);')
+    elif sig == '(so)':
+        # _atspi_dbus_return_accessible_from_iter moves past the struct
+        out.append ('  {')
+        out.append ('    AtspiAccessible *v = _atspi_dbus_return_accessible_from_iter (&iter);')
+        out.append ('    if (%s)' % name)
+        out.append ('      *%s = v;' % name)
+        out.append ('    else if (v)')
+        out.append ('      g_object_unref (v);')
+        out.append ('  }')
+    elif sig == 'a{ss}':
+        out.append ('  {')
+        out.append ('    GHashTable *v = _atspi_dbus_hash_from_iter (&iter);')
+        out.append ('    if (%s)' % name)
+        out.append ('      *%s = v;' % name)
+        out.append ('    else')
+        out.append ('      g_hash_table_unref (v);')
+        out.append ('  }')
+        if not last:
+            out.append ('  dbus_message_iter_next (&iter);')
+    elif sig [0] == 'a':
+        dtype = BASIC [sig [1]][1]
+        out.append ('  if (%s)' % name)
+        out.append ('  {')
+        out.append ('    DBusMessageIter iter_array;')
+        out.append ('    const %s *v;' % dtype)
+        out.append ('    int n;')
+        out.append ('    dbus_message_iter_recurse (&iter, &iter_array);')
+        out.append ('    dbus_message_iter_get_fixed_array (&iter_array, &v, &n);')
+        out.append ('    *%s = g_array_sized_new (FALSE, FALSE, sizeof (%s), n);' % (name, dtype))
+        out.append ('    g_array_append_vals (*%s, v, n);' % name)
+        out.append ('  }')
+        if not last:
+            out.append ('  dbus_message_iter_next (&iter);')
+    else:
+        ctype, fields = STRUCTS [sig]
+        out.append ('  if (%s)' % name)
+        out.append ('  {')
+        out.append ('    DBusMessageIter iter_struct;')
+        out.append ('    dbus_int32_t v;')
+        out.append ('    dbus_message_iter_recurse (&iter, &iter_struct);')
+        for i, field in enumerate (fields):
+            if i:
+                out.append ('    dbus_message_iter_next (&iter_struct);')
+            out.append ('    dbus_message_iter_get_basic (&iter_struct, &v);')
+            out.append ('    %s->%s = v;' % (name, field))
+        out.append ('  }')
+        if not last:
+            out.append ('  dbus_message_iter_next (&iter);')
+
+def emit_stub (out, m):
+    out.append ('gboolean\n%s\n{' % m.prototype ())
+    out.append ('  DBusMessage *message, *reply;')
+    out.append ('  DBusMessageIter iter;')
+    for name, sig in m.ins:
+        dtype = BASIC [sig][1]
+        out.append ('  %s%sd_%s = %s;' % (dtype, '' if dtype.endswith ('*') else ' ', name, name))
+    out.append ('')
+    out.append ('  message = _atspi_dbus_new_call (obj, atspi_interface_%s, "%s", error);'
+                % (m.iface, m.name))
+    out.append ('  if (!message)')
+    out.append ('    return FALSE;')
+    if m.ins:
+        out.append ('  dbus_message_iter_init_append (message, &iter);')
+        for name, sig in m.ins:
+            out.append ('  dbus_message_iter_append_basic (&iter, %s, &d_%s);'
+                        % (BASIC [sig][2], name))
+    out.append ('')
+    out.append ('  reply = _atspi_dbus_send_call (obj, message, "%s", error);'
+                % ''.join (sig for name, sig in m.outs))
+    out.append ('  if (!reply)')
+    out.append ('    return FALSE;')
+    if m.outs:
+        out.append ('')
+        out.append ('  dbus_message_iter_init (reply, &iter);')
+        for i, (name, sig) in enumerate (m.outs):
+            emit_read (out, name, sig, i == len (m.outs) - 1)
+    out.append ('')
+    out.append ('  dbus_message_unref (reply);')
+    out.append ('  return TRUE;')
+    out.append ('}\n')
+
+def parse (files):
+    methods = []
+    for f in files:
+        for node in ElementTree.parse (f).iter ('interface'):
+            iface = snake (node.get ('name').split ('.') [-1])
+            for method in node.findall ('method'):
+                methods.append (Method (iface, method))
+    return methods
+
+def skipped_comment (methods):
+    skipped = ['%s.%s' % (m.iface, m.name) for m in methods if not m.supported ()]
+    if not skipped:
+        return []
+    lines = ['/* Skipped; these use types the stubs do not handle:']
+    lines += [' *   ' + s for s in skipped]
+    lines.append (' */\n')
+    return lines
+
+def main (argv):
+    header = False
+    files = []
+    for arg in argv:
+        if arg == '--header':
+            header = True
+        else:
+            files.append (arg)
+
+    methods = parse (files)
+    supported = [m for m in methods if m.supported ()]
+
+    if header:
+        out = [HEADER, """#ifndef _ATSPI_STUBS_H_
+#define _ATSPI_STUBS_H_
+
+#include <glib.h>
+
+#include "atspi.h"
+
+G_BEGIN_DECLS
+"""]
+        out += skipped_comment (methods)
+        for m in supported:
+            out.append ('gboolean %s;\n' % m.prototype ().replace ('\n', '\n         '))
+        out.append ('G_END_DECLS\n\n#endif /* _ATSPI_STUBS_H_ */')
+        print ('\n'.join (out))
+        return
+
+    out = [HEADER, '#include "atspi-private.h"', '']
+    out += skipped_comment (methods)
+    for m in supported:
+        emit_stub (out, m)
+    print ('\n'.join (out).rstrip ())
+
+if __name__ == '__main__':
+    main (sys.argv [1:])
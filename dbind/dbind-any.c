@@ -19,6 +19,7 @@
 
 /* type driven marshalling */
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 
 #include "config.h"
@@ -63,6 +64,8 @@ warn_braces ()
              " an explicit type member of 'struct'\n");
 }
 
+static const char *pass_arg (const char *p);
+
 /*---------------------------------------------------------------------------*/
 
 static unsigned int
@@ -97,10 +100,13 @@ dbind_find_c_alignment_r (const char **type)
     case DBUS_TYPE_STRING:
     case DBUS_TYPE_OBJECT_PATH:
     case DBUS_TYPE_SIGNATURE:
+        return DBIND_ALIGNOF_DBIND_POINTER;
     case DBUS_TYPE_ARRAY:
+        /* the element type is behind the pointer; just step over it */
+        if (**type != '\0')
+            *type = pass_arg (*type);
         return DBIND_ALIGNOF_DBIND_POINTER;
     case DBUS_STRUCT_BEGIN_CHAR:
-      /* TODO: I think this would break with a nested struct */
 #if DBIND_ALIGNOF_DBIND_STRUCT > 1
                 retval = MAX (retval, DBIND_ALIGNOF_DBIND_STRUCT);
 #endif
@@ -140,25 +146,8 @@ dbind_gather_alloc_info_r (const char **type)
 {
   char t = **type;
   (*type)++;
-  if (t == DBUS_TYPE_ARRAY)
-    {
-      switch (**type)
-        {
-          case DBUS_STRUCT_BEGIN_CHAR:
-              while (**type != DBUS_STRUCT_END_CHAR && **type != '\0') (*type)++;
-              if (**type != '\0') (*type)++;
-              break;
-          case DBUS_DICT_ENTRY_BEGIN_CHAR:
-              while (**type != DBUS_DICT_ENTRY_END_CHAR && **type != '\0') (*type)++;
-              if (**type != '\0') (*type)++;
-              break;
-          case '\0':
-              break;
-          default:
-              (*type)++;
-              break;
-        }
-    }
+  if (t == DBUS_TYPE_ARRAY && **type != '\0')
+    *type = pass_arg (*type);
 
   switch (t) {
     case DBUS_TYPE_BYTE:
@@ -230,222 +219,293 @@ dbind_gather_alloc_info (const char *type)
 
 /*---------------------------------------------------------------------------*/
 
-static void
-dbind_any_free_r (const char **type, void **data)
+/*
+ * A plan is a type string compiled once: the C size, alignment and
+ * member offsets the functions above would otherwise work out again for
+ * every value (and, inside arrays, for every element).  Plans are looked
+ * up by the address of the type string, which is nearly always a
+ * literal, and are never freed, so they can be used without a lock once
+ * found.
+ */
+typedef struct _DBindPlan DBindPlan;
+struct _DBindPlan
 {
-#ifdef DEBUG
-    fprintf (stderr, "any free '%c' to %p\n", **type, *data);
-#endif
+    char code;                  /* first character of the type */
+    size_t length;              /* characters in the type string */
+    char *signature;            /* the type string alone */
+    size_t size;                /* C size of one value */
+    size_t align;               /* C alignment of one value */
+    gboolean needs_free;        /* holds strings or arrays */
+    const DBindPlan *elem;      /* arrays: the element type */
+    gboolean fixed;             /* arrays: elements are copied as one block */
+    guint n_members;            /* structs and dict entries */
+    const DBindPlan **members;
+    size_t *offsets;
+};
+
+/* A type string seen at a new address that is then freed can have its
+ * address reused for another type, so every hit is checked against the
+ * plan's own copy of the string.  Past this many addresses the table is
+ * emptied, which only costs a lookup in plans_by_signature. */
+#define MAX_PLAN_ADDRESSES 4096
+
+G_LOCK_DEFINE_STATIC (plans);
+static GHashTable *plans_by_address;
+static GHashTable *plans_by_signature;
+
+static const DBindPlan *
+compile_plan (const char *type)
+{
+    const char *end = pass_arg (type);
+    char *signature = g_strndup (type, end - type);
+    DBindPlan *plan;
+
+    plan = g_hash_table_lookup (plans_by_signature, signature);
+    if (plan) {
+        g_free (signature);
+        return plan;
+    }
 
-    switch (**type) {
-    case DBIND_POD_CASES:
-        *data = ((guchar *)*data) + dbind_gather_alloc_info (*type);
-        (*type)++;
-        break;
+    plan = g_new0 (DBindPlan, 1);
+    plan->code = *type;
+    plan->length = end - type;
+    plan->signature = signature;
+    plan->size = dbind_gather_alloc_info (type);
+    plan->align = dbind_find_c_alignment (type);
+
+    switch (*type) {
     case DBUS_TYPE_STRING:
     case DBUS_TYPE_OBJECT_PATH:
     case DBUS_TYPE_SIGNATURE:
-#ifdef DEBUG
-        fprintf (stderr, "string free %p\n", **(void ***)data);
-#endif
-        g_free (**(void ***)data);
-        *data = ((guchar *)*data) + dbind_gather_alloc_info (*type);
-        (*type)++;
+        plan->needs_free = TRUE;
         break;
-    case DBUS_TYPE_ARRAY: {
-        int i;
-        GArray *vals = **(void ***)data;
-        size_t elem_size, elem_align;
-        const char *saved_child_type;
-
-        (*type)++;
-        saved_child_type = *type;
-
-        elem_size = dbind_gather_alloc_info (*type);
-        elem_align = dbind_find_c_alignment_r (type); 
-
-        for (i = 0; i < vals->len; i++) {
-            void *ptr = vals->data + elem_size * i;
-            *type = saved_child_type; /* rewind type info */
-            ptr = ALIGN_ADDRESS (ptr, elem_align);
-            dbind_any_free_r (type, &ptr);
+    case DBUS_TYPE_ARRAY:
+        if (type[1] != '\0') {
+            plan->elem = compile_plan (type + 1);
+            switch (plan->elem->code) {
+            case DBIND_POD_CASES:
+                plan->fixed = TRUE;
+                break;
+            }
         }
-        g_array_free (vals, TRUE);
+        plan->needs_free = TRUE;
+        break;
+    case DBUS_STRUCT_BEGIN_CHAR:
+    case DBUS_DICT_ENTRY_BEGIN_CHAR: {
+        GPtrArray *members = g_ptr_array_new ();
+        GArray *offsets = g_array_new (FALSE, FALSE, sizeof (size_t));
+        const char *p = type + 1;
+        size_t offset = 0;
+
+        while (*p != '\0' && *p != DBUS_STRUCT_END_CHAR &&
+               *p != DBUS_DICT_ENTRY_END_CHAR) {
+            const DBindPlan *member = compile_plan (p);
+            offset = ALIGN_VALUE (offset, member->align);
+            g_ptr_array_add (members, (gpointer) member);
+            g_array_append_val (offsets, offset);
+            plan->needs_free |= member->needs_free;
+            offset += member->size;
+            p += member->length;
+        }
+        plan->n_members = members->len;
+        plan->members = (const DBindPlan **) g_ptr_array_free (members, FALSE);
+        plan->offsets = (size_t *) g_array_free (offsets, FALSE);
+        break;
+    }
+    case DBUS_TYPE_STRUCT:
+    case DBUS_TYPE_DICT_ENTRY:
+        warn_braces ();
         break;
     }
-    case DBUS_STRUCT_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
-
-        stralign = dbind_find_c_alignment (*type);
-        (*type)++;
 
-        offset = 0 ;
-        while (**type != DBUS_STRUCT_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_free_r (type, data);
-            offset += dbind_gather_alloc_info (subt);
-        }
+    g_hash_table_insert (plans_by_signature, plan->signature, plan);
+    return plan;
+}
 
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
+static const DBindPlan *
+get_plan (const char *type)
+{
+    const DBindPlan *plan;
 
-        g_assert (**type == DBUS_STRUCT_END_CHAR);
-        (*type)++;
+    G_LOCK (plans);
+    if (!plans_by_address) {
+        plans_by_address = g_hash_table_new (g_direct_hash, g_direct_equal);
+        plans_by_signature = g_hash_table_new (g_str_hash, g_str_equal);
+    }
 
-        break;
+    plan = g_hash_table_lookup (plans_by_address, type);
+    if (!plan || strncmp (type, plan->signature, plan->length) != 0) {
+        plan = compile_plan (type);
+        if (g_hash_table_size (plans_by_address) >= MAX_PLAN_ADDRESSES)
+            g_hash_table_remove_all (plans_by_address);
+        g_hash_table_insert (plans_by_address, (gpointer) type, (gpointer) plan);
     }
-    case DBUS_DICT_ENTRY_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
+    G_UNLOCK (plans);
 
-        stralign = dbind_find_c_alignment (*type);
-        (*type)++;
+    return plan;
+}
 
-        offset = 0 ;
-        while (**type != DBUS_DICT_ENTRY_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_free_r (type, data);
-            offset += dbind_gather_alloc_info (subt);
-        }
+/*---------------------------------------------------------------------------*/
 
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
+static void
+free_plan (const DBindPlan *plan, void *data)
+{
+    guint i;
 
-        g_assert (**type == DBUS_DICT_ENTRY_END_CHAR);
-        (*type)++;
+    switch (plan->code) {
+    case DBUS_TYPE_STRING:
+    case DBUS_TYPE_OBJECT_PATH:
+    case DBUS_TYPE_SIGNATURE:
+        g_free (*(void **) data);
+        break;
+    case DBUS_TYPE_ARRAY: {
+        GArray *vals = *(GArray **) data;
+        const DBindPlan *elem = plan->elem;
 
+        if (!vals)
+            break;
+        if (elem->needs_free) {
+            for (i = 0; i < vals->len; i++) {
+                void *ptr = vals->data + elem->size * i;
+                free_plan (elem, ALIGN_ADDRESS (ptr, elem->align));
+            }
+        }
+        g_array_free (vals, TRUE);
         break;
     }
-    case DBUS_TYPE_STRUCT:
-    case DBUS_TYPE_DICT_ENTRY:
-        warn_braces ();
+    case DBUS_STRUCT_BEGIN_CHAR:
+    case DBUS_DICT_ENTRY_BEGIN_CHAR:
+        for (i = 0; i < plan->n_members; i++)
+            if (plan->members[i]->needs_free)
+                free_plan (plan->members[i], PTR_PLUS (data, plan->offsets[i]));
         break;
     }
 }
 
-/*---------------------------------------------------------------------------*/
-
-void
-dbind_any_marshal (DBusMessageIter *iter,
-                   const char           **type,
-                   void           **data)
+static void
+marshal_plan (DBusMessageIter *iter, const DBindPlan *plan, void *data)
 {
-    size_t len;
+    DBusMessageIter sub;
+    guint i;
 
-#ifdef DEBUG
-    fprintf (stderr, "any marshal '%c' to %p\n", **type, *data);
-#endif
-
-    switch (**type) {
+    switch (plan->code) {
     case DBIND_POD_CASES:
     case DBUS_TYPE_STRING:
     case DBUS_TYPE_OBJECT_PATH:
     case DBUS_TYPE_SIGNATURE:
-        len = dbind_gather_alloc_info (*type);
-        dbus_message_iter_append_basic (iter, **type, *data);
-        *data = ((guchar *)*data) + len;
-        (*type)++;
+        dbus_message_iter_append_basic (iter, plan->code, data);
         break;
     case DBUS_TYPE_ARRAY: {
-        int i;
-        GArray *vals = **(void ***)data;
-        size_t elem_size, elem_align;
-        DBusMessageIter sub;
-        const char *saved_child_type;
-        char *child_type_string;
+        GArray *vals = *(GArray **) data;
+        const DBindPlan *elem = plan->elem;
 
-        (*type)++;
-        saved_child_type = *type;
-
-        elem_size = dbind_gather_alloc_info (*type);
-        elem_align = dbind_find_c_alignment_r (type); 
-
-        /* wow this part of the API sucks too ... */
-        child_type_string = g_strndup (saved_child_type, *type - saved_child_type);
-        /* fprintf (stderr, "array child type '%s'\n", child_type_string); */
         dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY,
-                                          child_type_string, &sub);
+                                          elem->signature, &sub);
+        if (plan->fixed) {
+            dbus_message_iter_append_fixed_array (&sub, elem->code,
+                                                  &vals->data, vals->len);
+            dbus_message_iter_close_container (iter, &sub);
+            break;
+        }
         for (i = 0; i < vals->len; i++) {
-            void *ptr = vals->data + elem_size * i;
-            *type = saved_child_type; /* rewind type info */
-            ptr = ALIGN_ADDRESS (ptr, elem_align);
-            dbind_any_marshal (&sub, type, &ptr);
+            void *ptr = vals->data + elem->size * i;
+            marshal_plan (&sub, elem, ALIGN_ADDRESS (ptr, elem->align));
         }
-
         dbus_message_iter_close_container (iter, &sub);
-        g_free (child_type_string);
         break;
     }
-    case DBUS_STRUCT_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
-        DBusMessageIter sub;
-
-        stralign = dbind_find_c_alignment (*type);
-
-        (*type)++;
-
-        dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &sub);
-
-        offset = 0 ;
-        while (**type != DBUS_STRUCT_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_marshal (&sub, type, data);
-            offset += dbind_gather_alloc_info (subt);
-        }
-
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
-
+    case DBUS_STRUCT_BEGIN_CHAR:
+    case DBUS_DICT_ENTRY_BEGIN_CHAR:
+        dbus_message_iter_open_container (iter,
+                                          plan->code == DBUS_STRUCT_BEGIN_CHAR ?
+                                          DBUS_TYPE_STRUCT : DBUS_TYPE_DICT_ENTRY,
+                                          NULL, &sub);
+        for (i = 0; i < plan->n_members; i++)
+            marshal_plan (&sub, plan->members[i],
+                          PTR_PLUS (data, plan->offsets[i]));
         dbus_message_iter_close_container (iter, &sub);
-
-        g_assert (**type == DBUS_STRUCT_END_CHAR);
-        (*type)++;
-
         break;
     }
-    case DBUS_DICT_ENTRY_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
-        DBusMessageIter sub;
-
-        stralign = dbind_find_c_alignment (*type);
+}
 
-        (*type)++;
+static void
+demarshal_plan (DBusMessageIter *iter, const DBindPlan *plan, void *data)
+{
+    DBusMessageIter child;
+    guint i;
 
-        dbus_message_iter_open_container (iter, DBUS_TYPE_DICT_ENTRY, NULL, &sub);
+    switch (plan->code) {
+    case DBIND_POD_CASES:
+        dbus_message_iter_get_basic (iter, data);
+        break;
+    case DBUS_TYPE_STRING:
+    case DBUS_TYPE_OBJECT_PATH:
+    case DBUS_TYPE_SIGNATURE:
+        dbus_message_iter_get_basic (iter, data);
+        *(char **) data = g_strdup (*(char **) data);
+        break;
+    case DBUS_TYPE_ARRAY: {
+        const DBindPlan *elem = plan->elem;
+        GArray *vals;
 
-        offset = 0 ;
-        while (**type != DBUS_DICT_ENTRY_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_marshal (&sub, type, data);
-            offset += dbind_gather_alloc_info (subt);
+        dbus_message_iter_recurse (iter, &child);
+        if (plan->fixed) {
+            /* The wire layout of fixed-size types matches the C one */
+            const void *values;
+            int n_values;
+
+            dbus_message_iter_get_fixed_array (&child, &values, &n_values);
+            vals = g_array_sized_new (FALSE, FALSE, elem->size, n_values);
+            g_array_append_vals (vals, values, n_values);
+            *(GArray **) data = vals;
+            break;
         }
 
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
-
-        dbus_message_iter_close_container (iter, &sub);
-
-        g_assert (**type == DBUS_DICT_ENTRY_END_CHAR);
-        (*type)++;
-
+        vals = g_array_new (FALSE, FALSE, elem->size);
+        *(GArray **) data = vals;
+        i = 0;
+        while (dbus_message_iter_get_arg_type (&child) != DBUS_TYPE_INVALID) {
+            void *ptr;
+            g_array_set_size (vals, i + 1);
+            ptr = vals->data + elem->size * i;
+            demarshal_plan (&child, elem, ALIGN_ADDRESS (ptr, elem->align));
+            i++;
+        }
         break;
     }
-    case DBUS_TYPE_STRUCT:
-    case DBUS_TYPE_DICT_ENTRY:
-        warn_braces ();
+    case DBUS_STRUCT_BEGIN_CHAR:
+    case DBUS_DICT_ENTRY_BEGIN_CHAR:
+        dbus_message_iter_recurse (iter, &child);
+        for (i = 0; i < plan->n_members; i++)
+            demarshal_plan (&child, plan->members[i],
+                            PTR_PLUS (data, plan->offsets[i]));
+        break;
+    case DBUS_TYPE_VARIANT:
+        /* skip; unimplemented for now */
         break;
     }
+    dbus_message_iter_next (iter);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void
+dbind_any_marshal (DBusMessageIter *iter,
+                   const char           **type,
+                   void           **data)
+{
+    const DBindPlan *plan;
+
+#ifdef DEBUG
+    fprintf (stderr, "any marshal '%c' to %p\n", **type, *data);
+#endif
+
+    if (**type == '\0')
+        return;
+    plan = get_plan (*type);
+    marshal_plan (iter, plan, *data);
+    *data = PTR_PLUS (*data, plan->size);
+    *type += plan->length;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -533,124 +593,43 @@ dbind_any_demarshal (DBusMessageIter *iter,
                      const char           **type,
                      void           **data)
 {
-    size_t len;
+    const DBindPlan *plan;
 
 #ifdef DEBUG
     fprintf (stderr, "any demarshal '%c' to %p\n", **type, *data);
 #endif
 
-    switch (**type) {
-    case DBIND_POD_CASES:
-        len = dbind_gather_alloc_info (*type);
-        dbus_message_iter_get_basic (iter, *data);
-        *data = ((guchar *)*data) + len;
-        (*type)++;
-        break;
-    case DBUS_TYPE_STRING:
-    case DBUS_TYPE_OBJECT_PATH:
-    case DBUS_TYPE_SIGNATURE:
-        len = dbind_gather_alloc_info (*type);
-        dbus_message_iter_get_basic (iter, *data);
-#ifdef DEBUG
-        fprintf (stderr, "dup string '%s' (%p)\n", **(void ***)data, **(void ***)data);
-#endif
-        **(void ***)data = g_strdup (**(void ***)data);
-        *data = ((guchar *)*data) + len;
-        (*type)++;
-        break;
-    case DBUS_TYPE_ARRAY: {
-        GArray *vals;
-        DBusMessageIter child;
-        size_t elem_size, elem_align;
-        const char *stored_child_type;
-        int i;
-
-        (*type)++;
-        stored_child_type = *type;
-
-        elem_size = dbind_gather_alloc_info (*type);
-        elem_align = dbind_find_c_alignment_r (type);
-        vals = g_array_new (FALSE, FALSE, elem_size);
-        (**(void ***)data) = vals;
-        *data = ((guchar *)*data) + sizeof (void *);
-
-        i = 0;
-        dbus_message_iter_recurse (iter, &child);
-        while (dbus_message_iter_get_arg_type (&child) != DBUS_TYPE_INVALID) {
-            void *ptr;
-            const char *subt = stored_child_type;
-            g_array_set_size (vals, i + 1);
-            ptr = vals->data + elem_size * i;
-            ptr = ALIGN_ADDRESS (ptr, elem_align);
-            dbind_any_demarshal (&child, &subt, &ptr);
-            i++;
-        };
-        break;
-    }
-    case DBUS_STRUCT_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
-        DBusMessageIter child;
-
-        stralign = dbind_find_c_alignment (*type);
-
-        (*type)++;
-
-        dbus_message_iter_recurse (iter, &child);
-
-        while (**type != DBUS_STRUCT_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_demarshal (&child, type, data);
-            offset += dbind_gather_alloc_info (subt);
-        }
-
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
-
-        g_assert (**type == DBUS_STRUCT_END_CHAR);
-        (*type)++;
-
-        break;
-    }
-    case DBUS_DICT_ENTRY_BEGIN_CHAR: {
-                gconstpointer data0 = *data;
-                int offset = 0, stralign;
-        DBusMessageIter child;
-
-        stralign = dbind_find_c_alignment (*type);
-
-        (*type)++;
-
-        dbus_message_iter_recurse (iter, &child);
-
-        while (**type != DBUS_DICT_ENTRY_END_CHAR) {
-            const char *subt = *type;
-                        offset = ALIGN_VALUE (offset, dbind_find_c_alignment (*type));
-                        *data = PTR_PLUS (data0, offset);
-            dbind_any_demarshal (&child, type, data);
-            offset += dbind_gather_alloc_info (subt);
-        }
+    if (**type == '\0')
+        return;
+    plan = get_plan (*type);
+    demarshal_plan (iter, plan, *data);
+    *data = PTR_PLUS (*data, plan->size);
+    *type += plan->length;
+}
 
-                offset = ALIGN_VALUE (offset, stralign);
-                *data = PTR_PLUS (data0, offset);
+/*
+ * Points @values at the elements of the array at @iter, which must hold
+ * values of the fixed-size type @element_type, and moves past it.
+ * Nothing is copied, so @values is only valid while the message is
+ * alive.  Returns FALSE, without moving, if @iter holds anything else.
+ */
+dbus_bool_t
+dbind_any_peek_fixed_array (DBusMessageIter *iter,
+                            int              element_type,
+                            const void     **values,
+                            int             *n_values)
+{
+    DBusMessageIter child;
 
-        g_assert (**type == DBUS_DICT_ENTRY_END_CHAR);
-        (*type)++;
+    if (!dbus_type_is_fixed (element_type) ||
+        dbus_message_iter_get_arg_type (iter) != DBUS_TYPE_ARRAY ||
+        dbus_message_iter_get_element_type (iter) != element_type)
+        return FALSE;
 
-        break;
-    case DBUS_TYPE_VARIANT:
-        /* skip; unimplemented for now */
-        (*type)++;
-        break;
-    }
-    case DBUS_TYPE_STRUCT:
-    case DBUS_TYPE_DICT_ENTRY:
-        warn_braces ();
-        break;
-    }
+    dbus_message_iter_recurse (iter, &child);
+    dbus_message_iter_get_fixed_array (&child, values, n_values);
     dbus_message_iter_next (iter);
+    return TRUE;
 }
 
 static const char *
@@ -667,8 +646,6 @@ pass_complex_arg (const char *p, char begin, char end)
       level--;
     p++;
   }
-  if (*p == end)
-    p++;
   return p;
 }
 
@@ -763,7 +740,8 @@ void
 dbind_any_free (const char *type,
                 void *ptr)
 {
-    dbind_any_free_r (&type, &ptr);
+    if (*type != '\0')
+        free_plan (get_plan (type), ptr);
 }
 
 /* should this be the default normalization ? */
@@ -41,6 +41,11 @@ void   dbind_any_demarshal_va  (DBusMessageIter *iter,
                                 const char           **arg_types,
                                 va_list          args);
 
+dbus_bool_t dbind_any_peek_fixed_array (DBusMessageIter *iter,
+                                        int              element_type,
+                                        const void     **values,
+                                        int             *n_values);
+
 void   dbind_any_free          (const char      *type,
                                 void            *ptr_to_ptr);
 
@@ -0,0 +1,125 @@
+#!/usr/bin/env python
+#
+# Prints a trace written by libatspi when ATSPI_TRACE is set (see
+# dbind_trace () in dbind.c): a timeline of every record, then totals per
+# method and per kind of queued message.
+#
+# Usage: dbind-trace-decode.py [--totals] [--peer NAME] trace-file
+
+import struct
+import sys
+
+MAGIC = b'DBTRACE1'
+RECORD = struct.Struct ('=HBBIqq')
+
+EVENTS = {
+    1: 'call',
+    2: 'reply',
+    3: 'error',
+    4: 'shared',
+    5: 'incoming',
+    6: 'deferred',
+    7: 'handled',
+}
+
+def read_records (f):
+    if f.read (len (MAGIC)) != MAGIC:
+        sys.exit ("dbind-trace-decode: not a dbind trace")
+    while True:
+        head = f.read (RECORD.size)
+        if len (head) < RECORD.size:
+            return
+        size, event, msg_type, serial, time, duration = RECORD.unpack (head)
+        strings = f.read (size - RECORD.size)
+        if len (strings) < size - RECORD.size:
+            return
+        peer, path, iface, member = [s.decode ('utf-8', 'replace')
+                                     for s in strings.split (b'\0') [:4]]
+        yield (EVENTS.get (event, str (event)), serial, time, duration,
+               peer, path, iface, member)
+
+class Total:
+    def __init__ (self):
+        self.count = 0
+        self.total = 0
+        self.max = 0
+
+    def add (self, duration):
+        self.count += 1
+        self.total += duration
+        self.max = max (self.max, duration)
+
+def print_totals (title, totals):
+    if not totals:
+        return
+    print ("\n%s" % title)
+    print ("%8s %12s %10s %10s  %s" % ("count", "total ms", "mean ms", "max ms",
+                                       "name"))
+    for name, t in sorted (totals.items (), key=lambda i: -i [1].total):
+        print ("%8d %12.3f %10.3f %10.3f  %s" %
+               (t.count, t.total / 1000.0, t.total / 1000.0 / t.count,
+                t.max / 1000.0, name))
+
+def main (argv):
+    totals_only = False
+    peer_filter = None
+    files = []
+    i = 0
+    while i < len (argv):
+        if argv [i] == '--totals':
+            totals_only = True
+        elif argv [i] == '--peer':
+            i += 1
+            peer_filter = argv [i]
+        else:
+            files.append (argv [i])
+        i += 1
+    if len (files) != 1:
+        sys.exit ("Usage: dbind-trace-decode.py [--totals] [--peer NAME] trace-file")
+
+    calls = {}
+    waits = {}
+    handling = {}
+    incoming = {}
+    start = None
+    outstanding = {}
+
+    with open (files [0], 'rb') as f:
+        for event, serial, time, duration, peer, path, iface, member in read_records (f):
+            if peer_filter and peer != peer_filter:
+                continue
+            if start is None:
+                start = time
+            name = "%s.%s" % (iface, member)
+            if event == 'call':
+                outstanding [(peer, serial)] = name
+            elif event in ('reply', 'error', 'shared'):
+                outstanding.pop ((peer, serial), None)
+                calls.setdefault (name if event != 'error' else name + " (failed)",
+                                  Total ()).add (duration)
+            elif event == 'deferred':
+                waits.setdefault (name, Total ()).add (duration)
+            elif event == 'handled':
+                handling.setdefault (name, Total ()).add (duration)
+            elif event == 'incoming':
+                incoming.setdefault (name, Total ()).add (0)
+
+            if not totals_only:
+                line = "%12.3f %-8s" % ((time - start) / 1000.0, event)
+                if duration:
+                    line += " %10.3f ms" % (duration / 1000.0)
+                else:
+                    line += " " * 14
+                print ("%s  %s %s %s" % (line, peer, path, name))
+
+    print_totals ("Method calls (time until reply)", calls)
+    print_totals ("Queued messages (time waiting in the queue)", waits)
+    print_totals ("Queued messages (time spent handling)", handling)
+    print_totals ("Messages received", incoming)
+    if outstanding:
+        print ("\nCalls without a recorded reply:")
+        for (peer, serial), name in sorted (outstanding.items ()):
+            print ("  %s serial %d %s" % (peer, serial, name))
+
+if __name__ == '__main__':
+    main (sys.argv [1:])
@@ -18,8 +18,8 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdarg.h>
-#include <sys/time.h>
 #include <string.h>
 #include <glib.h>
 
@@ -39,24 +39,698 @@ static int dbind_timeout = -1;
 typedef struct _SpiReentrantCallClosure 
 {
   DBusMessage *reply;
+  gchar *key;           /* set while listed in in_flight */
+  gint ref_count;
 } SpiReentrantCallClosure;
 
+/* Calls awaiting a reply that later identical calls may share, keyed by
+ * message_key () */
+static GHashTable *in_flight = NULL;
+
+static DBindSharePredicate share_predicate = NULL;
+
+static void
+closure_forget (SpiReentrantCallClosure *closure)
+{
+  if (closure->key)
+    {
+      g_hash_table_remove (in_flight, closure->key);
+      closure->key = NULL;
+    }
+}
+
+static void
+closure_unref (void *data)
+{
+  SpiReentrantCallClosure* closure = (SpiReentrantCallClosure *) data;
+
+  if (--closure->ref_count > 0)
+    return;
+  closure_forget (closure);
+  if (closure->reply)
+    dbus_message_unref (closure->reply);
+  g_free (closure);
+}
+
 static void
 set_reply (DBusPendingCall * pending, void *user_data)
 {
   SpiReentrantCallClosure* closure = (SpiReentrantCallClosure *) user_data; 
 
   closure->reply = dbus_pending_call_steal_reply (pending);
+  /* Calls made from now on must not see this (possibly stale) reply */
+  closure_forget (closure);
   dbus_pending_call_unref (pending);
 }
 
-static gint
-time_elapsed (struct timeval *origin)
+static void
+append_iter_to_key (GString *key, DBusMessageIter *iter)
+{
+  int type;
+
+  while ((type = dbus_message_iter_get_arg_type (iter)) != DBUS_TYPE_INVALID)
+    {
+      g_string_append_c (key, type);
+      if (dbus_type_is_container (type))
+        {
+          DBusMessageIter sub;
+          dbus_message_iter_recurse (iter, &sub);
+          append_iter_to_key (key, &sub);
+          g_string_append_c (key, ';');
+        }
+      else if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH ||
+               type == DBUS_TYPE_SIGNATURE)
+        {
+          const char *str;
+          dbus_message_iter_get_basic (iter, &str);
+          /* Length-prefixed, so that no string can end the key early or
+           * run into the next argument */
+          g_string_append_printf (key, "%u:%s", (guint) strlen (str), str);
+        }
+      else
+        {
+          /* Keys are hashed as C strings, so no raw bytes */
+          union { dbus_uint64_t u; double d; } val = { 0 };
+          dbus_message_iter_get_basic (iter, &val);
+          g_string_append_printf (key, "%" G_GINT64_MODIFIER "x;",
+                                  (guint64) val.u);
+        }
+      dbus_message_iter_next (iter);
+    }
+}
+
+/* Identifies a method call by destination, path, interface, member and
+ * arguments */
+static gchar *
+message_key (DBusMessage *message)
+{
+  GString *key = g_string_new (NULL);
+  DBusMessageIter iter;
+
+  g_string_append_printf (key, "%s %s %s.%s ",
+                          dbus_message_get_destination (message),
+                          dbus_message_get_path (message),
+                          dbus_message_get_interface (message),
+                          dbus_message_get_member (message));
+  dbus_message_iter_init (message, &iter);
+  append_iter_to_key (key, &iter);
+  return g_string_free (key, FALSE);
+}
+
+/**
+ * dbind_set_share_predicate:
+ *
+ * @predicate: Decides whether a method call has no side effects, or NULL.
+ *
+ * Calls for which @predicate returns TRUE may share the reply of an
+ * identical call that is still awaiting its reply, rather than being sent
+ * again.  This happens when a call re-enters the main loop and a handler
+ * dispatched meanwhile makes the same request.
+ **/
+void
+dbind_set_share_predicate (DBindSharePredicate predicate)
+{
+  share_predicate = predicate;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Tracing.  Records are appended to an in-memory buffer that is written
+ * out whenever it fills up and when the trace is closed, so recording a
+ * message costs a few copies and no system call.
+ *
+ * The file starts with TRACE_MAGIC, followed by records in host byte
+ * order, each made of a TraceRecord and then the peer (destination of
+ * calls, sender of anything received), path, interface and member as
+ * NUL-terminated strings.  dbind-trace-decode.py reads this format.
+ */
+
+#define TRACE_MAGIC "DBTRACE1"
+#define TRACE_BUFFER_SIZE (256 * 1024)
+
+typedef struct
+{
+  guint16 size;         /* of the whole record, strings included */
+  guint8 event;         /* a DBindTraceEvent */
+  guint8 message_type;
+  guint32 serial;       /* of the method call, for calls and replies */
+  gint64 time;          /* monotonic, in microseconds */
+  gint64 duration;      /* in microseconds, or 0 */
+} TraceRecord;
+
+dbus_bool_t dbind_tracing = FALSE;
+
+static FILE *trace_file;
+static gchar *trace_buffer;
+static gsize trace_used;
+
+static void
+trace_flush (void)
+{
+  if (trace_used)
+    fwrite (trace_buffer, 1, trace_used, trace_file);
+  fflush (trace_file);
+  trace_used = 0;
+}
+
+dbus_int64_t
+dbind_trace_now (void)
+{
+  return g_get_monotonic_time ();
+}
+
+/**
+ * dbind_trace_open:
+ *
+ * @filename: The file to write the trace to.
+ *
+ * Starts recording the messages sent and received to @filename.
+ **/
+dbus_bool_t
+dbind_trace_open (const char *filename)
+{
+  static gboolean registered = FALSE;
+
+  if (trace_file)
+    return TRUE;
+  trace_file = fopen (filename, "wb");
+  if (!trace_file)
+    {
+      g_warning ("dbind: cannot open trace file %s", filename);
+      return FALSE;
+    }
+  fwrite (TRACE_MAGIC, 1, strlen (TRACE_MAGIC), trace_file);
+  trace_buffer = g_malloc (TRACE_BUFFER_SIZE);
+  trace_used = 0;
+  dbind_tracing = TRUE;
+  if (!registered)
+    {
+      atexit (dbind_trace_close);
+      registered = TRUE;
+    }
+  return TRUE;
+}
+
+void
+dbind_trace_close (void)
+{
+  if (!trace_file)
+    return;
+  dbind_tracing = FALSE;
+  trace_flush ();
+  fclose (trace_file);
+  trace_file = NULL;
+  g_free (trace_buffer);
+  trace_buffer = NULL;
+}
+
+static gsize
+trace_string_size (const char *str)
+{
+  return (str ? strlen (str) : 0) + 1;
+}
+
+static gchar *
+trace_append_string (gchar *p, const char *str)
+{
+  gsize len = trace_string_size (str) - 1;
+
+  memcpy (p, (str ? str : ""), len);
+  p[len] = '\0';
+  return p + len + 1;
+}
+
+/**
+ * dbind_trace:
+ *
+ * @event:   What happened to @message.
+ * @message: The message concerned.  For replies, pass the method call.
+ * @since:   When the interval this record measures began, as returned by
+ *           dbind_trace_now (), or 0.
+ *
+ * Records an event in the trace, if one is open.  Use DBIND_TRACE () to
+ * avoid the call when tracing is off.
+ **/
+void
+dbind_trace (DBindTraceEvent event, DBusMessage *message, dbus_int64_t since)
+{
+  TraceRecord record;
+  int type = dbus_message_get_type (message);
+  const char *peer, *path, *interface, *member;
+  gsize size;
+  gchar *p;
+
+  if (!trace_file)
+    return;
+
+  if (type == DBUS_MESSAGE_TYPE_METHOD_CALL && event != DBIND_TRACE_INCOMING &&
+      event != DBIND_TRACE_DEFERRED && event != DBIND_TRACE_HANDLED)
+    peer = dbus_message_get_destination (message);
+  else
+    peer = dbus_message_get_sender (message);
+  path = dbus_message_get_path (message);
+  interface = dbus_message_get_interface (message);
+  member = dbus_message_get_member (message);
+
+  size = sizeof (record) + trace_string_size (peer) + trace_string_size (path) +
+         trace_string_size (interface) + trace_string_size (member);
+  if (size > G_MAXUINT16)
+    return;
+  if (trace_used + size > TRACE_BUFFER_SIZE)
+    trace_flush ();
+
+  record.size = size;
+  record.event = event;
+  record.message_type = type;
+  record.serial = dbus_message_get_serial (message);
+  record.time = g_get_monotonic_time ();
+  record.duration = (since ? record.time - since : 0);
+
+  p = trace_buffer + trace_used;
+  memcpy (p, &record, sizeof (record));
+  p += sizeof (record);
+  p = trace_append_string (p, peer);
+  p = trace_append_string (p, path);
+  p = trace_append_string (p, interface);
+  p = trace_append_string (p, member);
+  trace_used += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Recording and replay.  A recording holds the messages received from
+ * other processes: whatever the caller passes to dbind_record_incoming ()
+ * and the reply (or error) to every call made through
+ * dbind_send_and_allow_reentry ().  While a recording is being replayed,
+ * that function sends nothing and answers each call with the next reply
+ * recorded for an identical call, so that a session can be re-run
+ * without the applications that took part in it.
+ *
+ * The file starts with RECORD_MAGIC, followed by records made of a
+ * RecordHeader, the key of the call (for replies and errors) and the data:
+ * the message as marshalled by libdbus, or for errors the error name and
+ * message, each NUL-terminated.
+ */
+
+#define RECORD_MAGIC "DBREC001"
+
+enum
+{
+  RECORD_INCOMING = 1,
+  RECORD_REPLY = 2,
+  RECORD_ERROR = 3
+};
+
+typedef struct
+{
+  guint32 kind;
+  guint32 key_size;
+  guint32 data_size;
+  guint32 reserved;
+} RecordHeader;
+
+typedef struct
+{
+  DBusMessage *reply;
+  gchar *error_name;
+  gchar *error_message;
+} ReplayReply;
+
+dbus_bool_t dbind_recording = FALSE;
+
+static FILE *record_file;
+
+/* call key -> GQueue of ReplayReply, while replaying */
+static GHashTable *replay_replies;
+static GQueue *replay_incoming;
+
+static void
+record_write (guint32 kind, const gchar *key, const char *data, gsize size)
+{
+  RecordHeader header = { kind, (key ? strlen (key) : 0), size, 0 };
+
+  fwrite (&header, sizeof (header), 1, record_file);
+  if (key)
+    fwrite (key, 1, header.key_size, record_file);
+  fwrite (data, 1, size, record_file);
+}
+
+static void
+record_message (guint32 kind, const gchar *key, DBusMessage *message)
+{
+  char *data;
+  int size;
+
+  if (!dbus_message_marshal (message, &data, &size))
+    return;
+  record_write (kind, key, data, size);
+  dbus_free (data);
+}
+
+static void
+record_error (const gchar *key, const DBusError *error)
+{
+  GString *data = g_string_new (error->name);
+
+  g_string_append_c (data, '\0');
+  g_string_append (data, (error->message ? error->message : ""));
+  g_string_append_c (data, '\0');
+  record_write (RECORD_ERROR, key, data->str, data->len);
+  g_string_free (data, TRUE);
+}
+
+/**
+ * dbind_record_open:
+ *
+ * @filename: The file to record to.
+ *
+ * Starts recording the replies to calls made through dbind, and the
+ * messages passed to dbind_record_incoming (), to @filename.
+ **/
+dbus_bool_t
+dbind_record_open (const char *filename)
+{
+  static gboolean registered = FALSE;
+
+  if (record_file)
+    return TRUE;
+  record_file = fopen (filename, "wb");
+  if (!record_file)
+    {
+      g_warning ("dbind: cannot open recording %s", filename);
+      return FALSE;
+    }
+  fwrite (RECORD_MAGIC, 1, strlen (RECORD_MAGIC), record_file);
+  dbind_recording = TRUE;
+  if (!registered)
+    {
+      atexit (dbind_record_close);
+      registered = TRUE;
+    }
+  return TRUE;
+}
+
+void
+dbind_record_close (void)
+{
+  if (!record_file)
+    return;
+  dbind_recording = FALSE;
+  fclose (record_file);
+  record_file = NULL;
+}
+
+void
+dbind_record_incoming (DBusMessage *message)
+{
+  if (record_file)
+    record_message (RECORD_INCOMING, NULL, message);
+}
+
+static void
+replay_reply_free (gpointer data)
 {
-  struct timeval tv;
+  ReplayReply *reply = data;
+
+  if (reply->reply)
+    dbus_message_unref (reply->reply);
+  g_free (reply->error_name);
+  g_free (reply->error_message);
+  g_free (reply);
+}
 
-  gettimeofday (&tv, NULL);
-  return (tv.tv_sec - origin->tv_sec) * 1000 + (tv.tv_usec - origin->tv_usec) / 1000;
+static void
+replay_queue_free (gpointer data)
+{
+  g_queue_free_full (data, replay_reply_free);
+}
+
+static void
+replay_add_reply (gchar *key, ReplayReply *reply)
+{
+  GQueue *queue = g_hash_table_lookup (replay_replies, key);
+
+  if (!queue)
+    {
+      queue = g_queue_new ();
+      g_hash_table_insert (replay_replies, key, queue);
+    }
+  else
+    g_free (key);
+  g_queue_push_tail (queue, reply);
+}
+
+/**
+ * dbind_replay_open:
+ *
+ * @filename: A file written by dbind_record_open ().
+ *
+ * Makes calls through dbind return the replies recorded in @filename
+ * instead of going out on the bus.  The recorded incoming messages can
+ * then be fetched in order with dbind_replay_next_incoming ().
+ **/
+dbus_bool_t
+dbind_replay_open (const char *filename)
+{
+  gchar *contents, *p, *end;
+  gsize length;
+  GError *error = NULL;
+
+  if (!g_file_get_contents (filename, &contents, &length, &error))
+    {
+      g_warning ("dbind: cannot read recording: %s", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+  if (length < strlen (RECORD_MAGIC) ||
+      memcmp (contents, RECORD_MAGIC, strlen (RECORD_MAGIC)) != 0)
+    {
+      g_warning ("dbind: %s is not a recording", filename);
+      g_free (contents);
+      return FALSE;
+    }
+
+  dbind_replay_close ();
+  replay_replies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                          replay_queue_free);
+  replay_incoming = g_queue_new ();
+
+  p = contents + strlen (RECORD_MAGIC);
+  end = contents + length;
+  while (p + sizeof (RecordHeader) <= end)
+    {
+      RecordHeader header;
+      gchar *key;
+      const char *data;
+      ReplayReply *reply;
+
+      memcpy (&header, p, sizeof (header));
+      p += sizeof (header);
+      if (header.key_size > end - p || header.data_size > end - p - header.key_size)
+        {
+          g_warning ("dbind: recording %s is truncated", filename);
+          break;
+        }
+      key = g_strndup (p, header.key_size);
+      data = p + header.key_size;
+      p += header.key_size + header.data_size;
+
+      switch (header.kind)
+        {
+        case RECORD_INCOMING:
+          {
+            DBusMessage *message = dbus_message_demarshal (data, header.data_size,
+                                                           NULL);
+            if (message)
+              g_queue_push_tail (replay_incoming, message);
+            g_free (key);
+          }
+          break;
+        case RECORD_REPLY:
+          reply = g_new0 (ReplayReply, 1);
+          reply->reply = dbus_message_demarshal (data, header.data_size, NULL);
+          replay_add_reply (key, reply);
+          break;
+        case RECORD_ERROR:
+          reply = g_new0 (ReplayReply, 1);
+          reply->error_name = g_strndup (data, header.data_size);
+          reply->error_message = g_strndup (data + strlen (reply->error_name) + 1,
+                                            header.data_size - strlen (reply->error_name) - 1);
+          replay_add_reply (key, reply);
+          break;
+        default:
+          g_free (key);
+          break;
+        }
+    }
+
+  g_free (contents);
+  return TRUE;
+}
+
+void
+dbind_replay_close (void)
+{
+  if (replay_replies)
+    {
+      g_hash_table_destroy (replay_replies);
+      replay_replies = NULL;
+    }
+  if (replay_incoming)
+    {
+      g_queue_free_full (replay_incoming, (GDestroyNotify) dbus_message_unref);
+      replay_incoming = NULL;
+    }
+}
+
+/**
+ * dbind_replay_next_incoming:
+ *
+ * Returns: (transfer full): the next message recorded as incoming, or
+ *          NULL once there are none left.
+ **/
+DBusMessage *
+dbind_replay_next_incoming (void)
+{
+  return (replay_incoming ? g_queue_pop_head (replay_incoming) : NULL);
+}
+
+/* Answers @message from the recording being replayed */
+static DBusMessage *
+replay_call (DBusMessage *message, DBusError *error)
+{
+  gchar *key = message_key (message);
+  GQueue *queue = g_hash_table_lookup (replay_replies, key);
+  ReplayReply *reply;
+  gboolean last;
+
+  g_free (key);
+  if (!queue || g_queue_is_empty (queue))
+    {
+      dbus_set_error (error, "org.freedesktop.DBus.Error.NoReply",
+                      "dbind: no recorded reply to %s.%s",
+                      dbus_message_get_interface (message),
+                      dbus_message_get_member (message));
+      return NULL;
+    }
+
+  /* If the call is made more often than it was recorded, keep giving the
+   * last reply */
+  last = (queue->length == 1);
+  reply = (last ? g_queue_peek_head (queue) : g_queue_pop_head (queue));
+  if (reply->error_name)
+    {
+      dbus_set_error (error, reply->error_name, "%s", reply->error_message);
+      message = NULL;
+    }
+  else
+    message = (reply->reply ? dbus_message_ref (reply->reply) : NULL);
+  if (!last)
+    replay_reply_free (reply);
+  return message;
+}
+
+/* Records the outcome of a call made through dbind_send_and_allow_reentry */
+static void
+record_call (DBusMessage *message, DBusMessage *reply, DBusError *error)
+{
+  gchar *key;
+
+  if (!reply && !(error && dbus_error_is_set (error)))
+    return;
+  key = message_key (message);
+  if (reply)
+    record_message (RECORD_REPLY, key, reply);
+  else
+    record_error (key, error);
+  g_free (key);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Waiting.  Calls to other peers block in libdbus, which polls for the
+ * reply alone and leaves everything else queued.  Calls that our own
+ * connection has to answer cannot work that way: incoming messages must
+ * keep being dispatched until the reply turns up, so for those we poll
+ * the connection against a monotonic deadline.
+ *
+ * In strict sync mode nothing queued while blocking is dispatched on the
+ * caller's stack afterwards; it waits for the main loop instead.
+ */
+
+static dbus_bool_t strict_sync = FALSE;
+
+static DBindWaitFunction wait_function = NULL;
+
+typedef enum
+{
+  WAIT_REPLY,
+  WAIT_DISCONNECTED,
+  WAIT_TIMEOUT
+} WaitResult;
+
+/* Monotonic time, in microseconds, at which a wait gives up, or -1 */
+static gint64
+deadline_after (int timeout)
+{
+  if (timeout < 0)
+    return -1;
+  return g_get_monotonic_time () + (gint64) timeout * 1000;
+}
+
+static WaitResult
+wait_for_reply (DBusConnection *bus, SpiReentrantCallClosure *closure,
+                gint64 deadline)
+{
+  while (!closure->reply)
+    {
+      int remaining = -1;
+
+      if (deadline >= 0)
+        {
+          gint64 now = g_get_monotonic_time ();
+
+          if (now >= deadline)
+            return WAIT_TIMEOUT;
+          /* Rounded up, so that the poll does not wake just short of it */
+          remaining = (deadline - now + 999) / 1000;
+        }
+      if (wait_function)
+        {
+          if (!wait_function (bus, remaining))
+            return WAIT_DISCONNECTED;
+        }
+      else if (!dbus_connection_read_write_dispatch (bus, remaining))
+        return WAIT_DISCONNECTED;
+    }
+  return WAIT_REPLY;
+}
+
+/* Waits for the reply to a call made further up the stack */
+static DBusMessage *
+wait_for_shared_reply (DBusConnection *bus, SpiReentrantCallClosure *closure,
+                       DBusError *error)
+{
+  DBusMessage *ret = NULL;
+
+  closure->ref_count++;
+  switch (wait_for_reply (bus, closure, deadline_after (dbind_timeout)))
+    {
+    case WAIT_REPLY:
+      ret = dbus_message_ref (closure->reply);
+      break;
+    case WAIT_TIMEOUT:
+      dbus_set_error_const (error, "org.freedesktop.DBus.Error.NoReply",
+                            "timeout from dbind");
+      break;
+    case WAIT_DISCONNECTED:
+      break;
+    }
+  closure_unref (closure);
+  return ret;
 }
 
 DBusMessage *
@@ -66,16 +740,26 @@ dbind_send_and_allow_reentry (DBusConnection * bus, DBusMessage * message, DBusE
   SpiReentrantCallClosure *closure;
   const char *unique_name = dbus_bus_get_unique_name (bus);
   const char *destination = dbus_message_get_destination (message);
-  struct timeval tv;
+  WaitResult result;
   DBusMessage *ret;
   static gboolean in_dispatch = FALSE;
+  gchar *key = NULL;
+  dbus_int64_t start = (dbind_tracing ? dbind_trace_now () : 0);
+
+  if (replay_replies)
+    return replay_call (message, error);
 
   if (unique_name && destination &&
       strcmp (destination, unique_name) != 0)
     {
       ret = dbus_connection_send_with_reply_and_block (bus, message,
                                                        dbind_timeout, error);
-      if (g_main_depth () == 0 && !in_dispatch)
+      if (dbind_recording)
+        record_call (message, ret, error);
+      /* The serial is only known once sent, so log the call afterwards */
+      DBIND_TRACE (DBIND_TRACE_CALL, message, 0);
+      DBIND_TRACE (ret ? DBIND_TRACE_REPLY : DBIND_TRACE_ERROR, message, start);
+      if (!strict_sync && g_main_depth () == 0 && !in_dispatch)
       {
         in_dispatch = TRUE;
         while (dbus_connection_dispatch (bus) == DBUS_DISPATCH_DATA_REMAINS);
@@ -84,41 +768,71 @@ dbind_send_and_allow_reentry (DBusConnection * bus, DBusMessage * message, DBusE
       return ret;
     }
 
+  if (share_predicate && share_predicate (message))
+    {
+      key = message_key (message);
+      closure = (in_flight ? g_hash_table_lookup (in_flight, key) : NULL);
+      if (closure)
+        {
+          g_free (key);
+          ret = wait_for_shared_reply (bus, closure, error);
+          if (dbind_recording)
+            record_call (message, ret, error);
+          DBIND_TRACE (ret ? DBIND_TRACE_SHARED : DBIND_TRACE_ERROR, message,
+                       start);
+          return ret;
+        }
+    }
+
   closure = g_new0 (SpiReentrantCallClosure, 1);
   closure->reply = NULL;
   if (!dbus_connection_send_with_reply (bus, message, &pending, dbind_timeout)
       || !pending)
     {
       g_free (closure);
+      g_free (key);
       return NULL;
     }
-  dbus_pending_call_set_notify (pending, set_reply, (void *) closure, g_free);
+  /* One reference for the pending call, one for us */
+  closure->ref_count = 2;
+  if (key)
+    {
+      if (!in_flight)
+        in_flight = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                           NULL);
+      closure->key = key;
+      g_hash_table_insert (in_flight, key, closure);
+    }
+  dbus_pending_call_set_notify (pending, set_reply, (void *) closure,
+                                closure_unref);
+  DBIND_TRACE (DBIND_TRACE_CALL, message, 0);
 
-  closure->reply = NULL;
-  gettimeofday (&tv, NULL);
   dbus_pending_call_ref (pending);
-  while (!closure->reply)
+  result = wait_for_reply (bus, closure, deadline_after (dbind_timeout));
+  if (result != WAIT_REPLY)
     {
-      if (!dbus_connection_read_write_dispatch (bus, dbind_timeout))
-        {
-          //dbus_pending_call_set_notify (pending, NULL, NULL, NULL);
-          dbus_pending_call_cancel (pending);
-          dbus_pending_call_unref (pending);
-          return NULL;
-        }
-      if (time_elapsed (&tv) > dbind_timeout)
+      closure_forget (closure);
+      dbus_pending_call_cancel (pending);
+      dbus_pending_call_unref (pending);
+      closure_unref (closure);
+      if (result == WAIT_TIMEOUT)
         {
-          //dbus_pending_call_set_notify (pending, NULL, NULL, NULL);
-          dbus_pending_call_cancel (pending);
-          dbus_pending_call_unref (pending);
           dbus_set_error_const (error, "org.freedesktop.DBus.Error.NoReply",
                                 "timeout from dbind");
-          return NULL;
+          if (dbind_recording)
+            record_call (message, NULL, error);
         }
+      DBIND_TRACE (DBIND_TRACE_ERROR, message, start);
+      return NULL;
     }
-  
-  ret = closure->reply;
+
+  ret = dbus_message_ref (closure->reply);
+  if (dbind_recording)
+    record_call (message, ret, error);
+  DBIND_TRACE (dbus_message_get_type (ret) == DBUS_MESSAGE_TYPE_ERROR ?
+               DBIND_TRACE_ERROR : DBIND_TRACE_REPLY, message, start);
   dbus_pending_call_unref (pending);
+  closure_unref (closure);
   return ret;
 }
 
@@ -317,5 +1031,41 @@ dbind_set_timeout (int timeout)
   dbind_timeout = timeout;
 }
 
+/**
+ * dbind_set_strict_sync:
+ *
+ * @strict: Whether to leave queued messages to the main loop.
+ *
+ * Normally, once a blocking call outside any main loop has its reply,
+ * the messages that arrived meanwhile are dispatched before returning.
+ * In strict mode they stay queued until the main loop dispatches them,
+ * so no handler runs on the caller's stack.  Calls to our own connection
+ * are the exception: they cannot be answered without dispatching.
+ **/
+void
+dbind_set_strict_sync (dbus_bool_t strict)
+{
+  strict_sync = strict;
+}
+
+/**
+ * dbind_set_wait_function:
+ *
+ * @func: Replacement for dbus_connection_read_write_dispatch, or NULL.
+ *
+ * While waiting for a reply that needs incoming messages dispatched,
+ * @func is called instead of dbus_connection_read_write_dispatch.  It
+ * must dispatch a queued message if there is one, and otherwise wait at
+ * most the given number of milliseconds (-1 for no limit) for more to
+ * arrive, returning FALSE once the connection is gone.  This is for
+ * connections that another thread reads from, since two threads polling
+ * the same socket can each miss what the other has read.
+ **/
+void
+dbind_set_wait_function (DBindWaitFunction func)
+{
+  wait_function = func;
+}
+
 
 /*END------------------------------------------------------------------------*/
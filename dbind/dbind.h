@@ -24,6 +24,28 @@
 #include <dbus/dbus.h>
 #include <dbind/dbind-any.h>
 
+typedef dbus_bool_t (*DBindSharePredicate) (DBusMessage *message);
+
+typedef dbus_bool_t (*DBindWaitFunction) (DBusConnection *bus, int timeout);
+
+/* Kinds of trace record; the numbers are part of the file format */
+typedef enum
+{
+  DBIND_TRACE_CALL = 1,     /* method call sent */
+  DBIND_TRACE_REPLY = 2,    /* reply received; duration is the round trip */
+  DBIND_TRACE_ERROR = 3,    /* error or no reply; duration is the wait */
+  DBIND_TRACE_SHARED = 4,   /* answered with the reply of an identical call */
+  DBIND_TRACE_INCOMING = 5, /* signal or method call received */
+  DBIND_TRACE_DEFERRED = 6, /* queued message dispatched; duration is the wait */
+  DBIND_TRACE_HANDLED = 7   /* queued message handled; duration is the work */
+} DBindTraceEvent;
+
+extern dbus_bool_t dbind_tracing;
+
+/* Costs one test when tracing is off */
+#define DBIND_TRACE(event, message, since) \
+  do { if (dbind_tracing) dbind_trace ((event), (message), (since)); } while (0)
+
 DBusMessage *
 dbind_send_and_allow_reentry (DBusConnection *bus, DBusMessage *message, DBusError *error);
 
@@ -66,4 +88,33 @@ dbind_emit_signal (DBusConnection *cnx,
                    ...);
 
 void dbind_set_timeout (int timeout);
+
+void dbind_set_strict_sync (dbus_bool_t strict);
+
+void dbind_set_wait_function (DBindWaitFunction func);
+
+void dbind_set_share_predicate (DBindSharePredicate predicate);
+
+dbus_int64_t dbind_trace_now (void);
+
+dbus_bool_t dbind_trace_open (const char *filename);
+
+void dbind_trace_close (void);
+
+void dbind_trace (DBindTraceEvent event, DBusMessage *message,
+                  dbus_int64_t since);
+
+extern dbus_bool_t dbind_recording;
+
+dbus_bool_t dbind_record_open (const char *filename);
+
+void dbind_record_close (void);
+
+void dbind_record_incoming (DBusMessage *message);
+
+dbus_bool_t dbind_replay_open (const char *filename);
+
+void dbind_replay_close (void);
+
+DBusMessage *dbind_replay_next_incoming (void);
 #endif /* _DBIND_H_ */
@@ -18,6 +18,8 @@
  */
 
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
 #include <glib.h>
 #include <string.h>
 #include <dbind/dbind.h>
@@ -115,6 +117,32 @@ void test_array ()
     g_array_free (a1, TRUE);
 
     dbind_any_free ("ai", &a2);
+
+    /* borrowed view of the same array */
+    {
+        DBusMessageIter iter;
+        const dbus_int32_t *vals;
+        int n_vals;
+
+        dbus_message_iter_init (msg, &iter);
+        g_assert (!dbind_any_peek_fixed_array (&iter, DBUS_TYPE_UINT32,
+                                               (const void **) &vals, &n_vals));
+        g_assert (dbind_any_peek_fixed_array (&iter, DBUS_TYPE_INT32,
+                                              (const void **) &vals, &n_vals));
+        g_assert (n_vals == 4);
+        g_assert (vals[0] == 42 && vals[3] == 38);
+        g_assert (dbus_message_iter_get_arg_type (&iter) == DBUS_TYPE_INVALID);
+    }
+    dbus_message_unref (msg);
+
+    /* empty arrays take the same path */
+    a1 = g_array_new (FALSE, FALSE, sizeof (double));
+    msg = dbus_message_new (DBUS_MESSAGE_TYPE_METHOD_CALL);
+    marshal (msg, "ad", &a1);
+    demarshal (msg, "ad", &a2);
+    g_assert (a2 != NULL && a2->len == 0);
+    g_array_free (a1, TRUE);
+    dbind_any_free ("ad", &a2);
     dbus_message_unref (msg);
 
     fprintf (stderr, "array ok\n");
@@ -358,6 +386,431 @@ void test_marshalling ()
     fprintf (stderr, "Marshalling ok\n");
 }
 
+/*
+ * Randomized round trips: build a message with a random signature and
+ * random contents through libdbus, demarshal it with dbind, marshal the
+ * result into a second message and check the two are identical.
+ */
+
+static const char basic_types[] = "ybnqiuxtdsog";
+
+static void
+random_type (GRand *rand, GString *sig, int depth)
+{
+    int choice = g_rand_int_range (rand, 0, depth > 0 ? 6 : 1);
+    int i, n;
+
+    switch (choice) {
+    case 0:
+    case 1:
+    case 2:
+        g_string_append_c (sig, basic_types[g_rand_int_range (rand, 0, strlen (basic_types))]);
+        break;
+    case 3:
+        g_string_append_c (sig, 'a');
+        random_type (rand, sig, depth - 1);
+        break;
+    case 4:
+        g_string_append_c (sig, '(');
+        n = g_rand_int_range (rand, 1, 5);
+        for (i = 0; i < n; i++)
+            random_type (rand, sig, depth - 1);
+        g_string_append_c (sig, ')');
+        break;
+    case 5:
+        g_string_append (sig, "a{");
+        g_string_append_c (sig, basic_types[g_rand_int_range (rand, 0, strlen (basic_types))]);
+        random_type (rand, sig, depth - 1);
+        g_string_append_c (sig, '}');
+        break;
+    }
+}
+
+/* Returns the end of the complete type starting at @p */
+static const char *
+skip_type (const char *p)
+{
+    int level = 0;
+
+    while (*p == 'a')
+        p++;
+    if (*p != '(' && *p != '{')
+        return p + 1;
+    do {
+        if (*p == '(' || *p == '{')
+            level++;
+        else if (*p == ')' || *p == '}')
+            level--;
+        p++;
+    } while (level > 0);
+    return p;
+}
+
+static void
+random_value (GRand *rand, DBusMessageIter *iter, const char **sig)
+{
+    const char *p = *sig;
+    DBusMessageIter sub;
+    char *str;
+    int i, n;
+
+    switch (*p) {
+    case DBUS_TYPE_BYTE: {
+        unsigned char v = g_rand_int (rand);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_BOOLEAN: {
+        dbus_bool_t v = g_rand_boolean (rand);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_INT16:
+    case DBUS_TYPE_UINT16: {
+        dbus_uint16_t v = g_rand_int (rand);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_INT32:
+    case DBUS_TYPE_UINT32: {
+        dbus_uint32_t v = g_rand_int (rand);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_INT64:
+    case DBUS_TYPE_UINT64: {
+        dbus_uint64_t v = ((dbus_uint64_t) g_rand_int (rand) << 32) | g_rand_int (rand);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_DOUBLE: {
+        double v = g_rand_double_range (rand, -1e6, 1e6);
+        dbus_message_iter_append_basic (iter, *p, &v);
+        break;
+    }
+    case DBUS_TYPE_STRING:
+        str = g_strdup_printf ("string %u", g_rand_int (rand));
+        dbus_message_iter_append_basic (iter, *p, &str);
+        g_free (str);
+        break;
+    case DBUS_TYPE_OBJECT_PATH:
+        str = g_strdup_printf ("/org/a11y/atspi/accessible/%u", g_rand_int (rand));
+        dbus_message_iter_append_basic (iter, *p, &str);
+        g_free (str);
+        break;
+    case DBUS_TYPE_SIGNATURE:
+        str = g_rand_boolean (rand) ? "a(so)" : "";
+        dbus_message_iter_append_basic (iter, *p, &str);
+        break;
+    case DBUS_TYPE_ARRAY: {
+        const char *elem = p + 1;
+        char *elem_sig = g_strndup (elem, skip_type (elem) - elem);
+
+        dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, elem_sig, &sub);
+        n = g_rand_int_range (rand, 0, 5);
+        for (i = 0; i < n; i++) {
+            const char *q = elem;
+            random_value (rand, &sub, &q);
+        }
+        dbus_message_iter_close_container (iter, &sub);
+        g_free (elem_sig);
+        break;
+    }
+    case DBUS_STRUCT_BEGIN_CHAR:
+    case DBUS_DICT_ENTRY_BEGIN_CHAR: {
+        const char *q = p + 1;
+
+        dbus_message_iter_open_container (iter,
+                                          *p == DBUS_STRUCT_BEGIN_CHAR ?
+                                          DBUS_TYPE_STRUCT : DBUS_TYPE_DICT_ENTRY,
+                                          NULL, &sub);
+        while (*q != DBUS_STRUCT_END_CHAR && *q != DBUS_DICT_ENTRY_END_CHAR)
+            random_value (rand, &sub, &q);
+        dbus_message_iter_close_container (iter, &sub);
+        break;
+    }
+    }
+    *sig = skip_type (p);
+}
+
+static gboolean
+iters_equal (DBusMessageIter *a, DBusMessageIter *b)
+{
+    for (;;) {
+        int type = dbus_message_iter_get_arg_type (a);
+        DBusMessageIter sub_a, sub_b;
+
+        if (type != dbus_message_iter_get_arg_type (b))
+            return FALSE;
+        if (type == DBUS_TYPE_INVALID)
+            return TRUE;
+
+        if (dbus_type_is_container (type)) {
+            dbus_message_iter_recurse (a, &sub_a);
+            dbus_message_iter_recurse (b, &sub_b);
+            if (!iters_equal (&sub_a, &sub_b))
+                return FALSE;
+        } else if (type == DBUS_TYPE_STRING || type == DBUS_TYPE_OBJECT_PATH ||
+                   type == DBUS_TYPE_SIGNATURE) {
+            const char *str_a, *str_b;
+            dbus_message_iter_get_basic (a, &str_a);
+            dbus_message_iter_get_basic (b, &str_b);
+            if (strcmp (str_a, str_b) != 0)
+                return FALSE;
+        } else {
+            dbus_uint64_t val_a = 0, val_b = 0;
+            dbus_message_iter_get_basic (a, &val_a);
+            dbus_message_iter_get_basic (b, &val_b);
+            if (val_a != val_b)
+                return FALSE;
+        }
+        dbus_message_iter_next (a);
+        dbus_message_iter_next (b);
+    }
+}
+
+void test_random_round_trip (guint32 seed, int count)
+{
+    GRand *rand = g_rand_new_with_seed (seed);
+    GString *sig = g_string_new (NULL);
+    int i, j, n;
+
+    for (i = 0; i < count; i++) {
+        DBusMessage *in, *out;
+        DBusMessageIter iter, in_iter, out_iter;
+        const char *p;
+
+        g_string_truncate (sig, 0);
+        n = g_rand_int_range (rand, 1, 4);
+        for (j = 0; j < n; j++)
+            random_type (rand, sig, 3);
+
+        in = dbus_message_new (DBUS_MESSAGE_TYPE_METHOD_CALL);
+        dbus_message_iter_init_append (in, &iter);
+        p = sig->str;
+        while (*p)
+            random_value (rand, &iter, &p);
+
+        /* demarshal each argument and marshal it straight back */
+        out = dbus_message_new (DBUS_MESSAGE_TYPE_METHOD_CALL);
+        dbus_message_iter_init (in, &in_iter);
+        dbus_message_iter_init_append (out, &out_iter);
+        p = sig->str;
+        while (*p) {
+            guint64 buf[256];
+            const char *arg_start = p, *type;
+            char *arg_type;
+            void *ptr;
+
+            p = skip_type (p);
+            arg_type = g_strndup (arg_start, p - arg_start);
+            memset (buf, 0, sizeof (buf));
+            type = arg_type;
+            ptr = buf;
+            dbind_any_demarshal (&in_iter, &type, &ptr);
+            g_assert (*type == '\0');
+            type = arg_type;
+            ptr = buf;
+            dbind_any_marshal (&out_iter, &type, &ptr);
+            g_assert (*type == '\0');
+            dbind_any_free (arg_type, buf);
+            g_free (arg_type);
+        }
+
+        if (strcmp (dbus_message_get_signature (in),
+                    dbus_message_get_signature (out)) != 0) {
+            fprintf (stderr, "round trip of '%s' gave '%s' (seed %u)\n", sig->str,
+                     dbus_message_get_signature (out), seed);
+            g_assert_not_reached ();
+        }
+        dbus_message_iter_init (in, &in_iter);
+        dbus_message_iter_init (out, &out_iter);
+        if (!iters_equal (&in_iter, &out_iter)) {
+            fprintf (stderr, "round trip of '%s' changed its contents (seed %u)\n",
+                     sig->str, seed);
+            g_assert_not_reached ();
+        }
+
+        dbus_message_unref (in);
+        dbus_message_unref (out);
+    }
+
+    g_string_free (sig, TRUE);
+    g_rand_free (rand);
+    fprintf (stderr, "%d random round trips ok\n", count);
+}
+
+/*
+ * Throughput of the va_list entry points for the signatures libatspi
+ * uses most, run with --bench.
+ */
+
+typedef struct {
+    char *name;
+    char *path;
+} Reference;
+
+typedef struct {
+    char *key;
+    char *value;
+} StringPair;
+
+typedef struct {
+    dbus_int32_t x, y, width, height;
+} Extents;
+
+static void
+marshal_va (DBusMessage *msg, const char *type, ...)
+{
+    DBusMessageIter iter;
+    va_list args;
+
+    va_start (args, type);
+    dbus_message_iter_init_append (msg, &iter);
+    dbind_any_marshal_va (&iter, &type, args);
+    va_end (args);
+}
+
+static void
+demarshal_va (DBusMessage *msg, const char *type, ...)
+{
+    DBusMessageIter iter;
+    va_list args;
+
+    va_start (args, type);
+    dbus_message_iter_init (msg, &iter);
+    dbind_any_demarshal_va (&iter, &type, args);
+    va_end (args);
+}
+
+typedef enum {
+    BENCH_STRING,
+    BENCH_MATCH_RULE,
+    BENCH_UINT_ARRAY,
+    BENCH_REFERENCES,
+    BENCH_DICT,
+    BENCH_EXTENTS,
+    N_BENCHES
+} Bench;
+
+static const char *bench_names[] = {
+    "=>s", "match rule", "=>au", "=>a(so)", "=>a{ss}", "=>(iiii)"
+};
+
+/* The in-argument and reply signatures of each benchmark */
+static const char *bench_types[] = {
+    "s", "s", "au", "a(so)", "a{ss}", "(iiii)"
+};
+
+static const char *match_rule =
+    "type='signal',interface='org.a11y.atspi.Event.Object',member='StateChanged'";
+
+void bench_marshalling (int iterations)
+{
+    GArray *uints, *refs, *pairs;
+    Extents extents = { 10, 20, 300, 40 };
+    char *str = "push button";
+    int bench, i;
+
+    uints = g_array_new (FALSE, FALSE, sizeof (dbus_uint32_t));
+    for (i = 0; i < 64; i++) {
+        dbus_uint32_t v = i * 7919;
+        g_array_append_val (uints, v);
+    }
+    refs = g_array_new (FALSE, FALSE, sizeof (Reference));
+    for (i = 0; i < 32; i++) {
+        Reference r;
+        r.name = ":1.42";
+        r.path = g_strdup_printf ("/org/a11y/atspi/accessible/%d", i);
+        g_array_append_val (refs, r);
+    }
+    pairs = g_array_new (FALSE, FALSE, sizeof (StringPair));
+    for (i = 0; i < 16; i++) {
+        StringPair pair;
+        pair.key = g_strdup_printf ("attribute-%d", i);
+        pair.value = g_strdup_printf ("value %d", i);
+        g_array_append_val (pairs, pair);
+    }
+
+    for (bench = 0; bench < N_BENCHES; bench++) {
+        const char *type = bench_types[bench];
+        char *reply_type = g_strconcat ("=>", type, NULL);
+        gint64 start, marshal_time, demarshal_time;
+        DBusMessage *msg = NULL;
+
+        start = g_get_monotonic_time ();
+        for (i = 0; i < iterations; i++) {
+            if (msg)
+                dbus_message_unref (msg);
+            msg = dbus_message_new (DBUS_MESSAGE_TYPE_METHOD_CALL);
+            switch (bench) {
+            case BENCH_STRING:
+                marshal_va (msg, type, str);
+                break;
+            case BENCH_MATCH_RULE:
+                marshal_va (msg, type, match_rule);
+                break;
+            case BENCH_UINT_ARRAY:
+                marshal_va (msg, type, uints);
+                break;
+            case BENCH_REFERENCES:
+                marshal_va (msg, type, refs);
+                break;
+            case BENCH_DICT:
+                marshal_va (msg, type, pairs);
+                break;
+            case BENCH_EXTENTS:
+                marshal_va (msg, type, &extents);
+                break;
+            }
+        }
+        marshal_time = g_get_monotonic_time () - start;
+
+        start = g_get_monotonic_time ();
+        for (i = 0; i < iterations; i++) {
+            char *str_out;
+            GArray *array_out;
+            Extents extents_out;
+
+            switch (bench) {
+            case BENCH_STRING:
+            case BENCH_MATCH_RULE:
+                demarshal_va (msg, reply_type, &str_out);
+                g_free (str_out);
+                break;
+            case BENCH_UINT_ARRAY:
+            case BENCH_REFERENCES:
+            case BENCH_DICT:
+                demarshal_va (msg, reply_type, &array_out);
+                dbind_any_free_ptr (type, array_out);
+                break;
+            case BENCH_EXTENTS:
+                demarshal_va (msg, reply_type, &extents_out);
+                g_assert (extents_out.height == 40);
+                break;
+            }
+        }
+        demarshal_time = g_get_monotonic_time () - start;
+
+        fprintf (stderr, "%-12s marshal %9.1f ns  demarshal %9.1f ns\n",
+                 bench_names[bench],
+                 marshal_time * 1000.0 / iterations,
+                 demarshal_time * 1000.0 / iterations);
+        dbus_message_unref (msg);
+        g_free (reply_type);
+    }
+
+    g_array_free (uints, TRUE);
+    for (i = 0; i < refs->len; i++)
+        g_free (g_array_index (refs, Reference, i).path);
+    g_array_free (refs, TRUE);
+    for (i = 0; i < pairs->len; i++) {
+        g_free (g_array_index (pairs, StringPair, i).key);
+        g_free (g_array_index (pairs, StringPair, i).value);
+    }
+    g_array_free (pairs, TRUE);
+}
+
 void test_teamspaces (DBusConnection *bus)
 {
     GArray *spaces;
@@ -406,14 +859,39 @@ void test_helpers ()
     fprintf (stderr, "helpers passed\n");
 }
 
+/*
+ * Usage: dbtest [--seed N] [--round-trips N] [--bench [ITERATIONS]]
+ */
 int main (int argc, char **argv)
 {
     DBusConnection *bus;
+    guint32 seed = 1;
+    int round_trips = 500;
+    int bench_iterations = 0;
+    int i;
 
-    bus = dbus_bus_get (DBUS_BUS_SESSION, NULL);
+    for (i = 1; i < argc; i++) {
+        if (!strcmp (argv[i], "--seed") && i + 1 < argc)
+            seed = strtoul (argv[++i], NULL, 0);
+        else if (!strcmp (argv[i], "--round-trips") && i + 1 < argc)
+            round_trips = atoi (argv[++i]);
+        else if (!strcmp (argv[i], "--bench")) {
+            bench_iterations = 100000;
+            if (i + 1 < argc && g_ascii_isdigit (argv[i + 1][0]))
+                bench_iterations = atoi (argv[++i]);
+        }
+    }
 
     test_helpers ();
     test_marshalling ();
+    test_random_round_trip (seed, round_trips);
+
+    if (bench_iterations > 0) {
+        bench_marshalling (bench_iterations);
+        return 0;
+    }
+
+    bus = dbus_bus_get (DBUS_BUS_SESSION, NULL);
     test_teamspaces (bus);
 
     return 0;
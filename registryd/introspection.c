@@ -734,6 +734,15 @@ const char *spi_org_a11y_atspi_Registry =
 "  <method name=\"RegisterEvent\">"
 "    <arg direction=\"in\" name=\"event\" type=\"s\">"
 "    </arg>"
+"    <arg direction=\"in\" name=\"properties\" type=\"as\">"
+"    </arg>"
+"    <arg direction=\"in\" name=\"scope\" type=\"(so)\">"
+"    </arg>"
+"  </method>"
+""
+"  <method name=\"RegisterEvents\">"
+"    <arg direction=\"in\" name=\"events\" type=\"a(sas(so))\">"
+"    </arg>"
 "  </method>"
 ""
 "  <method name=\"DeregisterEvent\">"
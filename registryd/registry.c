@@ -36,6 +36,11 @@ struct event_data
   gchar *bus_name;
   gchar **data;
   GSList *properties;
+  /* Application and object the listener is restricted to, or NULL.
+   * Only recorded: bridges are not told about it, and applications emit
+   * for scoped listeners like for any other. */
+  gchar *scope_name;
+  gchar *scope_path;
 };
 
 static void
@@ -247,6 +252,8 @@ remove_events (SpiRegistry *registry, const char *bus_name, const char *event)
           g_strfreev (evdata->data);
           g_free (evdata->bus_name);
           g_slist_free_full (evdata->properties, g_free);
+          g_free (evdata->scope_name);
+          g_free (evdata->scope_path);
           g_free (evdata);
           registry->events = g_list_remove (registry->events, evdata);
         }
@@ -821,33 +828,24 @@ impl_GetItems (DBusConnection * bus, DBusMessage * message, void *user_data)
   return reply;
 }
 
-/* I would rather these two be signals, but I'm not sure that dbus-python
- * supports emitting signals except for a service, so implementing as both
- * a method call and signal for now.
+/*
+ * Records one event registration.  @iter points at the event name and
+ * may continue with an array of properties and a (so) scope reference;
+ * a scope with an empty bus name means the listener is not scoped.
  */
-static DBusMessage *
-impl_register_event (DBusConnection *bus, DBusMessage *message, void *user_data)
+static void
+register_event (SpiRegistry *registry, DBusConnection *bus,
+                const char *sender, DBusMessageIter *iter)
 {
-  SpiRegistry *registry = SPI_REGISTRY (user_data);
   const char *orig_name;
   gchar *name;
   event_data *evdata;
   gchar **data;
   DBusMessage *signal;
-  const char *sender = dbus_message_get_sender (message);
-  DBusMessageIter iter, iter_array;
-  const char *signature = dbus_message_get_signature (message);
-
-  if (strcmp (signature, "sas") != 0 &&
-      strcmp (signature, "s") != 0)
-  {
-    g_warning ("got RegisterEvent with invalid signature '%s'", signature);
-    return NULL;
-  }
+  DBusMessageIter iter_array, iter_signal;
 
-  dbus_message_iter_init (message, &iter);
-  dbus_message_iter_get_basic (&iter, &orig_name);
-  dbus_message_iter_next (&iter);
+  dbus_message_iter_get_basic (iter, &orig_name);
+  dbus_message_iter_next (iter);
   name = ensure_proper_format (orig_name);
 
   evdata = g_new0 (event_data, 1);
@@ -855,9 +853,9 @@ impl_register_event (DBusConnection *bus, DBusMessage *message, void *user_data)
   evdata->bus_name = g_strdup (sender);
   evdata->data = data;
 
-  if (dbus_message_iter_get_arg_type (&iter) == DBUS_TYPE_ARRAY)
+  if (dbus_message_iter_get_arg_type (iter) == DBUS_TYPE_ARRAY)
   {
-    dbus_message_iter_recurse (&iter, &iter_array);
+    dbus_message_iter_recurse (iter, &iter_array);
     while (dbus_message_iter_get_arg_type (&iter_array) != DBUS_TYPE_INVALID)
     {
       const char *property;
@@ -866,6 +864,21 @@ impl_register_event (DBusConnection *bus, DBusMessage *message, void *user_data)
                                            g_strdup (property));
       dbus_message_iter_next (&iter_array);
     }
+    dbus_message_iter_next (iter);
+  }
+  if (dbus_message_iter_get_arg_type (iter) == DBUS_TYPE_STRUCT)
+  {
+    const char *scope_name, *scope_path;
+    DBusMessageIter iter_struct;
+    dbus_message_iter_recurse (iter, &iter_struct);
+    dbus_message_iter_get_basic (&iter_struct, &scope_name);
+    dbus_message_iter_next (&iter_struct);
+    dbus_message_iter_get_basic (&iter_struct, &scope_path);
+    if (scope_name [0])
+    {
+      evdata->scope_name = g_strdup (scope_name);
+      evdata->scope_path = g_strdup (scope_path);
+    }
   }
   registry->events = g_list_append (registry->events, evdata);
 
@@ -880,21 +893,77 @@ impl_register_event (DBusConnection *bus, DBusMessage *message, void *user_data)
   if (signal)
   {
     GSList *ls = evdata->properties;
-    dbus_message_iter_init_append (signal, &iter);
-    dbus_message_iter_append_basic (&iter, DBUS_TYPE_STRING, &sender);
-    dbus_message_iter_append_basic (&iter, DBUS_TYPE_STRING, &name);
-    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "s", &iter_array);
+    dbus_message_iter_init_append (signal, &iter_signal);
+    dbus_message_iter_append_basic (&iter_signal, DBUS_TYPE_STRING, &sender);
+    dbus_message_iter_append_basic (&iter_signal, DBUS_TYPE_STRING, &name);
+    dbus_message_iter_open_container (&iter_signal, DBUS_TYPE_ARRAY, "s", &iter_array);
     while (ls)
     {
       dbus_message_iter_append_basic (&iter_array, DBUS_TYPE_STRING, &ls->data);
       ls = g_slist_next (ls);
     }
-    dbus_message_iter_close_container (&iter, &iter_array);
+    dbus_message_iter_close_container (&iter_signal, &iter_array);
     dbus_connection_send (bus, signal, NULL);
     dbus_message_unref (signal);
   }
 
   g_free (name);
+}
+
+/* I would rather these two be signals, but I'm not sure that dbus-python
+ * supports emitting signals except for a service, so implementing as both
+ * a method call and signal for now.
+ */
+static DBusMessage *
+impl_register_event (DBusConnection *bus, DBusMessage *message, void *user_data)
+{
+  SpiRegistry *registry = SPI_REGISTRY (user_data);
+  const char *sender = dbus_message_get_sender (message);
+  DBusMessageIter iter;
+  const char *signature = dbus_message_get_signature (message);
+
+  if (strcmp (signature, "sas(so)") != 0 &&
+      strcmp (signature, "sas") != 0 &&
+      strcmp (signature, "s") != 0)
+  {
+    g_warning ("got RegisterEvent with invalid signature '%s'", signature);
+    return NULL;
+  }
+
+  dbus_message_iter_init (message, &iter);
+  register_event (registry, bus, sender, &iter);
+
+  return dbus_message_new_method_return (message);
+}
+
+/*
+ * Batched form of RegisterEvent, so that a client starting up (or
+ * recovering from a registry restart) with many listeners needs only one
+ * round trip.
+ */
+static DBusMessage *
+impl_register_events (DBusConnection *bus, DBusMessage *message, void *user_data)
+{
+  SpiRegistry *registry = SPI_REGISTRY (user_data);
+  const char *sender = dbus_message_get_sender (message);
+  DBusMessageIter iter, iter_array, iter_struct;
+  const char *signature = dbus_message_get_signature (message);
+
+  if (strcmp (signature, "a(sas(so))") != 0)
+  {
+    g_warning ("got RegisterEvents with invalid signature '%s'", signature);
+    return NULL;
+  }
+
+  dbus_message_iter_init (message, &iter);
+  dbus_message_iter_recurse (&iter, &iter_array);
+  while (dbus_message_iter_get_arg_type (&iter_array) != DBUS_TYPE_INVALID)
+  {
+    dbus_message_iter_recurse (&iter_array, &iter_struct);
+    register_event (registry, bus, sender, &iter_struct);
+    dbus_message_iter_next (&iter_array);
+  }
+
   return dbus_message_new_method_return (message);
 }
 
@@ -1354,6 +1423,8 @@ handle_method_registry (DBusConnection *bus, DBusMessage *message, void *user_da
       result = DBUS_HANDLER_RESULT_HANDLED;
       if (!strcmp(member, "RegisterEvent"))
       reply = impl_register_event (bus, message, user_data);
+      else if (!strcmp(member, "RegisterEvents"))
+        reply = impl_register_events (bus, message, user_data);
       else if (!strcmp(member, "DeregisterEvent"))
         reply = impl_deregister_event (bus, message, user_data);
       else if (!strcmp(member, "GetRegisteredEvents"))
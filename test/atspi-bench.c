@@ -0,0 +1,760 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * End-to-end benchmarks, run by "make bench" through run-bench.sh on a
+ * private bus holding the registry and a synthetic-app.  Results are
+ * written as JSON; times are in microseconds unless the key says
+ * otherwise.
+ */
+
+#include "config.h"
+#include "atspi/atspi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static gchar *app_name = NULL;
+static gchar *synthetic_app = NULL;
+static gchar *output = NULL;
+static gint iterations = 5;
+static gint samples = 200;
+static gint event_count = 20000;
+static gchar *client_counts = NULL;
+static gint keystrokes = 500;
+
+static GOptionEntry optentries[] =
+{
+  {"app", 0, 0, G_OPTION_ARG_STRING, &app_name, "Bus name of the synthetic-app to walk", "NAME"},
+  {"synthetic-app", 0, 0, G_OPTION_ARG_FILENAME, &synthetic_app, "synthetic-app binary, started to emit events", "PATH"},
+  {"output", 'o', 0, G_OPTION_ARG_FILENAME, &output, "Write results here instead of stdout", "FILE"},
+  {"iterations", 0, 0, G_OPTION_ARG_INT, &iterations, "Tree walks of each kind (default 5)", "N"},
+  {"samples", 0, 0, G_OPTION_ARG_INT, &samples, "Calls timed per getter (default 200)", "N"},
+  {"events", 0, 0, G_OPTION_ARG_INT, &event_count, "Events to deliver (default 20000)", "N"},
+  {"clients", 0, 0, G_OPTION_ARG_STRING, &client_counts, "Comma-separated client counts for RegisterEvent (default 1,10,50,100)", "LIST"},
+  {"keystrokes", 0, 0, G_OPTION_ARG_INT, &keystrokes, "Keystrokes to time (default 500)", "N"},
+  {NULL}
+};
+
+/* Waiting for something to arrive through the main loop */
+
+static gboolean timed_out;
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  timed_out = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs the main loop until *done becomes TRUE or @msec pass; returns
+ * FALSE on timeout */
+static gboolean
+wait_for (gboolean *done, guint msec)
+{
+  guint id;
+
+  timed_out = FALSE;
+  id = g_timeout_add (msec, timeout_cb, NULL);
+  while (!*done && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  if (!timed_out)
+    g_source_remove (id);
+  return *done;
+}
+
+/* JSON output */
+
+typedef struct
+{
+  GString *str;
+  gint depth;
+  gboolean need_comma;
+} Json;
+
+static Json json;
+
+static void
+json_indent (void)
+{
+  gint i;
+
+  if (json.need_comma)
+    g_string_append_c (json.str, ',');
+  g_string_append_c (json.str, '\n');
+  for (i = 0; i < json.depth; i++)
+    g_string_append (json.str, "  ");
+}
+
+static void
+json_key (const char *key)
+{
+  json_indent ();
+  if (key)
+    g_string_append_printf (json.str, "\"%s\": ", key);
+}
+
+static void
+json_begin (const char *key, char bracket)
+{
+  json_key (key);
+  g_string_append_c (json.str, bracket);
+  json.depth++;
+  json.need_comma = FALSE;
+}
+
+static void
+json_end (char bracket)
+{
+  json.depth--;
+  json.need_comma = FALSE;
+  json_indent ();
+  g_string_append_c (json.str, bracket);
+  json.need_comma = TRUE;
+}
+
+static void
+json_double (const char *key, gdouble val)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  json_key (key);
+  g_string_append (json.str, g_ascii_formatd (buf, sizeof (buf), "%.3f", val));
+  json.need_comma = TRUE;
+}
+
+static void
+json_int (const char *key, gint64 val)
+{
+  json_key (key);
+  g_string_append_printf (json.str, "%" G_GINT64_FORMAT, val);
+  json.need_comma = TRUE;
+}
+
+static void
+json_string (const char *key, const char *val)
+{
+  gchar *escaped = g_strescape (val, NULL);
+
+  json_key (key);
+  g_string_append_printf (json.str, "\"%s\"", escaped);
+  json.need_comma = TRUE;
+  g_free (escaped);
+}
+
+static gint
+compare_doubles (gconstpointer a, gconstpointer b)
+{
+  gdouble x = *(const gdouble *) a, y = *(const gdouble *) b;
+
+  return (x < y ? -1 : (x > y ? 1 : 0));
+}
+
+/* Writes the count, mean, min, median, 95th percentile and max of
+ * @times; sorts it as a side effect */
+static void
+json_summary (const char *key, GArray *times)
+{
+  gdouble total = 0;
+  guint i;
+
+  json_begin (key, '{');
+  json_int ("count", times->len);
+  if (times->len > 0)
+  {
+    g_array_sort (times, compare_doubles);
+    for (i = 0; i < times->len; i++)
+      total += g_array_index (times, gdouble, i);
+    json_double ("mean", total / times->len);
+    json_double ("min", g_array_index (times, gdouble, 0));
+    json_double ("median", g_array_index (times, gdouble, times->len / 2));
+    json_double ("p95", g_array_index (times, gdouble, (times->len * 95) / 100));
+    json_double ("max", g_array_index (times, gdouble, times->len - 1));
+  }
+  json_end ('}');
+}
+
+static void
+json_error (const char *key, const char *message)
+{
+  json_begin (key, '{');
+  json_string ("error", message);
+  json_end ('}');
+}
+
+static void
+add_time (GArray *times, gint64 usec)
+{
+  gdouble val = usec;
+  g_array_append_val (times, val);
+}
+
+/* Finding the application */
+
+static AtspiAccessible *
+find_app (const char *name)
+{
+  AtspiAccessible *desktop = atspi_get_desktop (0);
+  AtspiAccessible *found = NULL;
+  gint count = atspi_accessible_get_child_count (desktop, NULL);
+  gint i;
+
+  for (i = 0; i < count && !found; i++)
+  {
+    AtspiAccessible *child = atspi_accessible_get_child_at_index (desktop, i,
+                                                                  NULL);
+    if (!child)
+      continue;
+    if (child->parent.app && !strcmp (child->parent.app->bus_name, name))
+      found = child;
+    else
+      g_object_unref (child);
+  }
+  g_object_unref (desktop);
+  return found;
+}
+
+/* Tree walks */
+
+static gint
+walk (AtspiAccessible *obj)
+{
+  AtspiStateSet *states;
+  gchar *name;
+  gint count, i;
+  gint nodes = 1;
+
+  name = atspi_accessible_get_name (obj, NULL);
+  g_free (name);
+  atspi_accessible_get_role (obj, NULL);
+  states = atspi_accessible_get_state_set (obj);
+  if (states)
+    g_object_unref (states);
+
+  count = atspi_accessible_get_child_count (obj, NULL);
+  for (i = 0; i < count; i++)
+  {
+    AtspiAccessible *child = atspi_accessible_get_child_at_index (obj, i, NULL);
+    if (!child)
+      continue;
+    nodes += walk (child);
+    g_object_unref (child);
+  }
+  return nodes;
+}
+
+static void
+bench_tree_walk (AtspiAccessible *app)
+{
+  GArray *cold = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  GArray *warm = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  gint64 start;
+  gint nodes = 0;
+  gint i;
+
+  /* A cold walk refetches everything the cache would otherwise hold */
+  for (i = 0; i < iterations; i++)
+  {
+    atspi_accessible_clear_cache (app);
+    start = g_get_monotonic_time ();
+    nodes = walk (app);
+    add_time (cold, g_get_monotonic_time () - start);
+
+    start = g_get_monotonic_time ();
+    walk (app);
+    add_time (warm, g_get_monotonic_time () - start);
+  }
+
+  json_begin ("tree_walk", '{');
+  json_int ("nodes", nodes);
+  json_summary ("cold", cold);
+  json_summary ("warm", warm);
+  json_end ('}');
+  g_array_free (cold, TRUE);
+  g_array_free (warm, TRUE);
+}
+
+/* Getter latency */
+
+typedef enum
+{
+  GETTER_NAME,
+  GETTER_ROLE,
+  GETTER_STATE_SET,
+  GETTER_ATTRIBUTES,
+  GETTER_EXTENTS,
+  GETTER_TEXT,
+  GETTER_CHARACTER_COUNT,
+  N_GETTERS
+} Getter;
+
+static const char *getter_names[] =
+{
+  "Accessible.Name",
+  "Accessible.GetRole",
+  "Accessible.GetState",
+  "Accessible.GetAttributes",
+  "Component.GetExtents",
+  "Text.GetText",
+  "Text.CharacterCount"
+};
+
+/* Finds a leaf with text, depth first */
+static AtspiAccessible *
+find_text (AtspiAccessible *obj)
+{
+  AtspiText *text = atspi_accessible_get_text_iface (obj);
+  gint count, i;
+
+  if (text)
+  {
+    g_object_unref (text);
+    return g_object_ref (obj);
+  }
+  count = atspi_accessible_get_child_count (obj, NULL);
+  for (i = 0; i < count; i++)
+  {
+    AtspiAccessible *child = atspi_accessible_get_child_at_index (obj, i, NULL);
+    AtspiAccessible *found;
+    if (!child)
+      continue;
+    found = find_text (child);
+    g_object_unref (child);
+    if (found)
+      return found;
+  }
+  return NULL;
+}
+
+static void
+call_getter (AtspiAccessible *obj, Getter getter)
+{
+  AtspiStateSet *states;
+  AtspiComponent *component;
+  AtspiText *text;
+  AtspiRect *rect;
+  GHashTable *attributes;
+  gchar *str;
+
+  switch (getter)
+  {
+  case GETTER_NAME:
+    str = atspi_accessible_get_name (obj, NULL);
+    g_free (str);
+    break;
+  case GETTER_ROLE:
+    atspi_accessible_get_role (obj, NULL);
+    break;
+  case GETTER_STATE_SET:
+    states = atspi_accessible_get_state_set (obj);
+    if (states)
+      g_object_unref (states);
+    break;
+  case GETTER_ATTRIBUTES:
+    attributes = atspi_accessible_get_attributes (obj, NULL);
+    if (attributes)
+      g_hash_table_unref (attributes);
+    break;
+  case GETTER_EXTENTS:
+    component = atspi_accessible_get_component_iface (obj);
+    rect = atspi_component_get_extents (component, ATSPI_COORD_TYPE_SCREEN,
+                                        NULL);
+    g_free (rect);
+    g_object_unref (component);
+    break;
+  case GETTER_TEXT:
+    text = atspi_accessible_get_text_iface (obj);
+    str = atspi_text_get_text (text, 0, -1, NULL);
+    g_free (str);
+    g_object_unref (text);
+    break;
+  case GETTER_CHARACTER_COUNT:
+    text = atspi_accessible_get_text_iface (obj);
+    atspi_text_get_character_count (text, NULL);
+    g_object_unref (text);
+    break;
+  default:
+    break;
+  }
+}
+
+static void
+bench_getters (AtspiAccessible *app)
+{
+  AtspiAccessible *obj = find_text (app);
+  GArray *times;
+  gint64 start;
+  gint getter, i;
+
+  if (!obj)
+  {
+    json_error ("getters", "no text object in the tree");
+    return;
+  }
+
+  json_begin ("getters", '{');
+  times = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  for (getter = 0; getter < N_GETTERS; getter++)
+  {
+    g_array_set_size (times, 0);
+    for (i = 0; i < samples; i++)
+    {
+      /* Cached values would make this measure nothing */
+      atspi_accessible_clear_cache (obj);
+      start = g_get_monotonic_time ();
+      call_getter (obj, getter);
+      add_time (times, g_get_monotonic_time () - start);
+    }
+    json_summary (getter_names[getter], times);
+  }
+  json_end ('}');
+  g_array_free (times, TRUE);
+  g_object_unref (obj);
+}
+
+/* Event throughput */
+
+static gint events_received;
+static gint64 first_event_time;
+static gint64 last_event_time;
+static gboolean events_done;
+
+static void
+on_event (AtspiEvent *event, void *data)
+{
+  last_event_time = g_get_monotonic_time ();
+  if (events_received++ == 0)
+    first_event_time = last_event_time;
+  if (events_received >= event_count)
+    events_done = TRUE;
+  g_boxed_free (ATSPI_TYPE_EVENT, event);
+}
+
+static void
+bench_events (void)
+{
+  AtspiEventListener *listener;
+  gchar *count = g_strdup_printf ("%d", event_count);
+  gchar *argv[] = { synthetic_app, "--depth", "2", "--fanout", "10",
+                    "--event-rate", "1000000", "--event-count", count,
+                    "--events", "state-changed,name-changed",
+                    "--exit-when-done", NULL };
+  GError *error = NULL;
+  gdouble seconds;
+
+  if (!synthetic_app)
+  {
+    json_error ("events", "no --synthetic-app given");
+    g_free (count);
+    return;
+  }
+
+  listener = atspi_event_listener_new (on_event, NULL, NULL);
+  atspi_event_listener_register (listener, "object:state-changed", NULL);
+  atspi_event_listener_register (listener, "object:property-change", NULL);
+
+  if (!g_spawn_async (NULL, argv, NULL, G_SPAWN_STDOUT_TO_DEV_NULL, NULL,
+                      NULL, NULL, &error))
+  {
+    json_error ("events", error->message);
+    g_error_free (error);
+    g_object_unref (listener);
+    g_free (count);
+    return;
+  }
+
+  wait_for (&events_done, 60000);
+  atspi_event_listener_deregister (listener, "object:state-changed", NULL);
+  atspi_event_listener_deregister (listener, "object:property-change", NULL);
+  g_object_unref (listener);
+  g_free (count);
+
+  json_begin ("events", '{');
+  json_int ("sent", event_count);
+  json_int ("received", events_received);
+  seconds = (last_event_time - first_event_time) / (gdouble) G_USEC_PER_SEC;
+  json_double ("seconds", seconds);
+  json_double ("per_second", seconds > 0 ? events_received / seconds : 0);
+  json_end ('}');
+}
+
+/* RegisterEvent scaling */
+
+static DBusConnection *
+open_client (void)
+{
+  const char *address = g_getenv ("AT_SPI_BUS_ADDRESS");
+  DBusConnection *connection;
+
+  if (!address)
+    return NULL;
+  connection = dbus_connection_open_private (address, NULL);
+  if (connection && !dbus_bus_register (connection, NULL))
+  {
+    dbus_connection_close (connection);
+    dbus_connection_unref (connection);
+    return NULL;
+  }
+  return connection;
+}
+
+static gboolean
+register_event (DBusConnection *connection, const char *event)
+{
+  DBusMessage *message, *reply;
+
+  message = dbus_message_new_method_call (ATSPI_DBUS_NAME_REGISTRY,
+                                          ATSPI_DBUS_PATH_REGISTRY,
+                                          ATSPI_DBUS_INTERFACE_REGISTRY,
+                                          "RegisterEvent");
+  dbus_message_append_args (message, DBUS_TYPE_STRING, &event,
+                            DBUS_TYPE_INVALID);
+  reply = dbus_connection_send_with_reply_and_block (connection, message,
+                                                     -1, NULL);
+  dbus_message_unref (message);
+  if (!reply)
+    return FALSE;
+  dbus_message_unref (reply);
+  return TRUE;
+}
+
+static void
+bench_register_event (void)
+{
+  gchar **counts = g_strsplit (client_counts ? client_counts : "1,10,50,100",
+                               ",", -1);
+  GArray *times = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  GPtrArray *clients = g_ptr_array_new ();
+  gint64 start;
+  gint i, j;
+
+  if (!g_getenv ("AT_SPI_BUS_ADDRESS"))
+  {
+    json_error ("register_event", "AT_SPI_BUS_ADDRESS is not set");
+    g_strfreev (counts);
+    return;
+  }
+
+  json_begin ("register_event", '[');
+  for (i = 0; counts[i]; i++)
+  {
+    gint n = atoi (counts[i]);
+
+    /* Each client registers for its own event, then every client's
+     * registration is timed once more while all of them are listening */
+    for (j = clients->len; j < n; j++)
+    {
+      DBusConnection *connection = open_client ();
+      if (!connection)
+        break;
+      register_event (connection, "object:state-changed");
+      g_ptr_array_add (clients, connection);
+    }
+
+    g_array_set_size (times, 0);
+    for (j = 0; j < clients->len; j++)
+    {
+      start = g_get_monotonic_time ();
+      if (register_event (g_ptr_array_index (clients, j),
+                          "object:property-change:accessible-name"))
+        add_time (times, g_get_monotonic_time () - start);
+    }
+
+    json_begin (NULL, '{');
+    json_int ("clients", clients->len);
+    json_summary ("call", times);
+    json_end ('}');
+  }
+  json_end (']');
+
+  for (j = 0; j < clients->len; j++)
+  {
+    DBusConnection *connection = g_ptr_array_index (clients, j);
+    dbus_connection_close (connection);
+    dbus_connection_unref (connection);
+  }
+  g_ptr_array_free (clients, TRUE);
+  g_array_free (times, TRUE);
+  g_strfreev (counts);
+}
+
+/* Keystroke latency through the device event controller */
+
+static gint64 *key_sent;
+static GArray *key_times;
+static gint keys_received;
+static gboolean keys_done;
+
+static gboolean
+on_key (const AtspiDeviceEvent *stroke, void *user_data)
+{
+  if (stroke->id < keystrokes && key_sent[stroke->id])
+    add_time (key_times, g_get_monotonic_time () - key_sent[stroke->id]);
+  keys_done = TRUE;
+  keys_received++;
+  return FALSE;
+}
+
+/* Sends a key press the way a toolkit bridge does */
+static void
+send_key (DBusConnection *connection, dbus_int32_t id)
+{
+  DBusMessage *message;
+  DBusMessageIter iter, iter_struct;
+  dbus_uint32_t type = ATSPI_KEY_PRESSED_EVENT;
+  dbus_int32_t hw_code = 38, modifiers = 0, timestamp = 0;
+  const char *str = "a";
+  dbus_bool_t is_text = TRUE;
+
+  message = dbus_message_new_method_call (ATSPI_DBUS_NAME_REGISTRY,
+                                          ATSPI_DBUS_PATH_DEC,
+                                          ATSPI_DBUS_INTERFACE_DEC,
+                                          "NotifyListenersSync");
+  dbus_message_iter_init_append (message, &iter);
+  dbus_message_iter_open_container (&iter, DBUS_TYPE_STRUCT, NULL,
+                                    &iter_struct);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_UINT32, &type);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_INT32, &id);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_INT32, &hw_code);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_INT32, &modifiers);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_INT32, &timestamp);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_STRING, &str);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_BOOLEAN, &is_text);
+  dbus_message_iter_close_container (&iter, &iter_struct);
+  dbus_message_set_no_reply (message, TRUE);
+  dbus_connection_send (connection, message, NULL);
+  dbus_connection_flush (connection);
+  dbus_message_unref (message);
+}
+
+static void
+bench_keystrokes (void)
+{
+  AtspiDeviceListener *listener;
+  DBusConnection *connection;
+  gint i;
+
+  connection = open_client ();
+  if (!connection)
+  {
+    json_error ("keystrokes", "cannot connect to the bus");
+    return;
+  }
+
+  listener = atspi_device_listener_new (on_key, NULL, NULL);
+  if (!atspi_register_keystroke_listener (listener, NULL, 0,
+                                          1 << ATSPI_KEY_PRESSED_EVENT,
+                                          ATSPI_KEYLISTENER_NOSYNC, NULL))
+  {
+    json_error ("keystrokes", "cannot register a keystroke listener");
+    g_object_unref (listener);
+    dbus_connection_close (connection);
+    dbus_connection_unref (connection);
+    return;
+  }
+
+  key_sent = g_new0 (gint64, keystrokes);
+  key_times = g_array_new (FALSE, FALSE, sizeof (gdouble));
+  for (i = 0; i < keystrokes; i++)
+  {
+    keys_done = FALSE;
+    key_sent[i] = g_get_monotonic_time ();
+    send_key (connection, i);
+    if (!wait_for (&keys_done, 1000))
+      break;
+  }
+
+  json_begin ("keystrokes", '{');
+  json_int ("sent", i);
+  json_int ("received", keys_received);
+  json_summary ("latency", key_times);
+  json_end ('}');
+
+  atspi_deregister_keystroke_listener (listener, NULL, 0,
+                                      1 << ATSPI_KEY_PRESSED_EVENT, NULL);
+  g_object_unref (listener);
+  g_array_free (key_times, TRUE);
+  g_free (key_sent);
+  dbus_connection_close (connection);
+  dbus_connection_unref (connection);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *opt;
+  GError *err = NULL;
+  AtspiAccessible *app = NULL;
+
+  opt = g_option_context_new ("- benchmark libatspi against a synthetic-app");
+  g_option_context_add_main_entries (opt, optentries, NULL);
+  if (!g_option_context_parse (opt, &argc, &argv, &err))
+  {
+    g_printerr ("%s\n", err->message);
+    return 1;
+  }
+  g_option_context_free (opt);
+
+  if (atspi_init () != 0)
+  {
+    g_printerr ("atspi-bench: cannot initialize libatspi\n");
+    return 1;
+  }
+
+  json.str = g_string_new (NULL);
+  json_begin (NULL, '{');
+  json_string ("version", VERSION);
+  json_int ("timestamp", g_get_real_time () / G_USEC_PER_SEC);
+
+  if (app_name)
+    app = find_app (app_name);
+  if (app)
+  {
+    bench_tree_walk (app);
+    bench_getters (app);
+    g_object_unref (app);
+  }
+  else
+  {
+    json_error ("tree_walk", "application not found");
+    json_error ("getters", "application not found");
+  }
+  bench_events ();
+  bench_register_event ();
+  bench_keystrokes ();
+
+  json_end ('}');
+  g_string_append_c (json.str, '\n');
+
+  if (output)
+  {
+    if (!g_file_set_contents (output, json.str->str, json.str->len, &err))
+    {
+      g_printerr ("%s\n", err->message);
+      return 1;
+    }
+  }
+  else
+    fputs (json.str->str, stdout);
+
+  g_string_free (json.str, TRUE);
+  atspi_exit ();
+  return 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Reads cache views from a worker thread while the main context renames
+ * and removes children of a synthetic-app, which run-with-app.sh starts
+ * with --depth 2 --fanout 5.
+ */
+
+#include "config.h"
+#include "test-utils.h"
+#include <string.h>
+
+#define N_CHILDREN 5
+#define N_CHANGES 200
+
+static gchar *app_name = NULL;
+
+static GOptionEntry optentries[] =
+{
+  {"app", 0, 0, G_OPTION_ARG_STRING, &app_name, "Bus name of the synthetic-app", "NAME"},
+  {NULL}
+};
+
+typedef struct
+{
+  AtspiAccessible *root;
+  gint stop;
+  gint reads;
+
+  /* Written by the reader only */
+  const gchar *error;
+  AtspiCacheView *first_view;
+  gchar *first_name;
+} Shared;
+
+/* Checks that every view the reader sees is one the main context could
+ * have published */
+static gpointer
+reader (gpointer data)
+{
+  Shared *shared = data;
+
+  while (!g_atomic_int_get (&shared->stop) && !shared->error)
+  {
+    AtspiCacheView *view = atspi_accessible_ref_cache_view (shared->root);
+    gint count, i;
+
+    if (!view)
+    {
+      shared->error = "the view of the root went away";
+      break;
+    }
+    count = atspi_cache_view_get_child_count (view);
+    if (count != N_CHILDREN && count != N_CHILDREN - 1)
+      shared->error = "the root has the wrong number of children";
+    for (i = 0; i < count && !shared->error; i++)
+    {
+      AtspiAccessible *child = atspi_cache_view_get_child_at_index (view, i);
+      AtspiCacheView *child_view;
+      const gchar *name;
+
+      if (!child)
+      {
+        shared->error = "a child is missing";
+        break;
+      }
+      /* Requested up front, so there from the first pass */
+      child_view = atspi_accessible_ref_cache_view (child);
+      if (!child_view)
+      {
+        shared->error = "a child has no view";
+        break;
+      }
+      name = atspi_cache_view_get_name (child_view);
+      if (!name ||
+          (!g_str_has_prefix (name, "panel ") &&
+           !g_str_has_prefix (name, "renamed ")))
+        shared->error = "a child has a name that was never set";
+      if (!shared->first_view)
+      {
+        shared->first_view = child_view;
+        shared->first_name = g_strdup (name);
+      }
+      else
+        atspi_cache_view_unref (child_view);
+    }
+    atspi_cache_view_unref (view);
+    g_atomic_int_inc (&shared->reads);
+  }
+  return NULL;
+}
+
+static gpointer
+ref_view_thread (gpointer data)
+{
+  return atspi_accessible_ref_cache_view (data);
+}
+
+/* Asks for the view of @accessible from another thread */
+static AtspiCacheView *
+ref_view_elsewhere (AtspiAccessible *accessible)
+{
+  return g_thread_join (g_thread_new ("asker", ref_view_thread, accessible));
+}
+
+static gboolean
+children_published (gpointer data)
+{
+  AtspiCacheView *view = atspi_accessible_ref_cache_view (data);
+  gboolean done;
+
+  done = (view && atspi_cache_view_get_child_count (view) == N_CHILDREN);
+  if (view)
+    atspi_cache_view_unref (view);
+  return done;
+}
+
+static gboolean
+reader_has_read (gpointer data)
+{
+  Shared *shared = data;
+
+  return (g_atomic_int_get (&shared->reads) > 0);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *opt;
+  GError *err = NULL;
+  Shared shared = { 0 };
+  GThread *thread;
+  gchar *last_names[N_CHILDREN] = { 0 };
+  AtspiCacheView *view, *child_view;
+  AtspiAccessible *grandchild;
+  gint i;
+
+  opt = g_option_context_new ("- test cache views against a synthetic-app");
+  g_option_context_add_main_entries (opt, optentries, NULL);
+  if (!g_option_context_parse (opt, &argc, &argv, &err))
+  {
+    g_printerr ("%s\n", err->message);
+    return 1;
+  }
+  g_option_context_free (opt);
+
+  if (!app_name || atspi_init () != 0)
+    test_fail ("cannot initialize");
+  shared.root = test_find_app (app_name);
+  if (!shared.root)
+    test_fail ("application %s not found", app_name);
+  atspi_accessible_set_cache_mask (shared.root, ATSPI_CACHE_DEFAULT);
+  test_watch_changes ();
+
+  if (!test_wait_until (children_published, shared.root, 5000))
+    test_fail ("the children of the root were never published");
+  atspi_accessible_request_cache_views (shared.root, 1);
+
+  /* Another thread asking first gets nothing until the main context has
+   * been idle */
+  view = atspi_accessible_ref_cache_view (shared.root);
+  child_view = atspi_accessible_ref_cache_view (
+    atspi_cache_view_get_child_at_index (view, 0));
+  grandchild = atspi_cache_view_get_child_at_index (child_view, 0);
+  if (!grandchild)
+    test_fail ("the grandchildren are not cached");
+  g_object_ref (grandchild);
+  atspi_cache_view_unref (child_view);
+  atspi_cache_view_unref (view);
+  view = ref_view_elsewhere (grandchild);
+  if (view)
+    test_fail ("a view was published without being asked for");
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  view = ref_view_elsewhere (grandchild);
+  if (!view)
+    test_fail ("a view asked for by another thread was never published");
+  atspi_cache_view_unref (view);
+  g_object_unref (grandchild);
+
+  thread = g_thread_new ("reader", reader, &shared);
+  test_wait_until (reader_has_read, &shared, 5000);
+  for (i = 0; i < N_CHANGES; i++)
+  {
+    gint child = i % (N_CHILDREN - 1);
+
+    g_free (last_names[child]);
+    last_names[child] = g_strdup_printf ("renamed %d", i);
+    test_set_name (app_name, child + 1, last_names[child]);
+    if (i == N_CHANGES / 2)
+      test_remove_child (app_name, N_CHILDREN);
+    while (g_main_context_iteration (NULL, FALSE))
+      ;
+  }
+  g_atomic_int_set (&shared.stop, TRUE);
+  g_thread_join (thread);
+  if (shared.error)
+    test_fail ("reader: %s", shared.error);
+  if (shared.reads == 0)
+    test_fail ("the reader never read anything");
+
+  /* The latest views follow every change */
+  view = atspi_accessible_ref_cache_view (shared.root);
+  if (!view || atspi_cache_view_get_child_count (view) != N_CHILDREN - 1)
+    test_fail ("the removed child is still in the view of the root");
+  for (i = 0; i < N_CHILDREN - 1; i++)
+  {
+    AtspiAccessible *child = atspi_cache_view_get_child_at_index (view, i);
+
+    child_view = atspi_accessible_ref_cache_view (child);
+    if (!child_view ||
+        g_strcmp0 (atspi_cache_view_get_name (child_view), last_names[i]) != 0)
+      test_fail ("child %d does not have its last name, %s", i + 1,
+                 last_names[i]);
+    atspi_cache_view_unref (child_view);
+    g_free (last_names[i]);
+  }
+
+  /* Published views never change */
+  if (shared.first_view &&
+      g_strcmp0 (atspi_cache_view_get_name (shared.first_view),
+                 shared.first_name) != 0)
+    test_fail ("an old view changed from %s to %s", shared.first_name,
+               atspi_cache_view_get_name (shared.first_view));
+
+  /* Clearing the cache empties even the views already handed out */
+  atspi_accessible_clear_cache (shared.root);
+  if (atspi_cache_view_get_cached (view) != ATSPI_CACHE_NONE)
+    test_fail ("a view outlived atspi_accessible_clear_cache ()");
+
+  atspi_cache_view_unref (view);
+  if (shared.first_view)
+    atspi_cache_view_unref (shared.first_view);
+  g_free (shared.first_name);
+  g_object_unref (shared.root);
+  atspi_exit ();
+  return 0;
+}
@@ -0,0 +1,36 @@
+#!/bin/sh
+#
+# Runs atspi-bench against a private accessibility bus set up by
+# run-with-app.sh, and writes the benchmark results as JSON.
+#
+# Usage: run-bench.sh --dbus-daemon PATH --config FILE --registryd PATH
+#                     --synthetic-app PATH --bench PATH [--output FILE]
+#                     [-- extra atspi-bench options]
+#
+# BENCH_DEPTH and BENCH_FANOUT set the shape of the walked tree.
+
+set -e
+
+output=bench.json
+depth=${BENCH_DEPTH:-4}
+fanout=${BENCH_FANOUT:-5}
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --dbus-daemon) dbus_daemon="$2"; shift 2 ;;
+    --config) config="$2"; shift 2 ;;
+    --registryd) registryd="$2"; shift 2 ;;
+    --synthetic-app) synthetic_app="$2"; shift 2 ;;
+    --bench) bench="$2"; shift 2 ;;
+    --output) output="$2"; shift 2 ;;
+    --) shift; break ;;
+    *) echo "run-bench.sh: unknown option $1" >&2; exit 1 ;;
+  esac
+done
+
+sh "`dirname "$0"`/run-with-app.sh" \
+  --dbus-daemon "$dbus_daemon" --config "$config" --registryd "$registryd" \
+  --synthetic-app "$synthetic_app" \
+  --app-args "--depth $depth --fanout $fanout --table-columns 3" \
+  -- "$bench" --synthetic-app "$synthetic_app" --output "$output" "$@"
+echo "Benchmark results written to $output"
@@ -0,0 +1,87 @@
+#!/bin/sh
+#
+# Runs a program against a private accessibility bus: starts a
+# dbus-daemon with bus/accessibility.conf, the registry and a
+# synthetic-app, then runs the program with "--app <bus name of the
+# synthetic-app>" added in front of its own arguments.  Exits with the
+# program's status.
+#
+# Usage: run-with-app.sh --dbus-daemon PATH --config FILE --registryd PATH
+#                        --synthetic-app PATH [--app-args ARGS]
+#                        -- PROGRAM [ARGS...]
+#
+# ARGS given with --app-args are split on spaces and passed to the
+# synthetic-app.
+
+set -e
+
+app_args=
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --dbus-daemon) dbus_daemon="$2"; shift 2 ;;
+    --config) config="$2"; shift 2 ;;
+    --registryd) registryd="$2"; shift 2 ;;
+    --synthetic-app) synthetic_app="$2"; shift 2 ;;
+    --app-args) app_args="$2"; shift 2 ;;
+    --) shift; break ;;
+    *) echo "run-with-app.sh: unknown option $1" >&2; exit 1 ;;
+  esac
+done
+
+if [ $# -eq 0 ]; then
+  echo "run-with-app.sh: no program given" >&2
+  exit 1
+fi
+program="$1"
+shift
+
+for prog in "$dbus_daemon" "$registryd" "$synthetic_app" "$program"; do
+  if [ ! -x "$prog" ]; then
+    echo "run-with-app.sh: cannot run '$prog'" >&2
+    exit 1
+  fi
+done
+
+tmpdir=`mktemp -d`
+pids=
+cleanup ()
+{
+  for pid in $pids; do
+    kill $pid 2>/dev/null || true
+  done
+  rm -rf "$tmpdir"
+}
+trap cleanup EXIT INT TERM
+
+# Waits up to ten seconds for a line matching $2 in the file $1
+wait_for_line ()
+{
+  tries=0
+  while ! grep -q "$2" "$1" 2>/dev/null; do
+    tries=`expr $tries + 1`
+    if [ $tries -gt 100 ]; then
+      echo "run-with-app.sh: timed out waiting for $1" >&2
+      exit 1
+    fi
+    sleep 0.1
+  done
+}
+
+"$dbus_daemon" --config-file="$config" --nofork --print-address=1 \
+  > "$tmpdir/address" &
+pids="$pids $!"
+wait_for_line "$tmpdir/address" .
+AT_SPI_BUS_ADDRESS=`head -n 1 "$tmpdir/address"`
+export AT_SPI_BUS_ADDRESS
+
+"$registryd" > "$tmpdir/registryd" &
+pids="$pids $!"
+wait_for_line "$tmpdir/registryd" "running"
+
+"$synthetic_app" $app_args > "$tmpdir/app" &
+pids="$pids $!"
+wait_for_line "$tmpdir/app" "^ready "
+app_name=`sed -n 's/^ready //p' "$tmpdir/app"`
+
+"$program" --app "$app_name" "$@"
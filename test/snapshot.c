@@ -0,0 +1,185 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Takes snapshots of a synthetic-app, which run-with-app.sh starts with
+ * --depth 2 --fanout 5, while renaming and removing nodes in it.
+ */
+
+#include "config.h"
+#include "test-utils.h"
+#include <string.h>
+
+#define N_CHILDREN 5
+#define N_NODES (1 + N_CHILDREN + N_CHILDREN * N_CHILDREN)
+#define MASK (ATSPI_CACHE_NAME | ATSPI_CACHE_ROLE)
+
+static gchar *app_name = NULL;
+
+static GOptionEntry optentries[] =
+{
+  {"app", 0, 0, G_OPTION_ARG_STRING, &app_name, "Bus name of the synthetic-app", "NAME"},
+  {NULL}
+};
+
+/* The tree is cached once the items of the application have arrived;
+ * the view of the root shows when that is */
+static gboolean
+children_cached (gpointer data)
+{
+  AtspiCacheView *view = atspi_accessible_ref_cache_view (data);
+  gboolean done;
+
+  done = (view && atspi_cache_view_get_child_count (view) == N_CHILDREN);
+  if (view)
+    atspi_cache_view_unref (view);
+  return done;
+}
+
+static const AtspiSnapshotNode *
+child (AtspiSnapshot *snapshot, gint index)
+{
+  return atspi_snapshot_node_get_child (atspi_snapshot_get_root (snapshot),
+                                        index);
+}
+
+static AtspiSnapshot *
+take (AtspiAccessible *root, AtspiCache mask)
+{
+  GError *error = NULL;
+  AtspiSnapshot *snapshot = atspi_accessible_snapshot (root, -1, mask, &error);
+
+  if (!snapshot)
+    test_fail ("cannot take a snapshot: %s",
+               error ? error->message : "no error");
+  return snapshot;
+}
+
+static gpointer
+unref_snapshot (gpointer data)
+{
+  atspi_snapshot_unref (data);
+  return NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *opt;
+  GError *err = NULL;
+  AtspiAccessible *root;
+  AtspiSnapshot *first, *again, *renamed, *removed, *other;
+  const AtspiSnapshotNode *node;
+  gchar *old_name;
+  guint ref_count;
+
+  opt = g_option_context_new ("- test snapshots against a synthetic-app");
+  g_option_context_add_main_entries (opt, optentries, NULL);
+  if (!g_option_context_parse (opt, &argc, &argv, &err))
+  {
+    g_printerr ("%s\n", err->message);
+    return 1;
+  }
+  g_option_context_free (opt);
+
+  if (!app_name || atspi_init () != 0)
+    test_fail ("cannot initialize");
+  root = test_find_app (app_name);
+  if (!root)
+    test_fail ("application %s not found", app_name);
+  atspi_accessible_set_cache_mask (root, ATSPI_CACHE_DEFAULT);
+  test_watch_changes ();
+  if (!test_wait_until (children_cached, root, 5000))
+    test_fail ("the tree was never cached");
+
+  /* Nothing changed: the same snapshot again */
+  first = take (root, MASK);
+  if (atspi_snapshot_get_n_nodes (first) != N_NODES)
+    test_fail ("the snapshot has %u nodes, not %d",
+               atspi_snapshot_get_n_nodes (first), N_NODES);
+  again = take (root, MASK);
+  if (again != first)
+    test_fail ("an unchanged tree was recorded again");
+  atspi_snapshot_unref (again);
+
+  /* One leaf renamed: only the path down to it is recorded again.  Node
+   * 6 is the first child of node 1, the first child of the root. */
+  node = atspi_snapshot_node_get_child (child (first, 0), 0);
+  old_name = g_strdup (atspi_snapshot_node_get_name (node));
+  test_set_name (app_name, 6, "renamed leaf");
+  renamed = take (root, MASK);
+  if (renamed == first)
+    test_fail ("a renamed leaf was not noticed");
+  node = atspi_snapshot_node_get_child (child (renamed, 0), 0);
+  if (g_strcmp0 (atspi_snapshot_node_get_name (node), "renamed leaf") != 0)
+    test_fail ("the new snapshot does not have the new name");
+  node = atspi_snapshot_node_get_child (child (first, 0), 0);
+  if (g_strcmp0 (atspi_snapshot_node_get_name (node), old_name) != 0)
+    test_fail ("the old snapshot changed");
+  if (atspi_snapshot_get_root (renamed) == atspi_snapshot_get_root (first) ||
+      child (renamed, 0) == child (first, 0))
+    test_fail ("the path to the renamed leaf was not recorded again");
+  if (child (renamed, 1) != child (first, 1) ||
+      child (renamed, N_CHILDREN - 1) != child (first, N_CHILDREN - 1) ||
+      atspi_snapshot_node_get_child (child (renamed, 0), 1) !=
+      atspi_snapshot_node_get_child (child (first, 0), 1))
+    test_fail ("unchanged subtrees were not shared");
+  g_free (old_name);
+
+  /* Node 3, the third child of the root, removed */
+  test_remove_child (app_name, 3);
+  removed = take (root, MASK);
+  if (atspi_snapshot_node_get_child_count (atspi_snapshot_get_root (removed))
+      != N_CHILDREN - 1 ||
+      atspi_snapshot_get_n_nodes (removed) != N_NODES - 1 - N_CHILDREN)
+    test_fail ("the removed child is still in the snapshot");
+  if (atspi_snapshot_node_get_accessible (child (removed, 2)) !=
+      atspi_snapshot_node_get_accessible (child (renamed, 3)))
+    test_fail ("the children after the removed one did not move up");
+  if (child (removed, 0) != child (renamed, 0) ||
+      child (removed, 2) != child (renamed, 3))
+    test_fail ("the remaining children were not shared");
+  if (atspi_snapshot_node_get_child_count (atspi_snapshot_get_root (renamed))
+      != N_CHILDREN)
+    test_fail ("the old snapshot lost a child");
+
+  /* Released on another thread: the accessibles are only let go of once
+   * the main context runs */
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  ref_count = G_OBJECT (root)->ref_count;
+  other = take (root, ATSPI_CACHE_NAME);
+  if (G_OBJECT (root)->ref_count != ref_count + 1)
+    test_fail ("a snapshot with a new mask shared nodes");
+  g_thread_join (g_thread_new ("unref", unref_snapshot, other));
+  if (G_OBJECT (root)->ref_count != ref_count + 1)
+    test_fail ("a snapshot was freed off the main context");
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+  if (G_OBJECT (root)->ref_count != ref_count)
+    test_fail ("a snapshot released on another thread was never freed");
+
+  atspi_snapshot_unref (first);
+  atspi_snapshot_unref (renamed);
+  atspi_snapshot_unref (removed);
+  g_object_unref (root);
+  atspi_exit ();
+  return 0;
+}
@@ -0,0 +1,1485 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * A stand-in for a toolkit bridge, for tests and benchmarks.  It embeds
+ * itself in the registry and serves a generated tree of accessibles:
+ * a complete tree of the given depth and fan-out, where the parents of
+ * the leaves can be tables and every other leaf holds text.  Nothing is
+ * stored per node; everything is computed from the node's number, so
+ * trees of millions of nodes cost no memory.
+ *
+ * It can also emit a steady stream of events.  Once registered, it prints
+ * "ready <bus name>" on stdout.
+ *
+ * Tests change the tree through the org.a11y.atspi.Synthetic interface
+ * at /org/a11y/atspi/synthetic: SetName (node, name) renames a node and
+ * RemoveChild (node) takes a node and everything below it out of its
+ * parent.  Both emit the matching event before replying.  Nodes are
+ * numbered as below.
+ */
+
+#include "config.h"
+#include "atspi/atspi.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATH_PREFIX "/org/a11y/atspi/accessible/"
+#define PATH_ROOT ATSPI_DBUS_PATH_ROOT
+#define PATH_CACHE "/org/a11y/atspi/cache"
+#define PATH_NULL ATSPI_DBUS_PATH_NULL
+#define PATH_CONTROL "/org/a11y/atspi/synthetic"
+
+#define IFACE_ACCESSIBLE "org.a11y.atspi.Accessible"
+#define IFACE_APPLICATION "org.a11y.atspi.Application"
+#define IFACE_CACHE "org.a11y.atspi.Cache"
+#define IFACE_COMPONENT "org.a11y.atspi.Component"
+#define IFACE_TABLE "org.a11y.atspi.Table"
+#define IFACE_TEXT "org.a11y.atspi.Text"
+#define IFACE_EVENT_OBJECT "org.a11y.atspi.Event.Object"
+#define IFACE_PROPERTIES "org.freedesktop.DBus.Properties"
+#define IFACE_CONTROL "org.a11y.atspi.Synthetic"
+
+#define SCREEN_WIDTH 1024
+#define SCREEN_HEIGHT 768
+
+#define MAX_NODES (1 << 24)
+
+static const char *phrase = "The quick brown fox jumps over the lazy dog. ";
+
+static gchar *address = NULL;
+static gint depth = 4;
+static gint fanout = 5;
+static gint text_size = 200;
+static gint table_columns = 0;
+static gdouble event_rate = 0;
+static gint event_count = 0;
+static gchar *event_types = NULL;
+static gboolean exit_when_done = FALSE;
+static gboolean no_cache = FALSE;
+
+static GOptionEntry optentries[] =
+{
+  {"address", 0, 0, G_OPTION_ARG_STRING, &address, "Address of the bus to connect to (default: the accessibility bus)", "ADDRESS"},
+  {"depth", 0, 0, G_OPTION_ARG_INT, &depth, "Levels below the application (default 4)", "N"},
+  {"fanout", 0, 0, G_OPTION_ARG_INT, &fanout, "Children of each node above the leaves (default 5)", "N"},
+  {"text-size", 0, 0, G_OPTION_ARG_INT, &text_size, "Characters in each text leaf; 0 for no text (default 200)", "N"},
+  {"table-columns", 0, 0, G_OPTION_ARG_INT, &table_columns, "Make the parents of the leaves tables with this many columns", "N"},
+  {"event-rate", 0, 0, G_OPTION_ARG_DOUBLE, &event_rate, "Events to emit per second (default 0)", "RATE"},
+  {"event-count", 0, 0, G_OPTION_ARG_INT, &event_count, "Stop after emitting this many events (default: never)", "N"},
+  {"events", 0, 0, G_OPTION_ARG_STRING, &event_types, "Comma-separated events to cycle through: state-changed, name-changed, caret-moved, children-changed (default state-changed)", "LIST"},
+  {"exit-when-done", 0, 0, G_OPTION_ARG_NONE, &exit_when_done, "Exit once --event-count events have been emitted", NULL},
+  {"no-cache", 0, 0, G_OPTION_ARG_NONE, &no_cache, "Do not implement Cache.GetItems", NULL},
+  {NULL}
+};
+
+typedef struct
+{
+  gint x, y, width, height;
+} Rect;
+
+static DBusConnection *bus;
+static const char *bus_name;
+static GMainLoop *mainloop;
+
+static gint n_nodes;
+static gint first_leaf;
+
+static gchar *desktop_name;
+static gchar *desktop_path;
+static dbus_int32_t app_id;
+
+static GHashTable *carets;
+static gint focus = -1;
+
+/* Changes made through the control interface: names set on nodes, and
+ * the nodes taken out of their parents (NULL until there are any) */
+static GHashTable *names;
+static GHashTable *removed;
+
+static gchar **event_list;
+static gint64 events_start;
+static gint events_sent;
+
+/* Tree shape.  Nodes are numbered breadth-first from 0, the application,
+ * so the children of node n are n * fanout + 1 to n * fanout + fanout.
+ * Removed children are skipped; the numbers of the others stay the same. */
+
+static gint
+node_parent (gint node)
+{
+  return (node > 0 ? (node - 1) / fanout : -1);
+}
+
+static gboolean
+node_is_removed (gint node)
+{
+  return (removed && g_hash_table_contains (removed, GINT_TO_POINTER (node)));
+}
+
+/* Whether @node or one of its ancestors has been removed */
+static gboolean
+node_is_gone (gint node)
+{
+  if (!removed)
+    return FALSE;
+  for (; node > 0; node = node_parent (node))
+    if (node_is_removed (node))
+      return TRUE;
+  return FALSE;
+}
+
+static gint
+node_index_in_parent (gint node)
+{
+  gint index, sibling;
+
+  if (node <= 0)
+    return -1;
+  index = (node - 1) % fanout;
+  if (removed)
+  {
+    for (sibling = node - index; sibling < node; sibling++)
+      if (node_is_removed (sibling))
+        index--;
+  }
+  return index;
+}
+
+static gint
+node_child_count (gint node)
+{
+  gint count = (node < first_leaf ? fanout : 0);
+  gint child, end;
+
+  if (removed)
+  {
+    end = node * fanout + 1 + count;
+    for (child = node * fanout + 1; child < end; child++)
+      if (node_is_removed (child))
+        count--;
+  }
+  return count;
+}
+
+static gint
+node_child (gint node, gint index)
+{
+  gint child;
+
+  if (index < 0 || index >= node_child_count (node))
+    return -1;
+  child = node * fanout + 1;
+  if (!removed)
+    return child + index;
+  for (;; child++)
+  {
+    if (!node_is_removed (child) && index-- == 0)
+      return child;
+  }
+}
+
+static gboolean
+node_is_table (gint node)
+{
+  return (table_columns > 0 && node > 0 && node < first_leaf &&
+          node * fanout + 1 >= first_leaf);
+}
+
+static gboolean
+node_has_text (gint node)
+{
+  return (text_size > 0 && node >= first_leaf && !node_is_table (node_parent (node)) &&
+          node % 2 == 0);
+}
+
+static AtspiRole
+node_role (gint node)
+{
+  if (node == 0)
+    return ATSPI_ROLE_APPLICATION;
+  if (node_is_table (node))
+    return ATSPI_ROLE_TABLE;
+  if (node < first_leaf)
+    return ATSPI_ROLE_PANEL;
+  if (node_is_table (node_parent (node)))
+    return ATSPI_ROLE_TABLE_CELL;
+  if (node_has_text (node))
+    return ATSPI_ROLE_TEXT;
+  return ATSPI_ROLE_PUSH_BUTTON;
+}
+
+static gchar *
+node_name (gint node)
+{
+  gchar *role, *name;
+
+  name = (names ? g_hash_table_lookup (names, GINT_TO_POINTER (node)) : NULL);
+  if (name)
+    return g_strdup (name);
+  if (node == 0)
+    return g_strdup ("synthetic-app");
+  role = atspi_role_get_name (node_role (node));
+  name = g_strdup_printf ("%s %d", role, node);
+  g_free (role);
+  return name;
+}
+
+static gchar *
+node_path (gint node)
+{
+  if (node == 0)
+    return g_strdup (PATH_ROOT);
+  return g_strdup_printf (PATH_PREFIX "%d", node);
+}
+
+/* Returns the node for @path, or -1 */
+static gint
+path_node (const char *path)
+{
+  gchar *end;
+  glong node;
+
+  if (!strcmp (path, PATH_ROOT))
+    return 0;
+  if (strncmp (path, PATH_PREFIX, strlen (PATH_PREFIX)) != 0)
+    return -1;
+  path += strlen (PATH_PREFIX);
+  node = strtol (path, &end, 10);
+  if (end == path || *end || node <= 0 || node >= n_nodes || node_is_gone (node))
+    return -1;
+  return node;
+}
+
+/* Children split their parent's area, alternately across and down */
+static void
+node_extents (gint node, Rect *rect)
+{
+  gint parent = node_parent (node);
+  gint index;
+  gint level = 0;
+  gint n;
+
+  if (parent < 0)
+  {
+    rect->x = rect->y = 0;
+    rect->width = SCREEN_WIDTH;
+    rect->height = SCREEN_HEIGHT;
+    return;
+  }
+
+  node_extents (parent, rect);
+  for (n = parent; n > 0; n = node_parent (n))
+    level++;
+  index = node_index_in_parent (node);
+  if (level % 2 == 0)
+  {
+    rect->width /= fanout;
+    rect->x += index * rect->width;
+  }
+  else
+  {
+    rect->height /= fanout;
+    rect->y += index * rect->height;
+  }
+}
+
+static gint
+node_caret (gint node)
+{
+  return GPOINTER_TO_INT (g_hash_table_lookup (carets, GINT_TO_POINTER (node)));
+}
+
+static gchar *
+text_range (gint start, gint end)
+{
+  gint len = strlen (phrase);
+  GString *str;
+  gint i;
+
+  start = CLAMP (start, 0, text_size);
+  if (end < 0 || end > text_size)
+    end = text_size;
+  str = g_string_sized_new (MAX (end - start, 0) + 1);
+  for (i = start; i < end; i++)
+    g_string_append_c (str, phrase[i % len]);
+  return g_string_free (str, FALSE);
+}
+
+static gboolean
+text_is_space (gint offset)
+{
+  return (phrase[offset % strlen (phrase)] == ' ');
+}
+
+/* Finds the unit of text around @offset; only characters and words are
+ * told apart, anything larger is the whole text */
+static void
+text_unit (gint offset, gboolean word, gint *start, gint *end)
+{
+  offset = CLAMP (offset, 0, text_size);
+  if (!word)
+  {
+    *start = offset;
+    *end = MIN (offset + 1, text_size);
+    return;
+  }
+  *start = offset;
+  while (*start > 0 && !text_is_space (*start - 1))
+    (*start)--;
+  *end = offset;
+  while (*end < text_size && !text_is_space (*end))
+    (*end)++;
+  while (*end < text_size && text_is_space (*end))
+    (*end)++;
+}
+
+/* Marshalling helpers */
+
+static void
+append_reference (DBusMessageIter *iter, const char *name, const char *path)
+{
+  DBusMessageIter iter_struct;
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &iter_struct);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_STRING, &name);
+  dbus_message_iter_append_basic (&iter_struct, DBUS_TYPE_OBJECT_PATH, &path);
+  dbus_message_iter_close_container (iter, &iter_struct);
+}
+
+static void
+append_node (DBusMessageIter *iter, gint node)
+{
+  gchar *path;
+
+  if (node < 0)
+  {
+    append_reference (iter, "", PATH_NULL);
+    return;
+  }
+  path = node_path (node);
+  append_reference (iter, bus_name, path);
+  g_free (path);
+}
+
+static void
+append_parent (DBusMessageIter *iter, gint node)
+{
+  if (node == 0)
+    append_reference (iter, desktop_name, desktop_path);
+  else
+    append_node (iter, node_parent (node));
+}
+
+static void
+append_string (DBusMessageIter *iter, const char *str)
+{
+  dbus_message_iter_append_basic (iter, DBUS_TYPE_STRING, &str);
+}
+
+static void
+append_int (DBusMessageIter *iter, dbus_int32_t val)
+{
+  dbus_message_iter_append_basic (iter, DBUS_TYPE_INT32, &val);
+}
+
+static void
+append_uint (DBusMessageIter *iter, dbus_uint32_t val)
+{
+  dbus_message_iter_append_basic (iter, DBUS_TYPE_UINT32, &val);
+}
+
+static void
+append_bool (DBusMessageIter *iter, dbus_bool_t val)
+{
+  dbus_message_iter_append_basic (iter, DBUS_TYPE_BOOLEAN, &val);
+}
+
+static void
+append_interfaces (DBusMessageIter *iter, gint node)
+{
+  DBusMessageIter iter_array;
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, "s", &iter_array);
+  append_string (&iter_array, IFACE_ACCESSIBLE);
+  if (node == 0)
+    append_string (&iter_array, IFACE_APPLICATION);
+  else
+    append_string (&iter_array, IFACE_COMPONENT);
+  if (node_is_table (node))
+    append_string (&iter_array, IFACE_TABLE);
+  if (node_has_text (node))
+    append_string (&iter_array, IFACE_TEXT);
+  dbus_message_iter_close_container (iter, &iter_array);
+}
+
+static void
+append_states (DBusMessageIter *iter, gint node)
+{
+  DBusMessageIter iter_array;
+  guint64 states = 0;
+  dbus_uint32_t word;
+
+  states |= ((guint64) 1 << ATSPI_STATE_ENABLED);
+  states |= ((guint64) 1 << ATSPI_STATE_SENSITIVE);
+  states |= ((guint64) 1 << ATSPI_STATE_VISIBLE);
+  states |= ((guint64) 1 << ATSPI_STATE_SHOWING);
+  if (node >= first_leaf)
+    states |= ((guint64) 1 << ATSPI_STATE_FOCUSABLE);
+  if (node_has_text (node))
+  {
+    states |= ((guint64) 1 << ATSPI_STATE_EDITABLE);
+    states |= ((guint64) 1 << ATSPI_STATE_MULTI_LINE);
+  }
+  if (node == focus)
+    states |= ((guint64) 1 << ATSPI_STATE_FOCUSED);
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, "u", &iter_array);
+  word = states & 0xffffffff;
+  dbus_message_iter_append_basic (&iter_array, DBUS_TYPE_UINT32, &word);
+  word = states >> 32;
+  dbus_message_iter_append_basic (&iter_array, DBUS_TYPE_UINT32, &word);
+  dbus_message_iter_close_container (iter, &iter_array);
+}
+
+static void
+append_extents (DBusMessageIter *iter, const Rect *rect)
+{
+  DBusMessageIter iter_struct;
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &iter_struct);
+  append_int (&iter_struct, rect->x);
+  append_int (&iter_struct, rect->y);
+  append_int (&iter_struct, rect->width);
+  append_int (&iter_struct, rect->height);
+  dbus_message_iter_close_container (iter, &iter_struct);
+}
+
+static void
+append_int_array (DBusMessageIter *iter)
+{
+  DBusMessageIter iter_array;
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, "i", &iter_array);
+  dbus_message_iter_close_container (iter, &iter_array);
+}
+
+/* Properties */
+
+static const char *accessible_properties[] =
+  { "Name", "Description", "Parent", "ChildCount", "Locale", NULL };
+static const char *application_properties[] =
+  { "ToolkitName", "Version", "AtspiVersion", "Id", NULL };
+static const char *text_properties[] =
+  { "CharacterCount", "CaretOffset", NULL };
+static const char *table_properties[] =
+  { "NRows", "NColumns", "Caption", "Summary", "NSelectedRows",
+    "NSelectedColumns", NULL };
+
+static const char **
+interface_properties (gint node, const char *iface)
+{
+  if (!strcmp (iface, IFACE_ACCESSIBLE))
+    return accessible_properties;
+  if (!strcmp (iface, IFACE_APPLICATION) && node == 0)
+    return application_properties;
+  if (!strcmp (iface, IFACE_TEXT) && node_has_text (node))
+    return text_properties;
+  if (!strcmp (iface, IFACE_TABLE) && node_is_table (node))
+    return table_properties;
+  return NULL;
+}
+
+static gint
+table_rows (void)
+{
+  return (fanout + table_columns - 1) / table_columns;
+}
+
+/* Appends the value of a property as a variant; returns FALSE if @node
+ * has no such property */
+static gboolean
+append_property (DBusMessageIter *iter, gint node, const char *iface,
+                 const char *name)
+{
+  DBusMessageIter iter_variant;
+  const char **names = interface_properties (node, iface);
+  gint i;
+
+  if (!names)
+    return FALSE;
+  for (i = 0; names[i]; i++)
+    if (!strcmp (names[i], name))
+      break;
+  if (!names[i])
+    return FALSE;
+
+#define OPEN_VARIANT(sig) \
+  dbus_message_iter_open_container (iter, DBUS_TYPE_VARIANT, sig, &iter_variant)
+
+  if (!strcmp (name, "Name"))
+  {
+    gchar *str = node_name (node);
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, str);
+    g_free (str);
+  }
+  else if (!strcmp (name, "Description"))
+  {
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, "");
+  }
+  else if (!strcmp (name, "Parent"))
+  {
+    OPEN_VARIANT ("(so)");
+    append_parent (&iter_variant, node);
+  }
+  else if (!strcmp (name, "ChildCount"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, node_child_count (node));
+  }
+  else if (!strcmp (name, "Locale"))
+  {
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, "C");
+  }
+  else if (!strcmp (name, "ToolkitName"))
+  {
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, "synthetic");
+  }
+  else if (!strcmp (name, "Version"))
+  {
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, VERSION);
+  }
+  else if (!strcmp (name, "AtspiVersion"))
+  {
+    OPEN_VARIANT ("s");
+    append_string (&iter_variant, "2.1");
+  }
+  else if (!strcmp (name, "Id"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, app_id);
+  }
+  else if (!strcmp (name, "CharacterCount"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, text_size);
+  }
+  else if (!strcmp (name, "CaretOffset"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, node_caret (node));
+  }
+  else if (!strcmp (name, "NRows"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, table_rows ());
+  }
+  else if (!strcmp (name, "NColumns"))
+  {
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, table_columns);
+  }
+  else if (!strcmp (name, "Caption") || !strcmp (name, "Summary"))
+  {
+    OPEN_VARIANT ("(so)");
+    append_node (&iter_variant, -1);
+  }
+  else
+  {
+    /* NSelectedRows, NSelectedColumns */
+    OPEN_VARIANT ("i");
+    append_int (&iter_variant, 0);
+  }
+#undef OPEN_VARIANT
+
+  dbus_message_iter_close_container (iter, &iter_variant);
+  return TRUE;
+}
+
+static DBusMessage *
+impl_properties (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter, iter_dict, iter_entry;
+  const char *iface = NULL, *name = NULL;
+  const char **names;
+  gint i;
+
+  if (!strcmp (member, "Get"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_STRING, &iface,
+                                DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID))
+      return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                     "Invalid arguments");
+    reply = dbus_message_new_method_return (message);
+    dbus_message_iter_init_append (reply, &iter);
+    if (!append_property (&iter, node, iface, name))
+    {
+      dbus_message_unref (reply);
+      return dbus_message_new_error (message, DBUS_ERROR_UNKNOWN_PROPERTY,
+                                     "No such property");
+    }
+    return reply;
+  }
+
+  if (!strcmp (member, "GetAll"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_STRING, &iface,
+                                DBUS_TYPE_INVALID))
+      return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                     "Invalid arguments");
+    reply = dbus_message_new_method_return (message);
+    dbus_message_iter_init_append (reply, &iter);
+    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "{sv}", &iter_dict);
+    names = interface_properties (node, iface);
+    for (i = 0; names && names[i]; i++)
+    {
+      dbus_message_iter_open_container (&iter_dict, DBUS_TYPE_DICT_ENTRY, NULL,
+                                        &iter_entry);
+      append_string (&iter_entry, names[i]);
+      append_property (&iter_entry, node, iface, names[i]);
+      dbus_message_iter_close_container (&iter_dict, &iter_entry);
+    }
+    dbus_message_iter_close_container (&iter, &iter_dict);
+    return reply;
+  }
+
+  if (!strcmp (member, "Set"))
+  {
+    /* Only the Id given to us by the registry can be set */
+    DBusMessageIter iter_variant;
+
+    dbus_message_iter_init (message, &iter);
+    dbus_message_iter_get_basic (&iter, &iface);
+    dbus_message_iter_next (&iter);
+    dbus_message_iter_get_basic (&iter, &name);
+    dbus_message_iter_next (&iter);
+    if (node == 0 && !strcmp (iface, IFACE_APPLICATION) &&
+        !strcmp (name, "Id") &&
+        dbus_message_iter_get_arg_type (&iter) == DBUS_TYPE_VARIANT)
+    {
+      dbus_message_iter_recurse (&iter, &iter_variant);
+      if (dbus_message_iter_get_arg_type (&iter_variant) == DBUS_TYPE_INT32)
+      {
+        dbus_message_iter_get_basic (&iter_variant, &app_id);
+        return dbus_message_new_method_return (message);
+      }
+    }
+    return dbus_message_new_error (message, DBUS_ERROR_PROPERTY_READ_ONLY,
+                                   "Property is read-only");
+  }
+
+  return NULL;
+}
+
+/* Interfaces */
+
+static DBusMessage *
+impl_accessible (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply = dbus_message_new_method_return (message);
+  DBusMessageIter iter, iter_array;
+  dbus_int32_t index;
+  gint i;
+
+  dbus_message_iter_init_append (reply, &iter);
+
+  if (!strcmp (member, "GetChildAtIndex"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &index,
+                                DBUS_TYPE_INVALID))
+      goto invalid;
+    append_node (&iter, node_child (node, index));
+  }
+  else if (!strcmp (member, "GetChildren"))
+  {
+    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "(so)",
+                                      &iter_array);
+    for (i = 0; i < node_child_count (node); i++)
+      append_node (&iter_array, node_child (node, i));
+    dbus_message_iter_close_container (&iter, &iter_array);
+  }
+  else if (!strcmp (member, "GetIndexInParent"))
+    append_int (&iter, node_index_in_parent (node));
+  else if (!strcmp (member, "GetRelationSet"))
+  {
+    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "(ua(so))",
+                                      &iter_array);
+    dbus_message_iter_close_container (&iter, &iter_array);
+  }
+  else if (!strcmp (member, "GetRole"))
+    append_uint (&iter, node_role (node));
+  else if (!strcmp (member, "GetRoleName") ||
+           !strcmp (member, "GetLocalizedRoleName"))
+  {
+    gchar *role = atspi_role_get_name (node_role (node));
+    append_string (&iter, role);
+    g_free (role);
+  }
+  else if (!strcmp (member, "GetState"))
+    append_states (&iter, node);
+  else if (!strcmp (member, "GetAttributes"))
+  {
+    DBusMessageIter iter_entry;
+    gchar *id = g_strdup_printf ("%d", node);
+
+    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "{ss}",
+                                      &iter_array);
+    dbus_message_iter_open_container (&iter_array, DBUS_TYPE_DICT_ENTRY, NULL,
+                                      &iter_entry);
+    append_string (&iter_entry, "id");
+    append_string (&iter_entry, id);
+    dbus_message_iter_close_container (&iter_array, &iter_entry);
+    dbus_message_iter_close_container (&iter, &iter_array);
+    g_free (id);
+  }
+  else if (!strcmp (member, "GetApplication"))
+    append_node (&iter, 0);
+  else if (!strcmp (member, "GetInterfaces"))
+    append_interfaces (&iter, node);
+  else
+  {
+    dbus_message_unref (reply);
+    return NULL;
+  }
+  return reply;
+
+invalid:
+  dbus_message_unref (reply);
+  return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                 "Invalid arguments");
+}
+
+static DBusMessage *
+impl_application (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter;
+
+  if (node != 0)
+    return NULL;
+
+  reply = dbus_message_new_method_return (message);
+  if (!strcmp (member, "GetLocale"))
+  {
+    dbus_message_iter_init_append (reply, &iter);
+    append_string (&iter, "C");
+  }
+  else if (strcmp (member, "RegisterEventListener") != 0 &&
+           strcmp (member, "DeregisterEventListener") != 0)
+  {
+    dbus_message_unref (reply);
+    return NULL;
+  }
+  return reply;
+}
+
+static gboolean
+rect_contains (const Rect *rect, gint x, gint y)
+{
+  return (x >= rect->x && x < rect->x + rect->width &&
+          y >= rect->y && y < rect->y + rect->height);
+}
+
+static void set_focus (gint node);
+
+static DBusMessage *
+impl_component (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter;
+  dbus_int32_t x, y;
+  dbus_uint32_t coord_type;
+  Rect rect;
+  gint i;
+
+  if (node == 0)
+    return NULL;
+
+  node_extents (node, &rect);
+  reply = dbus_message_new_method_return (message);
+  dbus_message_iter_init_append (reply, &iter);
+
+  if (!strcmp (member, "Contains") || !strcmp (member, "GetAccessibleAtPoint"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &x,
+                                DBUS_TYPE_INT32, &y, DBUS_TYPE_UINT32,
+                                &coord_type, DBUS_TYPE_INVALID))
+      goto invalid;
+    if (member[0] == 'C')
+      append_bool (&iter, rect_contains (&rect, x, y));
+    else
+    {
+      gint found = -1;
+      for (i = 0; i < node_child_count (node); i++)
+      {
+        Rect child_rect;
+        node_extents (node_child (node, i), &child_rect);
+        if (rect_contains (&child_rect, x, y))
+        {
+          found = node_child (node, i);
+          break;
+        }
+      }
+      append_node (&iter, found);
+    }
+  }
+  else if (!strcmp (member, "GetExtents"))
+    append_extents (&iter, &rect);
+  else if (!strcmp (member, "GetPosition"))
+  {
+    append_int (&iter, rect.x);
+    append_int (&iter, rect.y);
+  }
+  else if (!strcmp (member, "GetSize"))
+  {
+    append_int (&iter, rect.width);
+    append_int (&iter, rect.height);
+  }
+  else if (!strcmp (member, "GetLayer"))
+    append_uint (&iter, ATSPI_LAYER_WIDGET);
+  else if (!strcmp (member, "GetMDIZOrder"))
+  {
+    dbus_int16_t z = 0;
+    dbus_message_iter_append_basic (&iter, DBUS_TYPE_INT16, &z);
+  }
+  else if (!strcmp (member, "GrabFocus"))
+  {
+    set_focus (node);
+    append_bool (&iter, TRUE);
+  }
+  else if (!strcmp (member, "GetAlpha"))
+  {
+    double alpha = 1.0;
+    dbus_message_iter_append_basic (&iter, DBUS_TYPE_DOUBLE, &alpha);
+  }
+  else
+  {
+    dbus_message_unref (reply);
+    return NULL;
+  }
+  return reply;
+
+invalid:
+  dbus_message_unref (reply);
+  return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                 "Invalid arguments");
+}
+
+static DBusMessage *
+impl_text (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter;
+  dbus_int32_t offset, end;
+  dbus_uint32_t unit;
+  gint start_out, end_out;
+  gchar *str;
+
+  if (!node_has_text (node))
+    return NULL;
+
+  reply = dbus_message_new_method_return (message);
+  dbus_message_iter_init_append (reply, &iter);
+
+  if (!strcmp (member, "GetText"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &offset,
+                                DBUS_TYPE_INT32, &end, DBUS_TYPE_INVALID))
+      goto invalid;
+    str = text_range (offset, end);
+    append_string (&iter, str);
+    g_free (str);
+  }
+  else if (!strcmp (member, "GetStringAtOffset") ||
+           !strcmp (member, "GetTextAtOffset"))
+  {
+    gboolean word;
+
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &offset,
+                                DBUS_TYPE_UINT32, &unit, DBUS_TYPE_INVALID))
+      goto invalid;
+    if (member[3] == 'S')
+      word = (unit == ATSPI_TEXT_GRANULARITY_WORD);
+    else
+      word = (unit == ATSPI_TEXT_BOUNDARY_WORD_START ||
+              unit == ATSPI_TEXT_BOUNDARY_WORD_END);
+    if (!word && unit != 0)
+    {
+      start_out = 0;
+      end_out = text_size;
+    }
+    else
+      text_unit (offset, word, &start_out, &end_out);
+    str = text_range (start_out, end_out);
+    append_string (&iter, str);
+    append_int (&iter, start_out);
+    append_int (&iter, end_out);
+    g_free (str);
+  }
+  else if (!strcmp (member, "GetCharacterAtOffset"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &offset,
+                                DBUS_TYPE_INVALID))
+      goto invalid;
+    append_int (&iter, (offset >= 0 && offset < text_size ?
+                        phrase[offset % strlen (phrase)] : 0));
+  }
+  else if (!strcmp (member, "SetCaretOffset"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &offset,
+                                DBUS_TYPE_INVALID))
+      goto invalid;
+    g_hash_table_insert (carets, GINT_TO_POINTER (node),
+                         GINT_TO_POINTER (CLAMP (offset, 0, text_size)));
+    append_bool (&iter, TRUE);
+  }
+  else if (!strcmp (member, "GetNSelections"))
+    append_int (&iter, 0);
+  else if (!strcmp (member, "GetAttributes") ||
+           !strcmp (member, "GetAttributeRun") ||
+           !strcmp (member, "GetDefaultAttributes") ||
+           !strcmp (member, "GetDefaultAttributeSet"))
+  {
+    DBusMessageIter iter_array;
+
+    dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "{ss}",
+                                      &iter_array);
+    dbus_message_iter_close_container (&iter, &iter_array);
+    if (!strcmp (member, "GetAttributes") || !strcmp (member, "GetAttributeRun"))
+    {
+      append_int (&iter, 0);
+      append_int (&iter, text_size);
+    }
+  }
+  else
+  {
+    dbus_message_unref (reply);
+    return NULL;
+  }
+  return reply;
+
+invalid:
+  dbus_message_unref (reply);
+  return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                 "Invalid arguments");
+}
+
+static DBusMessage *
+impl_table (DBusMessage *message, gint node, const char *member)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter;
+  dbus_int32_t row, column, index;
+
+  if (!node_is_table (node))
+    return NULL;
+
+  reply = dbus_message_new_method_return (message);
+  dbus_message_iter_init_append (reply, &iter);
+
+  if (!strcmp (member, "GetAccessibleAt") || !strcmp (member, "GetIndexAt") ||
+      !strcmp (member, "IsSelected"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &row,
+                                DBUS_TYPE_INT32, &column, DBUS_TYPE_INVALID))
+      goto invalid;
+    index = (column >= 0 && column < table_columns ?
+             row * table_columns + column : -1);
+    if (index >= fanout)
+      index = -1;
+    if (!strcmp (member, "GetAccessibleAt"))
+      append_node (&iter, (index >= 0 ? node_child (node, index) : -1));
+    else if (!strcmp (member, "GetIndexAt"))
+      append_int (&iter, index);
+    else
+      append_bool (&iter, FALSE);
+  }
+  else if (!strcmp (member, "GetRowAtIndex") ||
+           !strcmp (member, "GetColumnAtIndex"))
+  {
+    if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &index,
+                                DBUS_TYPE_INVALID))
+      goto invalid;
+    if (index < 0 || index >= fanout)
+      append_int (&iter, -1);
+    else
+      append_int (&iter, (member[3] == 'R' ? index / table_columns :
+                                             index % table_columns));
+  }
+  else if (!strcmp (member, "GetRowDescription") ||
+           !strcmp (member, "GetColumnDescription"))
+    append_string (&iter, "");
+  else if (!strcmp (member, "GetRowExtentAt") ||
+           !strcmp (member, "GetColumnExtentAt"))
+    append_int (&iter, 1);
+  else if (!strcmp (member, "GetRowHeader") ||
+           !strcmp (member, "GetColumnHeader"))
+    append_node (&iter, -1);
+  else if (!strcmp (member, "GetSelectedRows") ||
+           !strcmp (member, "GetSelectedColumns"))
+    append_int_array (&iter);
+  else if (!strcmp (member, "IsRowSelected") ||
+           !strcmp (member, "IsColumnSelected") ||
+           !strcmp (member, "AddRowSelection") ||
+           !strcmp (member, "AddColumnSelection") ||
+           !strcmp (member, "RemoveRowSelection") ||
+           !strcmp (member, "RemoveColumnSelection"))
+    append_bool (&iter, FALSE);
+  else
+  {
+    dbus_message_unref (reply);
+    return NULL;
+  }
+  return reply;
+
+invalid:
+  dbus_message_unref (reply);
+  return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                 "Invalid arguments");
+}
+
+static DBusHandlerResult
+send_reply (DBusConnection *connection, DBusMessage *message,
+            DBusMessage *reply)
+{
+  if (!reply)
+    reply = dbus_message_new_error (message, DBUS_ERROR_UNKNOWN_METHOD,
+                                    "Method not implemented");
+  dbus_connection_send (connection, reply, NULL);
+  dbus_message_unref (reply);
+  return DBUS_HANDLER_RESULT_HANDLED;
+}
+
+static DBusHandlerResult
+handle_accessible (DBusConnection *connection, DBusMessage *message,
+                   void *user_data)
+{
+  const char *iface = dbus_message_get_interface (message);
+  const char *member = dbus_message_get_member (message);
+  DBusMessage *reply = NULL;
+  gint node;
+
+  if (dbus_message_get_type (message) != DBUS_MESSAGE_TYPE_METHOD_CALL ||
+      !iface || !member)
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+  node = path_node (dbus_message_get_path (message));
+  if (node < 0)
+    return send_reply (connection, message,
+                       dbus_message_new_error (message,
+                                               DBUS_ERROR_UNKNOWN_OBJECT,
+                                               "No such object"));
+
+  if (!strcmp (iface, IFACE_PROPERTIES))
+    reply = impl_properties (message, node, member);
+  else if (!strcmp (iface, IFACE_ACCESSIBLE))
+    reply = impl_accessible (message, node, member);
+  else if (!strcmp (iface, IFACE_APPLICATION))
+    reply = impl_application (message, node, member);
+  else if (!strcmp (iface, IFACE_COMPONENT))
+    reply = impl_component (message, node, member);
+  else if (!strcmp (iface, IFACE_TEXT))
+    reply = impl_text (message, node, member);
+  else if (!strcmp (iface, IFACE_TABLE))
+    reply = impl_table (message, node, member);
+
+  return send_reply (connection, message, reply);
+}
+
+static void
+append_cache_item (DBusMessageIter *iter, gint node)
+{
+  DBusMessageIter iter_struct;
+  gchar *name = node_name (node);
+  const char *description = "";
+  dbus_int32_t index = (node == 0 ? -1 : node_index_in_parent (node));
+
+  dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &iter_struct);
+  append_node (&iter_struct, node);
+  append_node (&iter_struct, 0);
+  append_parent (&iter_struct, node);
+  append_int (&iter_struct, index);
+  append_int (&iter_struct, node_child_count (node));
+  append_interfaces (&iter_struct, node);
+  append_string (&iter_struct, name);
+  append_uint (&iter_struct, node_role (node));
+  append_string (&iter_struct, description);
+  append_states (&iter_struct, node);
+  dbus_message_iter_close_container (iter, &iter_struct);
+  g_free (name);
+}
+
+static DBusHandlerResult
+handle_cache (DBusConnection *connection, DBusMessage *message,
+              void *user_data)
+{
+  DBusMessage *reply;
+  DBusMessageIter iter, iter_array;
+  gint node;
+
+  if (no_cache ||
+      !dbus_message_is_method_call (message, IFACE_CACHE, "GetItems"))
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+  reply = dbus_message_new_method_return (message);
+  dbus_message_iter_init_append (reply, &iter);
+  dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY,
+                                    "((so)(so)(so)iiassusau)", &iter_array);
+  for (node = 0; node < n_nodes; node++)
+  {
+    if (!node_is_gone (node))
+      append_cache_item (&iter_array, node);
+  }
+  dbus_message_iter_close_container (&iter, &iter_array);
+  return send_reply (connection, message, reply);
+}
+
+/* Events */
+
+static void
+emit_event (gint node, const char *member, const char *detail,
+            dbus_int32_t detail1, dbus_int32_t detail2,
+            const char *value_type, const void *value)
+{
+  DBusMessage *signal;
+  DBusMessageIter iter, iter_variant, iter_dict;
+  gchar *path = node_path (node);
+
+  signal = dbus_message_new_signal (path, IFACE_EVENT_OBJECT, member);
+  g_free (path);
+  if (!signal)
+    return;
+
+  dbus_message_iter_init_append (signal, &iter);
+  append_string (&iter, detail);
+  append_int (&iter, detail1);
+  append_int (&iter, detail2);
+  dbus_message_iter_open_container (&iter, DBUS_TYPE_VARIANT, value_type,
+                                    &iter_variant);
+  if (!strcmp (value_type, "(so)"))
+    append_node (&iter_variant, *(const gint *) value);
+  else
+    dbus_message_iter_append_basic (&iter_variant, value_type[0], value);
+  dbus_message_iter_close_container (&iter, &iter_variant);
+  dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "{sv}", &iter_dict);
+  dbus_message_iter_close_container (&iter, &iter_dict);
+
+  dbus_connection_send (bus, signal, NULL);
+  dbus_message_unref (signal);
+}
+
+static void
+set_focus (gint node)
+{
+  dbus_int32_t zero = 0;
+
+  if (node == focus)
+    return;
+  if (focus >= 0)
+    emit_event (focus, "StateChanged", "focused", 0, 0, "i", &zero);
+  focus = node;
+  emit_event (focus, "StateChanged", "focused", 1, 0, "i", &zero);
+}
+
+static void
+emit_storm_event (gint n)
+{
+  const char *type = event_list[n % g_strv_length (event_list)];
+  /* Spread the events over the tree, leaves mostly */
+  gint node = 1 + (gint) (((guint) n * 2654435761u) % (n_nodes - 1));
+  dbus_int32_t zero = 0;
+
+  if (!strcmp (type, "state-changed"))
+  {
+    dbus_int32_t on = (n / g_strv_length (event_list)) % 2;
+    emit_event (node, "StateChanged", "checked", on, 0, "i", &zero);
+  }
+  else if (!strcmp (type, "name-changed"))
+  {
+    gchar *name = node_name (node);
+    emit_event (node, "PropertyChange", "accessible-name", 0, 0, "s", &name);
+    g_free (name);
+  }
+  else if (!strcmp (type, "caret-moved"))
+  {
+    dbus_int32_t offset;
+
+    while (!node_has_text (node) && node < n_nodes - 1)
+      node++;
+    offset = (node_caret (node) + 1) % MAX (text_size, 1);
+    g_hash_table_insert (carets, GINT_TO_POINTER (node),
+                         GINT_TO_POINTER (offset));
+    emit_event (node, "TextCaretMoved", "", offset, 0, "i", &zero);
+  }
+  else if (!strcmp (type, "children-changed"))
+  {
+    /* Re-announce an existing child; the tree itself never changes */
+    gint parent = node_parent (node);
+    emit_event (parent, "ChildrenChanged", "add",
+                node_index_in_parent (node), 0, "(so)", &node);
+  }
+}
+
+static gboolean
+emit_events (gpointer data)
+{
+  gint64 elapsed = g_get_monotonic_time () - events_start;
+  gint due = (gint) (elapsed * event_rate / G_USEC_PER_SEC);
+
+  if (event_count > 0 && due > event_count)
+    due = event_count;
+  while (events_sent < due)
+    emit_storm_event (events_sent++);
+  dbus_connection_flush (bus);
+
+  if (event_count > 0 && events_sent >= event_count)
+  {
+    if (exit_when_done)
+      g_main_loop_quit (mainloop);
+    return G_SOURCE_REMOVE;
+  }
+  return G_SOURCE_CONTINUE;
+}
+
+/* Control interface */
+
+static DBusMessage *
+impl_set_name (DBusMessage *message)
+{
+  dbus_int32_t node;
+  const char *name;
+
+  if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &node,
+                              DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID))
+    return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                   "Expected a node and a name");
+  if (node < 0 || node >= n_nodes || node_is_gone (node))
+    return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                   "No such node");
+
+  g_hash_table_insert (names, GINT_TO_POINTER (node), g_strdup (name));
+  emit_event (node, "PropertyChange", "accessible-name", 0, 0, "s", &name);
+  return dbus_message_new_method_return (message);
+}
+
+static DBusMessage *
+impl_remove_child (DBusMessage *message)
+{
+  dbus_int32_t node;
+  gint parent, index;
+
+  if (!dbus_message_get_args (message, NULL, DBUS_TYPE_INT32, &node,
+                              DBUS_TYPE_INVALID))
+    return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                   "Expected a node");
+  if (node <= 0 || node >= n_nodes || node_is_gone (node))
+    return dbus_message_new_error (message, DBUS_ERROR_INVALID_ARGS,
+                                   "No such child");
+
+  parent = node_parent (node);
+  index = node_index_in_parent (node);
+  if (!removed)
+    removed = g_hash_table_new (g_direct_hash, g_direct_equal);
+  g_hash_table_add (removed, GINT_TO_POINTER (node));
+  emit_event (parent, "ChildrenChanged", "remove", index, 0, "(so)", &node);
+  return dbus_message_new_method_return (message);
+}
+
+static DBusHandlerResult
+handle_control (DBusConnection *connection, DBusMessage *message,
+                void *user_data)
+{
+  DBusMessage *reply;
+
+  if (dbus_message_is_method_call (message, IFACE_CONTROL, "SetName"))
+    reply = impl_set_name (message);
+  else if (dbus_message_is_method_call (message, IFACE_CONTROL, "RemoveChild"))
+    reply = impl_remove_child (message);
+  else
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+  return send_reply (connection, message, reply);
+}
+
+/* Setup */
+
+static gboolean
+embed (void)
+{
+  DBusMessage *message, *reply;
+  DBusMessageIter iter, iter_struct;
+  DBusError error;
+  const char *name, *path;
+
+  message = dbus_message_new_method_call (ATSPI_DBUS_NAME_REGISTRY,
+                                          ATSPI_DBUS_PATH_ROOT,
+                                          "org.a11y.atspi.Socket", "Embed");
+  dbus_message_iter_init_append (message, &iter);
+  append_node (&iter, 0);
+
+  dbus_error_init (&error);
+  reply = dbus_connection_send_with_reply_and_block (bus, message, -1, &error);
+  dbus_message_unref (message);
+  if (!reply)
+  {
+    g_warning ("synthetic-app: cannot embed: %s", error.message);
+    dbus_error_free (&error);
+    return FALSE;
+  }
+
+  if (strcmp (dbus_message_get_signature (reply), "(so)") != 0)
+  {
+    g_warning ("synthetic-app: Embed returned %s",
+               dbus_message_get_signature (reply));
+    dbus_message_unref (reply);
+    return FALSE;
+  }
+  dbus_message_iter_init (reply, &iter);
+  dbus_message_iter_recurse (&iter, &iter_struct);
+  dbus_message_iter_get_basic (&iter_struct, &name);
+  dbus_message_iter_next (&iter_struct);
+  dbus_message_iter_get_basic (&iter_struct, &path);
+  desktop_name = g_strdup (name);
+  desktop_path = g_strdup (path);
+  dbus_message_unref (reply);
+  return TRUE;
+}
+
+static DBusConnection *
+connect_bus (void)
+{
+  DBusConnection *connection;
+  DBusError error;
+
+  if (!address)
+    return atspi_get_a11y_bus ();
+
+  dbus_error_init (&error);
+  connection = dbus_connection_open_private (address, &error);
+  if (connection && !dbus_bus_register (connection, &error))
+  {
+    dbus_connection_close (connection);
+    dbus_connection_unref (connection);
+    connection = NULL;
+  }
+  if (!connection)
+  {
+    g_warning ("synthetic-app: cannot connect to %s: %s", address,
+               error.message);
+    dbus_error_free (&error);
+  }
+  return connection;
+}
+
+static const DBusObjectPathVTable accessible_vtable =
+{
+  NULL, handle_accessible
+};
+
+static const DBusObjectPathVTable cache_vtable =
+{
+  NULL, handle_cache
+};
+
+static const DBusObjectPathVTable control_vtable =
+{
+  NULL, handle_control
+};
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *opt;
+  GError *err = NULL;
+  gint64 nodes = 1, level = 1;
+  gint i;
+
+  opt = g_option_context_new ("- serve a synthetic accessible tree");
+  g_option_context_add_main_entries (opt, optentries, NULL);
+  if (!g_option_context_parse (opt, &argc, &argv, &err))
+  {
+    g_printerr ("%s\n", err->message);
+    return 1;
+  }
+  g_option_context_free (opt);
+
+  if (depth < 0 || fanout < 1 || text_size < 0 || table_columns < 0)
+  {
+    g_printerr ("synthetic-app: invalid tree shape\n");
+    return 1;
+  }
+  for (i = 0; i < depth; i++)
+  {
+    level *= fanout;
+    nodes += level;
+    if (nodes > MAX_NODES)
+    {
+      g_printerr ("synthetic-app: tree too large\n");
+      return 1;
+    }
+  }
+  n_nodes = nodes;
+  first_leaf = nodes - level;
+  if (depth == 0)
+    first_leaf = 1;
+
+  event_list = g_strsplit (event_types ? event_types : "state-changed", ",", -1);
+  if (!event_list[0])
+  {
+    g_printerr ("synthetic-app: no events given\n");
+    return 1;
+  }
+  carets = g_hash_table_new (g_direct_hash, g_direct_equal);
+  names = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+  bus = connect_bus ();
+  if (!bus)
+    return 1;
+  bus_name = dbus_bus_get_unique_name (bus);
+  mainloop = g_main_loop_new (NULL, FALSE);
+  atspi_dbus_connection_setup_with_g_main (bus, NULL);
+
+  dbus_connection_register_fallback (bus, "/org/a11y/atspi/accessible",
+                                     &accessible_vtable, NULL);
+  dbus_connection_register_object_path (bus, PATH_CACHE, &cache_vtable, NULL);
+  dbus_connection_register_object_path (bus, PATH_CONTROL, &control_vtable,
+                                        NULL);
+
+  if (!embed ())
+    return 1;
+
+  printf ("ready %s\n", bus_name);
+  fflush (stdout);
+
+  if (event_rate > 0 && n_nodes > 1)
+  {
+    events_start = g_get_monotonic_time ();
+    g_timeout_add (10, emit_events, NULL);
+  }
+
+  g_main_loop_run (mainloop);
+  return 0;
+}
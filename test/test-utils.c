@@ -0,0 +1,167 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "config.h"
+#include "test-utils.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATH_CONTROL "/org/a11y/atspi/synthetic"
+#define IFACE_CONTROL "org.a11y.atspi.Synthetic"
+
+/* Returns the root of the application with bus name @name, or NULL */
+AtspiAccessible *
+test_find_app (const char *name)
+{
+  AtspiAccessible *desktop = atspi_get_desktop (0);
+  AtspiAccessible *found = NULL;
+  gint count = atspi_accessible_get_child_count (desktop, NULL);
+  gint i;
+
+  for (i = 0; i < count && !found; i++)
+  {
+    AtspiAccessible *child = atspi_accessible_get_child_at_index (desktop, i,
+                                                                  NULL);
+    if (!child)
+      continue;
+    if (child->parent.app && !strcmp (child->parent.app->bus_name, name))
+      found = child;
+    else
+      g_object_unref (child);
+  }
+  g_object_unref (desktop);
+  return found;
+}
+
+static gboolean timed_out;
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  timed_out = TRUE;
+  return G_SOURCE_REMOVE;
+}
+
+/* Iterates the main context until @condition returns TRUE or @msec pass;
+ * returns FALSE on timeout */
+gboolean
+test_wait_until (TestCondition condition, gpointer data, guint msec)
+{
+  guint id;
+  gboolean done;
+
+  timed_out = FALSE;
+  id = g_timeout_add (msec, timeout_cb, NULL);
+  while (!(done = condition (data)) && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  if (!timed_out)
+    g_source_remove (id);
+  return done;
+}
+
+/* Events */
+
+static gint changes;
+
+static void
+on_change (AtspiEvent *event, void *data)
+{
+  changes++;
+  g_boxed_free (ATSPI_TYPE_EVENT, event);
+}
+
+/* Listens for the events the control interface emits, so that they
+ * reach the cache */
+void
+test_watch_changes (void)
+{
+  AtspiEventListener *listener;
+
+  listener = atspi_event_listener_new (on_change, NULL, NULL);
+  atspi_event_listener_register (listener,
+                                 "object:property-change:accessible-name",
+                                 NULL);
+  atspi_event_listener_register (listener, "object:children-changed", NULL);
+}
+
+static gboolean
+changes_reached (gpointer data)
+{
+  return (changes >= GPOINTER_TO_INT (data));
+}
+
+/* Calls @method of the synthetic-app's control interface, and waits
+ * until the event it emits has been processed */
+static void
+control_call (const char *app_name, const char *method, gint node,
+              const char *name)
+{
+  DBusMessage *message, *reply;
+  DBusError error;
+  dbus_int32_t d_node = node;
+  gint expected = changes + 1;
+
+  message = dbus_message_new_method_call (app_name, PATH_CONTROL,
+                                          IFACE_CONTROL, method);
+  if (name)
+    dbus_message_append_args (message, DBUS_TYPE_INT32, &d_node,
+                              DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
+  else
+    dbus_message_append_args (message, DBUS_TYPE_INT32, &d_node,
+                              DBUS_TYPE_INVALID);
+
+  dbus_error_init (&error);
+  reply = dbus_connection_send_with_reply_and_block (atspi_get_a11y_bus (),
+                                                     message, -1, &error);
+  dbus_message_unref (message);
+  if (!reply)
+    test_fail ("%s (%d) failed: %s", method, node, error.message);
+  dbus_message_unref (reply);
+
+  if (!test_wait_until (changes_reached, GINT_TO_POINTER (expected), 5000))
+    test_fail ("no event for %s (%d)", method, node);
+}
+
+void
+test_set_name (const char *app_name, gint node, const char *name)
+{
+  control_call (app_name, "SetName", node, name);
+}
+
+void
+test_remove_child (const char *app_name, gint node)
+{
+  control_call (app_name, "RemoveChild", node, NULL);
+}
+
+void
+test_fail (const char *format, ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  fprintf (stderr, "%s: ", g_get_prgname ());
+  vfprintf (stderr, format, args);
+  fputc ('\n', stderr);
+  va_end (args);
+  exit (1);
+}
@@ -0,0 +1,51 @@
+/*
+ * AT-SPI - Assistive Technology Service Provider Interface
+ * (Gnome Accessibility Project; http://developer.gnome.org/projects/gap)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/*
+ * Shared by the tests that run against a synthetic-app through
+ * run-with-app.sh.
+ */
+
+#ifndef _TEST_UTILS_H_
+#define _TEST_UTILS_H_
+
+#include "atspi/atspi.h"
+
+typedef gboolean (*TestCondition) (gpointer data);
+
+AtspiAccessible *
+test_find_app (const char *name);
+
+gboolean
+test_wait_until (TestCondition condition, gpointer data, guint msec);
+
+void
+test_watch_changes (void);
+
+void
+test_set_name (const char *app_name, gint node, const char *name);
+
+void
+test_remove_child (const char *app_name, gint node);
+
+void
+test_fail (const char *format, ...) G_GNUC_PRINTF (1, 2);
+
+#endif	/* _TEST_UTILS_H_ */